@@ -0,0 +1,78 @@
+// Logger throughput benchmark - runs on the build host: make bench && .build/bench/LogBench
+//
+// Logs the same records in text and in binary mode, each to a file in /tmp, and reports
+// records per second (from the first call until close() has written everything), the time
+// the logging thread spent per record, and the bytes written. Console output goes to
+// /dev/null while a mode runs, so the terminal does not dominate the text numbers.
+
+#include "Logger.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace TG5040;
+
+namespace
+{
+    constexpr int RECORDS = 200000;
+
+    struct Result
+    {
+        double recordsPerSecond;
+        double callNs;
+        long long bytes;
+    };
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    Result run(LogOutput output, const char *path)
+    {
+        unlink(path);
+        Logger &logger = Logger::getInstance();
+        logger.setOverflowPolicy(LogOverflow::Block); // Every record is written, none dropped
+        logger.init(LogLevel::DEBUG, path, output);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < RECORDS; ++i)
+        {
+            // A typical per-frame mix of integers, floats and strings
+            LOG_DEBUG("Frame %d: %d events, update %.2f ms, render %.2f ms, scene %s", i, i % 7, 1.25 + (i % 10) * 0.1,
+                      4.5 - (i % 5) * 0.2, i % 2 ? "menu" : "game");
+        }
+        double callMs = elapsedMs(start);
+        logger.close();
+        double totalMs = elapsedMs(start);
+
+        struct stat info = {};
+        stat(path, &info);
+        return {RECORDS / (totalMs / 1000.0), callMs * 1e6 / RECORDS, static_cast<long long>(info.st_size)};
+    }
+} // namespace
+
+int main()
+{
+    std::fflush(stdout);
+    int console = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+
+    Result text = run(LogOutput::Text, "/tmp/logbench.log");
+    Result binary = run(LogOutput::Binary, "/tmp/logbench.logb");
+
+    std::fflush(stdout);
+    dup2(console, STDOUT_FILENO);
+    close(null);
+    close(console);
+
+    std::printf("Records:   %d per mode\n", RECORDS);
+    std::printf("Text:      %10.0f records/s  %7.1f ns per call  %10lld bytes\n", text.recordsPerSecond, text.callNs, text.bytes);
+    std::printf("Binary:    %10.0f records/s  %7.1f ns per call  %10lld bytes\n", binary.recordsPerSecond, binary.callNs, binary.bytes);
+    std::printf("Decode:    .build/tools/logdecode /tmp/logbench.logb\n");
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Stylesheet matching benchmark - runs on the build host: make bench && .build/bench/StyleBench
+//
+// Builds a 1,000 element tree (rows of buttons and labels), then measures a cold resolve,
+// a no-op re-resolve, and restyling after a handful of state changes.
+
+#include "StyleSheet.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+using namespace TG5040::UI;
+
+namespace
+{
+    const char *STYLES = R"(
+        container { background-color: #202020; }
+        .row { border-width: 1; border-color: #404040; }
+        .row.alt { background-color: #282828; }
+        text { color: #c8c8c8; font-size: 18; }
+        .row > text.title { color: #ffffff; font-size: 24; }
+        button { background-color: #646464; color: #ffffff; }
+        button.primary { background-color: #4caf50; }
+        button.primary:pressed { background-color: #388e3c; }
+        button.danger { background-color: #f44336; }
+        button:focused { border-width: 2; border-color: #ffc800; }
+        #footer text { opacity: 0.5; }
+    )";
+
+    double elapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace
+
+int main()
+{
+    constexpr int ROWS = 200;
+
+    auto root = std::make_shared<Container>();
+    std::vector<ElementPtr> buttons;
+    int count = 1;
+
+    for (int i = 0; i < ROWS; ++i)
+    {
+        auto row = std::make_shared<Container>();
+        row->addClass("row");
+        if (i % 2)
+            row->addClass("alt");
+        if (i == ROWS - 1)
+            row->setId("footer");
+        root->addChild(row);
+
+        auto title = std::make_shared<Text>("Row", 16);
+        title->addClass("title");
+        auto detail = std::make_shared<Text>("Detail", 16);
+        auto ok = std::make_shared<Button>("OK");
+        ok->addClass("primary");
+        auto cancel = std::make_shared<Button>("Cancel");
+        cancel->addClass(i % 3 ? "danger" : "secondary");
+
+        row->addChild(title);
+        row->addChild(detail);
+        row->addChild(ok);
+        row->addChild(cancel);
+        buttons.push_back(ok);
+        count += 5;
+    }
+
+    StyleSheet styles;
+    if (!styles.parse(STYLES))
+    {
+        std::printf("Failed to parse benchmark stylesheet\n");
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    styles.apply(root.get());
+    double cold = elapsedMs(start);
+
+    constexpr int ITERATIONS = 1000;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        styles.apply(root.get());
+    }
+    double idle = elapsedMs(start) / ITERATIONS;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+    {
+        // A press and a focus change per frame, like a user tapping through the list
+        buttons[i % buttons.size()]->setState(ElementState::Pressed, i % 2 == 0);
+        buttons[(i * 7) % buttons.size()]->setFocused(i % 2 == 0);
+        styles.apply(root.get());
+    }
+    double incremental = elapsedMs(start) / ITERATIONS;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i)
+    {
+        styles.invalidate(root.get());
+        styles.apply(root.get());
+    }
+    double full = elapsedMs(start) / 100;
+
+    std::printf("Elements:            %d\n", count);
+    std::printf("Rules:               %zu\n", styles.ruleCount());
+    std::printf("Shared styles:       %zu\n", styles.sharedStyleCount());
+    std::printf("Cold resolve:        %.3f ms\n", cold);
+    std::printf("Full re-match:       %.3f ms\n", full);
+    std::printf("No-op apply:         %.4f ms\n", idle);
+    std::printf("State change apply:  %.4f ms\n", incremental);
+    return 0;
+}
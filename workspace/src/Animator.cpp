@@ -0,0 +1,476 @@
+#include "Animator.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        float ease(Easing easing, float t)
+        {
+            t = std::min(std::max(t, 0.0f), 1.0f);
+
+            switch (easing)
+            {
+            case Easing::Linear:
+                return t;
+            case Easing::EaseIn:
+                return t * t * t;
+            case Easing::EaseOut:
+            {
+                float u = 1.0f - t;
+                return 1.0f - u * u * u;
+            }
+            case Easing::EaseInOut:
+                if (t < 0.5f)
+                {
+                    return 4.0f * t * t * t;
+                }
+                else
+                {
+                    float u = -2.0f * t + 2.0f;
+                    return 1.0f - u * u * u * 0.5f;
+                }
+            case Easing::EaseOutBack:
+            {
+                constexpr float c1 = 1.70158f;
+                constexpr float c3 = c1 + 1.0f;
+                float u = t - 1.0f;
+                return 1.0f + c3 * u * u * u + c1 * u * u;
+            }
+            case Easing::EaseOutBounce:
+            {
+                constexpr float n1 = 7.5625f;
+                constexpr float d1 = 2.75f;
+                if (t < 1.0f / d1)
+                {
+                    return n1 * t * t;
+                }
+                else if (t < 2.0f / d1)
+                {
+                    t -= 1.5f / d1;
+                    return n1 * t * t + 0.75f;
+                }
+                else if (t < 2.5f / d1)
+                {
+                    t -= 2.25f / d1;
+                    return n1 * t * t + 0.9375f;
+                }
+                t -= 2.625f / d1;
+                return n1 * t * t + 0.984375f;
+            }
+            default:
+                return t;
+            }
+        }
+
+        namespace
+        {
+            bool isHorizontal(ConstraintAttribute attribute)
+            {
+                switch (attribute)
+                {
+                case ConstraintAttribute::Left:
+                case ConstraintAttribute::Right:
+                case ConstraintAttribute::CenterX:
+                case ConstraintAttribute::Leading:
+                case ConstraintAttribute::Trailing:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            bool isPositional(ConstraintAttribute attribute)
+            {
+                return attribute != ConstraintAttribute::Width && attribute != ConstraintAttribute::Height;
+            }
+        } // namespace
+
+        Animator &Animator::getInstance()
+        {
+            static Animator instance;
+            return instance;
+        }
+
+        AnimationId Animator::animateFrame(ElementPtr element, const Rect &to, float duration,
+                                           Easing easing, float delay, AnimationCompletion completion)
+        {
+            if (!element)
+            {
+                return 0;
+            }
+
+            Track track;
+            track.property = AnimationProperty::Frame;
+            track.element = element.get();
+            track.to[0] = to.x;
+            track.to[1] = to.y;
+            track.to[2] = to.width;
+            track.to[3] = to.height;
+            track.easing = easing;
+            track.duration = duration;
+            track.delay = delay;
+            track.completion = std::move(completion);
+            return addTrack(std::move(track));
+        }
+
+        AnimationId Animator::animateTranslation(ElementPtr element, float dx, float dy, float duration,
+                                                 Easing easing, float delay, AnimationCompletion completion)
+        {
+            if (!element)
+            {
+                return 0;
+            }
+
+            Track track;
+            track.property = AnimationProperty::Translation;
+            track.element = element.get();
+            track.to[0] = dx;
+            track.to[1] = dy;
+            track.easing = easing;
+            track.duration = duration;
+            track.delay = delay;
+            track.completion = std::move(completion);
+            return addTrack(std::move(track));
+        }
+
+        AnimationId Animator::animateBackgroundColor(ElementPtr element, const Color &to, float duration,
+                                                     Easing easing, float delay, AnimationCompletion completion)
+        {
+            if (!element)
+            {
+                return 0;
+            }
+
+            Track track;
+            track.property = AnimationProperty::BackgroundColor;
+            track.element = element.get();
+            track.to[0] = to.r;
+            track.to[1] = to.g;
+            track.to[2] = to.b;
+            track.to[3] = to.a;
+            track.easing = easing;
+            track.duration = duration;
+            track.delay = delay;
+            track.completion = std::move(completion);
+            return addTrack(std::move(track));
+        }
+
+        AnimationId Animator::animateOpacity(ElementPtr element, float to, float duration,
+                                             Easing easing, float delay, AnimationCompletion completion)
+        {
+            if (!element)
+            {
+                return 0;
+            }
+
+            Track track;
+            track.property = AnimationProperty::Opacity;
+            track.element = element.get();
+            track.to[0] = std::min(std::max(to, 0.0f), 1.0f);
+            track.easing = easing;
+            track.duration = duration;
+            track.delay = delay;
+            track.completion = std::move(completion);
+            return addTrack(std::move(track));
+        }
+
+        AnimationId Animator::animateConstant(ConstraintPtr constraint, float to, float duration,
+                                              Easing easing, float delay, AnimationCompletion completion)
+        {
+            if (!constraint || !constraint->isValid())
+            {
+                return 0;
+            }
+
+            Track track;
+            track.property = AnimationProperty::ConstraintConstant;
+            track.element = constraint->firstItem;
+            track.constraint = std::move(constraint);
+            track.to[0] = to;
+            track.easing = easing;
+            track.duration = duration;
+            track.delay = delay;
+            track.completion = std::move(completion);
+            return addTrack(std::move(track));
+        }
+
+        AnimationId Animator::addTrack(Track &&track)
+        {
+            track.id = nextId_++;
+            if (nextId_ == 0)
+            {
+                nextId_ = 1;
+            }
+
+            track.duration = std::max(track.duration, 0.0f);
+            track.delay = std::max(track.delay, 0.0f);
+
+            AnimationId id = track.id;
+            tracks_.push_back(std::move(track));
+            return id;
+        }
+
+        void Animator::start(Track &track)
+        {
+            // Capture the starting value when the animation actually begins so
+            // that chained and delayed animations pick up where the last one ended
+            Element *element = track.element;
+            switch (track.property)
+            {
+            case AnimationProperty::Frame:
+                track.from[0] = element->frame.x;
+                track.from[1] = element->frame.y;
+                track.from[2] = element->frame.width;
+                track.from[3] = element->frame.height;
+                break;
+            case AnimationProperty::Translation:
+                break;
+            case AnimationProperty::BackgroundColor:
+                track.from[0] = element->backgroundColor.r;
+                track.from[1] = element->backgroundColor.g;
+                track.from[2] = element->backgroundColor.b;
+                track.from[3] = element->backgroundColor.a;
+                break;
+            case AnimationProperty::Opacity:
+                track.from[0] = element->opacity;
+                break;
+            case AnimationProperty::ConstraintConstant:
+                track.from[0] = track.constraint->constant;
+                track.applied[0] = track.from[0];
+                track.bypassSolver = canBypassSolver(*track.constraint);
+                track.horizontal = isHorizontal(track.constraint->firstAttribute);
+                break;
+            }
+            track.started = true;
+        }
+
+        void Animator::apply(Track &track, float t)
+        {
+            float k = ease(track.easing, t);
+            float value[4];
+            for (int i = 0; i < 4; ++i)
+            {
+                value[i] = track.from[i] + (track.to[i] - track.from[i]) * k;
+            }
+
+            Element *element = track.element;
+            switch (track.property)
+            {
+            case AnimationProperty::Frame:
+                element->frame = Rect(value[0], value[1], value[2], value[3]);
+                break;
+
+            case AnimationProperty::Translation:
+                element->translate(value[0] - track.applied[0], value[1] - track.applied[1]);
+                track.applied[0] = value[0];
+                track.applied[1] = value[1];
+                break;
+
+            case AnimationProperty::BackgroundColor:
+                element->backgroundColor = Color(
+                    static_cast<uint8_t>(std::lround(value[0])),
+                    static_cast<uint8_t>(std::lround(value[1])),
+                    static_cast<uint8_t>(std::lround(value[2])),
+                    static_cast<uint8_t>(std::lround(value[3])));
+                break;
+
+            case AnimationProperty::Opacity:
+                element->opacity = value[0];
+                break;
+
+            case AnimationProperty::ConstraintConstant:
+                track.constraint->constant = value[0];
+                if (track.bypassSolver)
+                {
+                    // The solver would only move the element along one axis, do it directly
+                    float delta = value[0] - track.applied[0];
+                    element->translate(track.horizontal ? delta : 0.0f, track.horizontal ? 0.0f : delta);
+                    track.applied[0] = value[0];
+                }
+                else
+                {
+                    for (Element *e = element; e; e = e->parent())
+                    {
+                        e->setNeedsLayout();
+                    }
+                }
+                break;
+            }
+        }
+
+        bool Animator::canBypassSolver(const Constraint &constraint) const
+        {
+            if (!constraint.active || !isPositional(constraint.firstAttribute))
+            {
+                return false;
+            }
+
+            const Element *item = constraint.firstItem;
+            bool horizontal = isHorizontal(constraint.firstAttribute);
+
+            // The constraint must be the last one on its axis, otherwise the solver overrides it
+            bool found = false;
+            for (auto &other : item->constraints_)
+            {
+                if (other.get() == &constraint)
+                {
+                    found = true;
+                    continue;
+                }
+                if (found && other->active && isPositional(other->firstAttribute) &&
+                    isHorizontal(other->firstAttribute) == horizontal)
+                {
+                    return false;
+                }
+            }
+            if (!found)
+            {
+                return false;
+            }
+
+            // No sibling may be positioned relative to the element
+            Element *parent = item->parent();
+            if (parent)
+            {
+                for (auto &sibling : parent->children())
+                {
+                    if (sibling.get() == item)
+                    {
+                        continue;
+                    }
+                    for (auto &other : sibling->constraints_)
+                    {
+                        if (other->active && other->secondItem == item)
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        bool Animator::step(float deltaTime)
+        {
+            if (tracks_.empty())
+            {
+                return false;
+            }
+
+            std::vector<AnimationCompletion> finished;
+
+            size_t i = 0;
+            while (i < tracks_.size())
+            {
+                Track &track = tracks_[i];
+
+                if (track.delay > 0.0f)
+                {
+                    track.delay -= deltaTime;
+                    if (track.delay > 0.0f)
+                    {
+                        ++i;
+                        continue;
+                    }
+                    // Carry the overshoot into the animation
+                    track.elapsed = -track.delay;
+                    track.delay = 0.0f;
+                }
+                else
+                {
+                    track.elapsed += deltaTime;
+                }
+
+                if (!track.started)
+                {
+                    start(track);
+                }
+
+                float t = track.duration > 0.0f ? track.elapsed / track.duration : 1.0f;
+                apply(track, t);
+
+                if (t >= 1.0f)
+                {
+                    if (track.completion)
+                    {
+                        finished.push_back(std::move(track.completion));
+                    }
+                    removeAt(i);
+                    continue;
+                }
+                ++i;
+            }
+
+            // Completions run after the pass, they may start new animations
+            for (auto &completion : finished)
+            {
+                completion(true);
+            }
+
+            return !tracks_.empty();
+        }
+
+        void Animator::cancel(AnimationId id)
+        {
+            for (size_t i = 0; i < tracks_.size(); ++i)
+            {
+                if (tracks_[i].id == id)
+                {
+                    AnimationCompletion completion = std::move(tracks_[i].completion);
+                    removeAt(i);
+                    if (completion)
+                    {
+                        completion(false);
+                    }
+                    return;
+                }
+            }
+        }
+
+        void Animator::cancelAll(const Element *element)
+        {
+            std::vector<AnimationCompletion> cancelled;
+            size_t i = 0;
+            while (i < tracks_.size())
+            {
+                if (tracks_[i].element == element)
+                {
+                    if (tracks_[i].completion)
+                    {
+                        cancelled.push_back(std::move(tracks_[i].completion));
+                    }
+                    removeAt(i);
+                    continue;
+                }
+                ++i;
+            }
+
+            for (auto &completion : cancelled)
+            {
+                completion(false);
+            }
+        }
+
+        void Animator::forget(const Element *element)
+        {
+            tracks_.erase(std::remove_if(tracks_.begin(), tracks_.end(), [element](const Track &track)
+                                         { return track.element == element; }),
+                          tracks_.end());
+        }
+
+        void Animator::removeAt(size_t index)
+        {
+            // Swap with the last element to keep storage contiguous without shifting
+            if (index + 1 != tracks_.size())
+            {
+                tracks_[index] = std::move(tracks_.back());
+            }
+            tracks_.pop_back();
+        }
+
+    } // namespace UI
+} // namespace TG5040
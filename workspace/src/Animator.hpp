@@ -0,0 +1,123 @@
+#pragma once
+
+#include "ConstraintLayout.hpp"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        // Easing curves for tweens
+        enum class Easing
+        {
+            Linear,
+            EaseIn,
+            EaseOut,
+            EaseInOut,
+            EaseOutBack,
+            EaseOutBounce
+        };
+
+        // Map normalized time (0..1) through an easing curve
+        float ease(Easing easing, float t);
+
+        // Properties that can be animated
+        enum class AnimationProperty
+        {
+            Frame,           // Element::frame (x, y, width, height)
+            Translation,     // Offset applied to an element and its subtree, bypasses the solver
+            BackgroundColor, // Element::backgroundColor
+            Opacity,         // Element::opacity
+            ConstraintConstant
+        };
+
+        using AnimationId = uint32_t;
+        using AnimationCompletion = std::function<void(bool finished)>;
+
+        // Property animation engine - all active tweens live in one contiguous
+        // array and are stepped in a single pass per frame
+        class Animator
+        {
+        public:
+            static Animator &getInstance();
+
+            AnimationId animateFrame(ElementPtr element, const Rect &to, float duration,
+                                     Easing easing = Easing::EaseInOut, float delay = 0.0f,
+                                     AnimationCompletion completion = nullptr);
+
+            // Move an element (and its children) by an offset without re-solving constraints.
+            // A later layout pass resets the element to its constrained position.
+            AnimationId animateTranslation(ElementPtr element, float dx, float dy, float duration,
+                                           Easing easing = Easing::EaseInOut, float delay = 0.0f,
+                                           AnimationCompletion completion = nullptr);
+
+            AnimationId animateBackgroundColor(ElementPtr element, const Color &to, float duration,
+                                               Easing easing = Easing::EaseInOut, float delay = 0.0f,
+                                               AnimationCompletion completion = nullptr);
+
+            AnimationId animateOpacity(ElementPtr element, float to, float duration,
+                                       Easing easing = Easing::EaseInOut, float delay = 0.0f,
+                                       AnimationCompletion completion = nullptr);
+
+            // Animate Constraint::constant. Positional constraints that nothing else
+            // depends on are applied as a translation instead of a full re-solve.
+            AnimationId animateConstant(ConstraintPtr constraint, float to, float duration,
+                                        Easing easing = Easing::EaseInOut, float delay = 0.0f,
+                                        AnimationCompletion completion = nullptr);
+
+            // Stop animations; completions are called with finished = false
+            void cancel(AnimationId id);
+            void cancelAll(const Element *element);
+
+            // Drop animations without calling completions (used on shutdown and destruction)
+            void clear() { tracks_.clear(); }
+            void forget(const Element *element);
+
+            // Advance all animations, returns true while anything is still animating
+            bool step(float deltaTime);
+
+            bool isAnimating() const { return !tracks_.empty(); }
+            size_t activeCount() const { return tracks_.size(); }
+
+            // Prevent copying
+            Animator(const Animator &) = delete;
+            Animator &operator=(const Animator &) = delete;
+
+        private:
+            Animator() = default;
+            ~Animator() = default;
+
+            struct Track
+            {
+                AnimationId id = 0;
+                AnimationProperty property = AnimationProperty::Frame;
+                Easing easing = Easing::Linear;
+                bool started = false;
+                bool bypassSolver = false; // Constant animations applied as translation
+                bool horizontal = false;   // Axis for bypassed constant animations
+                float delay = 0.0f;
+                float elapsed = 0.0f;
+                float duration = 0.0f;
+                float from[4] = {0, 0, 0, 0};
+                float to[4] = {0, 0, 0, 0};
+                float applied[4] = {0, 0, 0, 0};
+                Element *element = nullptr;
+                ConstraintPtr constraint;
+                AnimationCompletion completion;
+            };
+
+            std::vector<Track> tracks_;
+            AnimationId nextId_ = 1;
+
+            AnimationId addTrack(Track &&track);
+            void start(Track &track);
+            void apply(Track &track, float t);
+            bool canBypassSolver(const Constraint &constraint) const;
+            void removeAt(size_t index);
+        };
+
+    } // namespace UI
+} // namespace TG5040
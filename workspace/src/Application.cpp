@@ -1,5 +1,15 @@
 #include "Application.hpp"
+#include "Animator.hpp"
+#include "AudioMixer.hpp"
+#include "Config.hpp"
+#include "EvdevInput.hpp"
+#include "FlightRecorder.hpp"
+#include "InputLatency.hpp"
 #include "Logger.hpp"
+#include "ResourceManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
 namespace TG5040
 {
@@ -16,27 +26,116 @@ namespace TG5040
 
     bool Application::initialize()
     {
+        auto startTime = std::chrono::steady_clock::now();
+
         // Initialize logger
         Logger::getInstance().init();
         LOG_INFO("Starting TG5040 Application: %s", title_.c_str());
 
+        // Runtime settings, copied next to the executable by make pak
+        if (!Config::getInstance().load("config.ini"))
+        {
+            LOG_INFO("No config.ini found, using defaults");
+        }
+
+        // Binary records skip formatting on the device, make tools builds the host decoder
+        if (Config::getInstance().getString("log", "format", "text") == "binary")
+        {
+            Logger::getInstance().init(LogLevel::DEBUG, Config::getInstance().getString("log", "binary_file", "tg5040_app.logb"),
+                                       LogOutput::Binary);
+        }
+        setupLogLevels();
+
+        // Recent records survive a crash in $LOGS_PATH (set by launch.sh), make tools builds the reader
+        std::string flight = Config::getInstance().getString("log", "flight_recorder", "tg5040_app.flight");
+        int flightKb = Config::getInstance().getInt("log", "flight_recorder_kb", 256);
+        if (!flight.empty() && flightKb > 0)
+        {
+            const char *logs = std::getenv("LOGS_PATH");
+            std::string path = logs && *logs ? std::string(logs) + "/" + flight : flight;
+            FlightRecorder::getInstance().open(path, static_cast<size_t>(flightKb) * 1024);
+        }
+
         // Initialize SDL
-        if (!SDLManager::getInstance().initialize(width_, height_, title_))
+        RenderConfig renderConfig = RenderConfig::fromConfig(Config::getInstance(), renderConfig_);
+        if (!SDLManager::getInstance().initialize(width_, height_, title_, renderConfig))
         {
             LOG_FATAL("Failed to initialize SDL Manager");
             return false;
         }
 
+        // Sound effects - not fatal, the app runs silent without a device
+        AudioConfig audioConfig;
+        audioConfig.frequency = Config::getInstance().getInt("audio", "frequency", audioConfig.frequency);
+        audioConfig.bufferFrames = Config::getInstance().getInt("audio", "buffer_frames", audioConfig.bufferFrames);
+        audioConfig.musicBufferMs = Config::getInstance().getInt("audio", "music_buffer_ms", audioConfig.musicBufferMs);
+        if (Config::getInstance().getBool("audio", "enabled", true) && !AudioMixer::getInstance().initialize(audioConfig))
+        {
+            LOG_WARN("Failed to initialize audio, continuing without sound");
+        }
+
+        // Gamepads come from SDL, or with backend = evdev from a thread reading /dev/input directly
+        bool evdev = Config::getInstance().getString("input", "backend", "sdl") == "evdev";
+
         // Initialize controller manager
-        if (!ControllerManager::getInstance().initialize())
+        if (!ControllerManager::getInstance().initialize(!evdev))
         {
             LOG_WARN("Failed to initialize Controller Manager");
             // Not fatal, continue without controller support
         }
 
+        if (evdev)
+        {
+            std::vector<std::string> devices;
+            std::string list = Config::getInstance().getString("input", "devices", "");
+            for (size_t start = 0, end; start < list.size(); start = end + 1)
+            {
+                end = std::min(list.find(',', start), list.size());
+                std::string device = list.substr(start, end - start);
+                device.erase(0, device.find_first_not_of(' '));
+                device.erase(device.find_last_not_of(' ') + 1);
+                if (!device.empty())
+                {
+                    devices.push_back(device);
+                }
+            }
+
+            if (EvdevInput::getInstance().start(devices))
+            {
+                // The same pads would otherwise also arrive through SDL
+                SDL_GameControllerEventState(SDL_IGNORE);
+                SDL_JoystickEventState(SDL_IGNORE);
+            }
+            else
+            {
+                LOG_WARN("Evdev input unavailable, falling back to SDL controllers");
+                ControllerManager::getInstance().shutdown();
+                ControllerManager::getInstance().initialize();
+            }
+        }
+
+        setupEventFilter();
+        setupFocusNavigation();
+
+        // make pak packs res/ into one archive; development builds read the loose files
+        ResourceManager &resources = ResourceManager::getInstance();
+        std::string archive = Config::getInstance().getString("assets", "archive", "res.pack");
+        if (!archive.empty())
+        {
+            resources.mountArchive(archive);
+        }
+
+        // Glyphs baked at build time (make pak) are used instead of rasterizing at startup
+        SDLManager::getInstance().loadFontAtlas("res/fonts.atlas");
+
         // Call user initialization
         onCreate();
 
+        // Open every font the initial UI registered so the first frame never touches a TTF file
+        SDLManager::getInstance().preloadRegisteredFonts();
+
+        double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        LOG_INFO("Startup took %.1f ms (assets from %s)", startupMs, resources.hasArchive() ? archive.c_str() : "loose files");
         return true;
     }
 
@@ -66,9 +165,32 @@ namespace TG5040
             limitFrameRate();
         }
 
+        logStats();
         LOG_INFO("Application main loop ended");
     }
 
+    void Application::logStats() const
+    {
+        // Here rather than in shutdown(), which may run after the logger was closed
+        if (AudioMixer::getInstance().isInitialized())
+        {
+            AudioMixer::getInstance().logStats();
+        }
+        if (eventQueue_.getFrameCount() > 0)
+        {
+            const EventCounts &events = eventQueue_.getTotalCounts();
+            LOGC_INFO(Input, "Events: %llu received, %llu dispatched after coalescing, %llu filtered over %llu frames (peak %llu in one frame)",
+                      static_cast<unsigned long long>(events.received), static_cast<unsigned long long>(events.dispatched),
+                      static_cast<unsigned long long>(events.filtered),
+                      static_cast<unsigned long long>(eventQueue_.getFrameCount()),
+                      static_cast<unsigned long long>(eventQueue_.getPeakReceived()));
+        }
+        if (InputLatency::getInstance().getStats().samples > 0)
+        {
+            InputLatency::getInstance().dump(renderConfig_.vsync ? "(vsync)" : "(timer paced)");
+        }
+    }
+
     void Application::shutdown()
     {
         if (running_)
@@ -76,10 +198,145 @@ namespace TG5040
             running_ = false;
         }
 
+        UI::Animator::getInstance().clear();
+        pointerCapture_.reset();
+        scenes_.clear();
         rootElement_.reset();
+        AudioMixer::getInstance().shutdown();
+        ResourceManager::getInstance().shutdown();
+        EvdevInput::getInstance().stop();
         ControllerManager::getInstance().shutdown();
+        eventQueue_.removeFilter();
         SDLManager::getInstance().shutdown();
         Logger::getInstance().close();
+        FlightRecorder::getInstance().close();
+    }
+
+    void Application::setRootElement(UI::ElementPtr element)
+    {
+        // The focus graph borrows elements of the old tree, drop it while they are still alive
+        focusManager_.reset();
+        pointerCapture_.reset();
+        rootElement_ = element;
+        hitTestIndex_.setNeedsUpdate();
+    }
+
+    void Application::setStyleSheet(UI::StyleSheetPtr styleSheet)
+    {
+        styleSheet_ = styleSheet;
+        if (styleSheet_ && rootElement_)
+        {
+            styleSheet_->invalidate(rootElement_.get());
+        }
+    }
+
+    void Application::setupEventFilter()
+    {
+        // Everything the framework consumes. Joystick axes and hats must pass although nothing reads
+        // them: SDL's game controller watcher runs after this filter and builds the controller axis
+        // and hat D-pad events from them. Axis motion of both kinds is coalesced per frame.
+        static const Uint32 types[][2] = {
+            {SDL_QUIT, SDL_APP_DIDENTERFOREGROUND},
+            {SDL_WINDOWEVENT, SDL_WINDOWEVENT},
+            {SDL_KEYDOWN, SDL_TEXTINPUT},
+            {SDL_MOUSEMOTION, SDL_MOUSEWHEEL},
+            {SDL_JOYAXISMOTION, SDL_JOYAXISMOTION},
+            {SDL_JOYHATMOTION, SDL_JOYDEVICEREMOVED},
+            {SDL_CONTROLLERAXISMOTION, SDL_CONTROLLERDEVICEREMAPPED},
+            {SDL_RENDER_TARGETS_RESET, SDL_RENDER_DEVICE_RESET},
+            {SDL_USEREVENT, SDL_LASTEVENT},
+        };
+        for (const auto &range : types)
+        {
+            eventQueue_.subscribeRange(range[0], range[1]);
+        }
+        eventQueue_.installFilter();
+    }
+
+    void Application::setupLogLevels()
+    {
+        // [log] level for every category, then one key per category that needs another level;
+        // Logger::setLevel changes them while running
+        Config &config = Config::getInstance();
+        Logger &logger = Logger::getInstance();
+        LogLevel level;
+        std::string name = config.getString("log", "level", "");
+        if (!name.empty())
+        {
+            if (Logger::parseLevel(name, level))
+            {
+                logger.setLevel(level);
+            }
+            else
+            {
+                LOG_WARN("Unknown log level '%s' in [log] level", name.c_str());
+            }
+        }
+
+        for (size_t i = 0; i < LOG_CATEGORY_COUNT; ++i)
+        {
+            LogCategory category = static_cast<LogCategory>(i);
+            name = config.getString("log", Logger::categoryName(category), "");
+            if (name.empty())
+            {
+                continue;
+            }
+            if (!Logger::parseLevel(name, level))
+            {
+                LOG_WARN("Unknown log level '%s' in [log] %s", name.c_str(), Logger::categoryName(category));
+                continue;
+            }
+            logger.setLevel(category, level);
+            LOG_INFO("Log level for %s: %s", Logger::categoryName(category), name.c_str());
+        }
+    }
+
+    void Application::setupFocusNavigation()
+    {
+        // UI navigation is an ordinary set of actions, games can rebind or subscribe to them too
+        struct Binding
+        {
+            const char *name;
+            GamepadButton button;
+            SDL_Scancode key;
+            GamepadAxis axis;
+            int direction;
+        };
+        static const Binding bindings[] = {
+            {"ui_up", GamepadButton::DPAD_UP, SDL_SCANCODE_UP, GamepadAxis::LEFT_Y, -1},
+            {"ui_down", GamepadButton::DPAD_DOWN, SDL_SCANCODE_DOWN, GamepadAxis::LEFT_Y, 1},
+            {"ui_left", GamepadButton::DPAD_LEFT, SDL_SCANCODE_LEFT, GamepadAxis::LEFT_X, -1},
+            {"ui_right", GamepadButton::DPAD_RIGHT, SDL_SCANCODE_RIGHT, GamepadAxis::LEFT_X, 1},
+        };
+        static const UI::FocusDirection directions[] = {UI::FocusDirection::Up, UI::FocusDirection::Down,
+                                                        UI::FocusDirection::Left, UI::FocusDirection::Right};
+
+        auto &actions = InputActions::getInstance();
+        for (size_t i = 0; i < 4; ++i)
+        {
+            ActionId action = actions.registerAction(bindings[i].name);
+            actions.bindButton(bindings[i].button, action);
+            actions.bindKey(bindings[i].key, action);
+            actions.bindAxis(bindings[i].axis, bindings[i].direction, action);
+
+            UI::FocusDirection direction = directions[i];
+            actions.subscribe(action, [this, direction](ButtonState state)
+                              {
+                                  if (state == ButtonState::Pressed)
+                                  {
+                                      focusManager_.move(direction);
+                                  } });
+        }
+
+        ActionId activate = actions.registerAction("ui_activate");
+        actions.bindButton(GamepadButton::A, activate);
+        actions.bindKey(SDL_SCANCODE_RETURN, activate);
+        actions.subscribe(activate, [this](ButtonState state)
+                          {
+                              if (state == ButtonState::Pressed)
+                              {
+                                  focusManager_.activate();
+                              } });
     }
 
     void Application::calculateDeltaTime()
@@ -99,89 +356,215 @@ namespace TG5040
 
     void Application::handleEvents()
     {
+        eventQueue_.begin();
+
+        // Gamepad events read by the evdev thread since the last frame
         SDL_Event event;
-        while (SDL_PollEvent(&event))
+        while (EvdevInput::getInstance().pollEvent(event))
         {
-            // Debug: Log all SDL events
-            if (event.type >= SDL_FIRSTEVENT && event.type <= SDL_LASTEVENT)
-            {
-                LOG_DEBUG("SDL Event received: type=%d", event.type);
-            }
-            
-            // Check for quit event
-            if (event.type == SDL_QUIT)
+            eventQueue_.push(event);
+        }
+
+        // Everything SDL queued, in batches, with stick motion coalesced per axis
+        eventQueue_.drain();
+        for (const SDL_Event &queued : eventQueue_.events())
+        {
+            dispatchEvent(queued);
+        }
+
+        // Game logic polls one consistent controller state for the rest of the frame
+        ControllerManager::getInstance().snapshot();
+    }
+
+    void Application::dispatchEvent(const SDL_Event &event)
+    {
+        // Presses are timed until the frame that shows their effect is presented
+        InputLatency::getInstance().onEvent(event);
+
+        // Debug: Log all SDL events
+        if (event.type >= SDL_FIRSTEVENT && event.type <= SDL_LASTEVENT)
+        {
+            LOGC_DEBUG(Input, "SDL Event received: type=%d", event.type);
+        }
+
+        // Check for quit event
+        if (event.type == SDL_QUIT)
+        {
+            quit();
+            return;
+        }
+
+        // Nothing is live while a scene transition runs: the controller state is kept up to date,
+        // but no action, element or scene sees the event
+        bool transitioning = scenes_.isTransitioning();
+
+        // Handle controller events first
+        bool controllerHandled = ControllerManager::getInstance().handleEvent(event);
+        if (controllerHandled)
+        {
+            if (!transitioning)
             {
-                quit();
-                continue;
+                InputActions::getInstance().handleEvent(event);
             }
+            return;
+        }
 
-            // Handle controller events first
-            bool controllerHandled = ControllerManager::getInstance().handleEvent(event);
-            if (controllerHandled)
+        // Handle UI events - pointer events go straight to the element under the cursor
+        bool handled = false;
+        if (rootElement_ && !transitioning)
+        {
+            if (event.type == SDL_MOUSEBUTTONDOWN || event.type == SDL_MOUSEBUTTONUP ||
+                event.type == SDL_MOUSEMOTION)
             {
-                continue;
+                handled = dispatchPointerEvent(event);
             }
-
-            // Handle UI events
-            bool handled = false;
-            if (rootElement_)
+            else
             {
                 handled = rootElement_->handleEvent(event);
             }
+        }
 
-            // If UI didn't handle the event, pass it to user code
-            if (!handled)
-            {
-                handled = onEvent(event);
-            }
+        // If UI didn't handle the event, pass it to user code
+        ScenePtr scene = scenes_.top();
+        if (!handled && scene && !transitioning)
+        {
+            handled = scene->onEvent(event);
+        }
+        if (!handled)
+        {
+            handled = onEvent(event);
+        }
 
-            // Handle default key events
-            if (!handled && event.type == SDL_KEYDOWN)
-            {
-                if (event.key.keysym.sym == SDLK_ESCAPE)
-                {
-                    quit();
-                }
-            }
+        // Keys nobody handled drive bound actions (arrows and Return navigate the UI)
+        if (!handled && !transitioning && (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP))
+        {
+            handled = InputActions::getInstance().handleEvent(event);
+        }
+
+        // Handle default key events
+        if (!handled && event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE)
+        {
+            quit();
+        }
+    }
+
+    bool Application::dispatchPointerEvent(const SDL_Event &event)
+    {
+        UI::Element *target = nullptr;
+
+        // Elements see logical coordinates, the window may show an upscaled frame
+        SDL_Event mapped = event;
+        int &x = event.type == SDL_MOUSEMOTION ? mapped.motion.x : mapped.button.x;
+        int &y = event.type == SDL_MOUSEMOTION ? mapped.motion.y : mapped.button.y;
+        SDLManager::getInstance().windowToRender(x, y);
+
+        // An element that accepted a button press keeps receiving pointer events until release
+        auto captured = pointerCapture_.lock();
+        if (captured)
+        {
+            target = captured.get();
+        }
+        else
+        {
+            hitTestIndex_.update(rootElement_.get());
+            target = hitTestIndex_.hitTest(x, y);
+        }
+
+        UI::Element *handler = UI::dispatchPointerEvent(target, mapped);
+
+        if (event.type == SDL_MOUSEBUTTONDOWN && handler)
+        {
+            pointerCapture_ = handler->shared_from_this();
         }
+        else if (event.type == SDL_MOUSEBUTTONUP)
+        {
+            pointerCapture_.reset();
+        }
+
+        return handler != nullptr;
     }
 
     void Application::update()
     {
+        // Upload textures and fonts decoded by preload groups
+        ResourceManager::getInstance().update();
+
+        // The next scene starts once its preload group is loaded; the live one owns the root
+        if (scenes_.update(deltaTime_, styleSheet_.get(), backgroundColor_))
+        {
+            setRootElement(scenes_.top()->getRoot());
+        }
+        bool transitioning = scenes_.isTransitioning();
+        if (transitioning)
+        {
+            // Held D-pad or A must not act on the incoming scene when it goes live
+            InputActions::getInstance().releaseAll();
+        }
+
         // Call user update
+        if (scenes_.top() && !transitioning)
+        {
+            scenes_.top()->onUpdate(deltaTime_);
+        }
         onUpdate(deltaTime_);
 
-        // Update UI layout if needed
-        if (rootElement_)
+        // Step all running animations in one pass
+        animating_ = UI::Animator::getInstance().step(deltaTime_);
+
+        // Update UI layout if needed, the outgoing tree is only a snapshot during a transition
+        if (rootElement_ && !transitioning)
         {
-            if (rootElement_->needsLayout())
+            // Style changes can alter font sizes, so resolve them before layout
+            if (styleSheet_ && styleSheet_->apply(rootElement_.get()))
             {
-                // Set root frame to screen size
-                rootElement_->frame = UI::Rect(0, 0, width_, height_);
+                rootElement_->setNeedsLayout();
+            }
+
+            // The root fills the logical frame, which can be smaller than the window
+            SDLManager &sdl = SDLManager::getInstance();
+            float renderWidth = static_cast<float>(sdl.getRenderWidth());
+            float renderHeight = static_cast<float>(sdl.getRenderHeight());
+
+            if (rootElement_->needsLayout() || rootElement_->frame.width != renderWidth || rootElement_->frame.height != renderHeight)
+            {
+                rootElement_->frame = UI::Rect(0, 0, renderWidth, renderHeight);
                 rootElement_->layoutSubviews();
+                hitTestIndex_.setNeedsUpdate();
+                focusManager_.setNeedsRebuild();
+            }
+            else if (animating_)
+            {
+                hitTestIndex_.setNeedsUpdate();
             }
+
+            // Recompute the focus graph after layout or hierarchy changes
+            focusManager_.update(rootElement_.get());
         }
     }
 
     void Application::render()
     {
-        SDL_Renderer *renderer = SDLManager::getInstance().getRenderer();
+        SDLManager &sdl = SDLManager::getInstance();
+        SDL_Renderer *renderer = sdl.getRenderer();
+        sdl.beginFrame();
 
         // Clear screen
-        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+        SDL_SetRenderDrawColor(renderer, backgroundColor_.r, backgroundColor_.g, backgroundColor_.b, 255);
         SDL_RenderClear(renderer);
 
-        // Render UI
-        if (rootElement_)
+        // Render UI; a scene transition draws its two snapshots instead of both trees
+        bool transition = scenes_.render(renderer);
+        if (rootElement_ && !transition)
         {
             rootElement_->render(renderer);
+            focusManager_.render(renderer);
         }
 
         // Call user render
         onRender();
 
-        // Present the frame
-        SDL_RenderPresent(renderer);
+        // Present the frame, upscaled when rendering below the window size
+        sdl.present();
     }
 
     void Application::limitFrameRate()
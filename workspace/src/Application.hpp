@@ -3,6 +3,12 @@
 #include "SDLManager.hpp"
 #include "ControllerManager.hpp"
 #include "ConstraintLayout.hpp"
+#include "EventQueue.hpp"
+#include "FocusManager.hpp"
+#include "HitTestIndex.hpp"
+#include "InputActions.hpp"
+#include "SceneStack.hpp"
+#include "StyleSheet.hpp"
 #include <SDL2/SDL.h>
 #include <memory>
 
@@ -21,27 +27,71 @@ namespace TG5040
 
         // Override these in your application
         virtual void onCreate() {}
-        virtual void onUpdate(float deltaTime) {}
+        virtual void onUpdate(float /*deltaTime*/) {}
         virtual void onRender() {}
-        virtual bool onEvent(const SDL_Event &event) { return false; }
+        virtual bool onEvent(const SDL_Event &/*event*/) { return false; }
 
         // UI Management
-        void setRootElement(UI::ElementPtr element) { rootElement_ = element; }
+        void setRootElement(UI::ElementPtr element);
         UI::ElementPtr getRootElement() const { return rootElement_; }
 
+        // Scenes replace the root element once their resources are preloaded, with a transition
+        // between snapshots of both trees. Requests run one after another; see SceneStack.
+        void pushScene(ScenePtr scene, SceneTransition transition = SceneTransition::Fade,
+                       float duration = SceneStack::DEFAULT_DURATION) { scenes_.push(std::move(scene), transition, duration); }
+        void replaceScene(ScenePtr scene, SceneTransition transition = SceneTransition::Fade,
+                          float duration = SceneStack::DEFAULT_DURATION) { scenes_.replace(std::move(scene), transition, duration); }
+        void popScene(SceneTransition transition = SceneTransition::Fade,
+                      float duration = SceneStack::DEFAULT_DURATION) { scenes_.pop(transition, duration); }
+        SceneStack &getScenes() { return scenes_; }
+
+        // Styles are resolved before layout each frame, only for elements whose classes or state changed
+        void setStyleSheet(UI::StyleSheetPtr styleSheet);
+        UI::StyleSheetPtr getStyleSheet() const { return styleSheet_; }
+
+        // D-pad focus navigation
+        UI::FocusManager &getFocusManager() { return focusManager_; }
+
         // Get delta time in seconds
         float getDeltaTime() const { return deltaTime_; }
 
         // Get current FPS
         float getFPS() const { return deltaTime_ > 0 ? 1.0f / deltaTime_ : 0.0f; }
 
+        // True while the animator still has running animations
+        bool isAnimating() const { return animating_; }
+
         void quit() { running_ = false; }
 
+        // Event types dropped before SDL queues them unless subscribed. Input, window, quit and
+        // user events are subscribed by initialize(), and so are joystick axes and hats, which
+        // SDL turns into controller events; touch, joystick balls, audio device and system events
+        // are not. Call from onCreate() to receive more.
+        void subscribeEvent(Uint32 type, bool subscribed = true) { eventQueue_.subscribe(type, subscribed); }
+
+        // Events taken off the queues and dispatched after axis coalescing in the last frame
+        const EventCounts &getEventCounts() const { return eventQueue_.getFrameCounts(); }
+
     protected:
         std::string title_;
         int width_, height_;
         bool running_ = false;
+        bool animating_ = false;
         UI::ElementPtr rootElement_;
+        UI::StyleSheetPtr styleSheet_;
+        UI::Color backgroundColor_{30, 30, 30};
+        SceneStack scenes_;
+
+        // Pointer routing
+        UI::HitTestIndex hitTestIndex_;
+        std::weak_ptr<UI::Element> pointerCapture_;
+
+        UI::FocusManager focusManager_;
+
+        EventQueue eventQueue_;
+
+        // Renderer defaults, set in the constructor; the [render] section of config.ini overrides them
+        RenderConfig renderConfig_;
 
         Uint32 lastTime_ = 0;
         float deltaTime_ = 0.0f;
@@ -53,6 +103,12 @@ namespace TG5040
 
         void calculateDeltaTime();
         void handleEvents();
+        void dispatchEvent(const SDL_Event &event);
+        bool dispatchPointerEvent(const SDL_Event &event);
+        void setupEventFilter();
+        void setupLogLevels();
+        void setupFocusNavigation();
+        void logStats() const; // Audio, event and input latency totals of the run
         void update();
         void render();
         void limitFrameRate();
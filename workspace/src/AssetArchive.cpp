@@ -0,0 +1,147 @@
+#define TG5040_LOG_CATEGORY Sdl
+#include "AssetArchive.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TG5040
+{
+
+    AssetArchive::~AssetArchive()
+    {
+        close();
+    }
+
+    bool AssetArchive::open(const std::string &path)
+    {
+        using namespace AssetArchiveFormat;
+
+        close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat st;
+        void *data = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Header)))
+        {
+            data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            LOG_ERROR("Failed to map asset archive %s", path.c_str());
+            return false;
+        }
+
+        data_ = static_cast<const uint8_t *>(data);
+        size_ = static_cast<size_t>(st.st_size);
+
+        // Validate everything up front so lookups can trust the table
+        Header header;
+        std::memcpy(&header, data_, sizeof(header));
+        size_t stringsOffset = sizeof(Header) + static_cast<size_t>(header.entryCount) * sizeof(Entry);
+
+        bool valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+                     stringsOffset + header.stringTableSize <= size_ &&
+                     (header.stringTableSize == 0 || data_[stringsOffset + header.stringTableSize - 1] == '\0');
+        if (valid)
+        {
+            entries_ = reinterpret_cast<const Entry *>(data_ + sizeof(Header));
+            entryCount_ = header.entryCount;
+            strings_ = reinterpret_cast<const char *>(data_ + stringsOffset);
+
+            for (size_t i = 0; i < entryCount_ && valid; ++i)
+            {
+                const Entry &entry = entries_[i];
+                valid = entry.path < header.stringTableSize && entry.offset % DATA_ALIGNMENT == 0 &&
+                        static_cast<size_t>(entry.offset) + entry.size <= size_ &&
+                        (i == 0 || entries_[i - 1].hash <= entry.hash);
+            }
+        }
+
+        if (!valid)
+        {
+            LOG_ERROR("Invalid asset archive %s", path.c_str());
+            close();
+            return false;
+        }
+
+        LOG_INFO("Mapped asset archive %s (%zu files, %zu KB)", path.c_str(), entryCount_, size_ / 1024);
+        return true;
+    }
+
+    void AssetArchive::close()
+    {
+        if (data_)
+        {
+            munmap(const_cast<uint8_t *>(data_), size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+        entries_ = nullptr;
+        entryCount_ = 0;
+        strings_ = nullptr;
+    }
+
+    const AssetArchiveFormat::Entry *AssetArchive::lookup(const std::string &path) const
+    {
+        using AssetArchiveFormat::Entry;
+
+        if (!data_)
+        {
+            return nullptr;
+        }
+
+        uint32_t hash = AssetArchiveFormat::hashPath(path.data(), path.size());
+        const Entry *end = entries_ + entryCount_;
+        const Entry *it = std::lower_bound(entries_, end, hash, [](const Entry &entry, uint32_t value)
+                                           { return entry.hash < value; });
+
+        for (; it != end && it->hash == hash; ++it)
+        {
+            if (path == strings_ + it->path)
+            {
+                return it;
+            }
+        }
+        return nullptr;
+    }
+
+    bool AssetArchive::find(const std::string &path, const uint8_t *&data, size_t &size) const
+    {
+        const AssetArchiveFormat::Entry *entry = lookup(path);
+        if (!entry)
+        {
+            return false;
+        }
+        data = data_ + entry->offset;
+        size = entry->size;
+        return true;
+    }
+
+    bool AssetArchive::contains(const std::string &path) const
+    {
+        return lookup(path) != nullptr;
+    }
+
+    SDL_RWops *AssetArchive::openFile(const std::string &path) const
+    {
+        const AssetArchiveFormat::Entry *entry = lookup(path);
+        return entry ? SDL_RWFromConstMem(data_ + entry->offset, static_cast<int>(entry->size)) : nullptr;
+    }
+
+    const char *AssetArchive::entryPath(size_t index) const
+    {
+        return index < entryCount_ ? strings_ + entries_[index].path : nullptr;
+    }
+
+} // namespace TG5040
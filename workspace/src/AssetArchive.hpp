@@ -0,0 +1,47 @@
+#pragma once
+
+#include "AssetArchiveFormat.hpp"
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace TG5040
+{
+
+    // Read-only view of an archive built by tools/assetpack. The file is memory-mapped once;
+    // files are served straight from the mapping, so opening one costs a binary search.
+    class AssetArchive
+    {
+    public:
+        AssetArchive() = default;
+        ~AssetArchive();
+
+        AssetArchive(const AssetArchive &) = delete;
+        AssetArchive &operator=(const AssetArchive &) = delete;
+
+        bool open(const std::string &path);
+        void close();
+        bool isOpen() const { return data_ != nullptr; }
+
+        // Contents of a file, valid until close()
+        bool find(const std::string &path, const uint8_t *&data, size_t &size) const;
+        bool contains(const std::string &path) const;
+
+        // Zero-copy stream over the mapping, null if the file is not in the archive
+        SDL_RWops *openFile(const std::string &path) const;
+
+        size_t entryCount() const { return entryCount_; }
+        const char *entryPath(size_t index) const;
+
+    private:
+        const uint8_t *data_ = nullptr;
+        size_t size_ = 0;
+        const AssetArchiveFormat::Entry *entries_ = nullptr;
+        size_t entryCount_ = 0;
+        const char *strings_ = nullptr;
+
+        const AssetArchiveFormat::Entry *lookup(const std::string &path) const;
+    };
+
+} // namespace TG5040
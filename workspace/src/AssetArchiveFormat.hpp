@@ -0,0 +1,54 @@
+#pragma once
+
+// Binary layout of packed asset archives (res.pack).
+// Shared by the runtime AssetArchive and the host-side packer (tools/assetpack.cpp),
+// so this header must not depend on SDL.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace TG5040
+{
+    namespace AssetArchiveFormat
+    {
+
+        constexpr char MAGIC[4] = {'T', 'G', 'P', 'K'};
+        constexpr uint16_t VERSION = 1;
+        constexpr uint32_t DATA_ALIGNMENT = 16; // Keeps baked atlas pixels aligned inside the archive
+
+        struct Header
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t reserved;
+            uint32_t entryCount;
+            uint32_t stringTableSize;
+        };
+
+        // Entries are sorted by hash, then path, for binary search
+        struct Entry
+        {
+            uint32_t hash; // hashPath() of the path
+            uint32_t path; // String table offset, path as used at runtime (e.g. res/aller.ttf)
+            uint32_t offset; // From the start of the file, aligned to DATA_ALIGNMENT
+            uint32_t size;
+        };
+
+        static_assert(sizeof(Header) == 16, "Archive header layout changed");
+        static_assert(sizeof(Entry) == 16, "Archive entry layout changed");
+
+        // FNV-1a
+        inline uint32_t hashPath(const char *path, size_t length)
+        {
+            uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < length; ++i)
+            {
+                hash = (hash ^ static_cast<uint8_t>(path[i])) * 16777619u;
+            }
+            return hash;
+        }
+
+        // File layout: Header, Entry[entryCount], string table, then file data aligned to DATA_ALIGNMENT
+
+    } // namespace AssetArchiveFormat
+} // namespace TG5040
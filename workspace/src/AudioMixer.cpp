@@ -0,0 +1,620 @@
+#define TG5040_LOG_CATEGORY Sdl
+#include "AudioMixer.hpp"
+#include "Logger.hpp"
+#include "ResourceManager.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace TG5040
+{
+    namespace
+    {
+        int32_t toGain(float volume)
+        {
+            return static_cast<int32_t>(std::min(std::max(volume, 0.0f), 4.0f) * 4096.0f + 0.5f);
+        }
+
+        constexpr Uint32 MUSIC_POLL_MS = 5; // Music thread refill interval, well below the ring duration
+
+        void updateMax(std::atomic<uint64_t> &max, uint64_t value)
+        {
+            uint64_t current = max.load(std::memory_order_relaxed);
+            while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+    } // namespace
+
+    AudioMixer &AudioMixer::getInstance()
+    {
+        static AudioMixer instance;
+        return instance;
+    }
+
+    bool AudioMixer::initialize(const AudioConfig &config)
+    {
+        if (device_)
+        {
+            LOG_WARN("Audio mixer already initialized");
+            return true;
+        }
+
+        SDL_AudioSpec desired = {};
+        desired.freq = config.frequency;
+        desired.format = AUDIO_S16SYS;
+        desired.channels = 2;
+        desired.samples = static_cast<Uint16>(config.bufferFrames);
+        desired.callback = &AudioMixer::audioCallback;
+        desired.userdata = this;
+
+        // Mix at the device's own rate rather than letting SDL resample (and buffer) behind us
+        device_ = SDL_OpenAudioDevice(nullptr, 0, &desired, &spec_, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+        if (!device_)
+        {
+            LOG_ERROR("Failed to open audio device: %s", SDL_GetError());
+            return false;
+        }
+
+        mixBuffer_.assign(static_cast<size_t>(spec_.samples) * 2, 0);
+        perfFrequency_ = SDL_GetPerformanceFrequency();
+        for (auto &voice : voices_)
+        {
+            voice = Voice();
+        }
+        masterGain_ = 1 << GAIN_SHIFT;
+        musicBuffer_.assign(mixBuffer_.size(), 0);
+        musicGain_ = 1.0f;
+        musicBufferFrames_ = static_cast<size_t>(spec_.freq) * std::max(config.musicBufferMs, 50) / 1000;
+        resetStats();
+
+        SDL_PauseAudioDevice(device_, 0);
+        musicRunning_ = true;
+        musicThread_ = std::thread(&AudioMixer::musicThread, this);
+        LOG_INFO("Audio device opened: %d Hz, %d frames per buffer (%.1f ms)", spec_.freq, spec_.samples,
+                 spec_.samples * 1000.0f / spec_.freq);
+        return true;
+    }
+
+    void AudioMixer::shutdown()
+    {
+        if (!device_)
+        {
+            return;
+        }
+
+        musicRunning_ = false;
+        musicThread_.join();
+        SDL_CloseAudioDevice(device_);
+        device_ = 0;
+
+        // The callback is gone, drop anything it did not consume
+        Command command;
+        while (commands_.pop(command))
+        {
+        }
+        MusicCommand musicCommand;
+        while (musicCommands_.pop(musicCommand))
+        {
+        }
+        for (auto &slot : music_)
+        {
+            slot.stream.reset();
+        }
+        samples_.clear();
+        LOG_INFO("Audio mixer shut down");
+    }
+
+    SampleId AudioMixer::loadSample(const std::string &path)
+    {
+        if (!device_)
+        {
+            return INVALID_SAMPLE;
+        }
+        if (samples_.size() >= INVALID_SAMPLE)
+        {
+            LOG_ERROR("Too many samples loaded");
+            return INVALID_SAMPLE;
+        }
+
+        // The decoded WAV is only needed until it is converted
+        SoundHandle sound = ResourceManager::getInstance().loadSound(path);
+        const SoundData *data = sound.get();
+        if (!data)
+        {
+            return INVALID_SAMPLE;
+        }
+
+        SDL_AudioCVT cvt;
+        if (SDL_BuildAudioCVT(&cvt, data->spec.format, data->spec.channels, data->spec.freq,
+                              spec_.format, spec_.channels, spec_.freq) < 0)
+        {
+            LOG_ERROR("Cannot convert %s to the device format: %s", path.c_str(), SDL_GetError());
+            return INVALID_SAMPLE;
+        }
+
+        std::vector<Uint8> buffer(static_cast<size_t>(data->length) * std::max(cvt.len_mult, 1));
+        std::memcpy(buffer.data(), data->buffer, data->length);
+        cvt.buf = buffer.data();
+        cvt.len = static_cast<int>(data->length);
+        if (cvt.needed && SDL_ConvertAudio(&cvt) < 0)
+        {
+            LOG_ERROR("Conversion of %s failed: %s", path.c_str(), SDL_GetError());
+            return INVALID_SAMPLE;
+        }
+
+        size_t bytes = cvt.needed ? static_cast<size_t>(cvt.len_cvt) : data->length;
+        auto sample = std::make_unique<Sample>();
+        sample->frameCount = bytes / (2 * sizeof(int16_t));
+        sample->frames.resize(sample->frameCount * 2);
+        std::memcpy(sample->frames.data(), buffer.data(), sample->frameCount * 2 * sizeof(int16_t));
+
+        samples_.push_back(std::move(sample));
+        LOG_INFO("Loaded sample %s (%.2f s)", path.c_str(), samples_.back()->frameCount / static_cast<float>(spec_.freq));
+        return static_cast<SampleId>(samples_.size() - 1);
+    }
+
+    VoiceId AudioMixer::play(SampleId sample, float volume, float pan, bool loop)
+    {
+        if (!device_ || sample >= samples_.size())
+        {
+            return 0;
+        }
+
+        // Constant sum panning: centre plays both channels at full volume
+        pan = std::min(std::max(pan, -1.0f), 1.0f);
+        Command command;
+        command.type = CommandType::Play;
+        if (++nextVoice_ == 0)
+        {
+            ++nextVoice_; // 0 means no voice
+        }
+        command.voice = nextVoice_;
+        command.sample = samples_[sample].get();
+        command.gainLeft = toGain(volume * std::min(1.0f, 1.0f - pan));
+        command.gainRight = toGain(volume * std::min(1.0f, 1.0f + pan));
+        command.loop = loop;
+        return send(command) ? command.voice : 0;
+    }
+
+    void AudioMixer::stop(VoiceId voice)
+    {
+        Command command;
+        command.type = CommandType::Stop;
+        command.voice = voice;
+        send(command);
+    }
+
+    void AudioMixer::stopAll()
+    {
+        Command command;
+        command.type = CommandType::StopAll;
+        send(command);
+    }
+
+    void AudioMixer::setMasterVolume(float volume)
+    {
+        Command command;
+        command.type = CommandType::MasterVolume;
+        command.gainLeft = toGain(volume);
+        send(command);
+    }
+
+    bool AudioMixer::playMusic(const std::string &path, bool loop, float fadeSeconds)
+    {
+        if (!device_)
+        {
+            return false;
+        }
+
+        MusicCommand command;
+        command.play = true;
+        command.loop = loop;
+        command.fadeSeconds = fadeSeconds;
+        command.path = path;
+        if (!musicCommands_.push(command))
+        {
+            ++droppedCommands_;
+            return false;
+        }
+        return true;
+    }
+
+    void AudioMixer::stopMusic(float fadeSeconds)
+    {
+        if (!device_)
+        {
+            return;
+        }
+
+        MusicCommand command;
+        command.fadeSeconds = fadeSeconds;
+        if (!musicCommands_.push(command))
+        {
+            ++droppedCommands_;
+        }
+    }
+
+    void AudioMixer::setMusicVolume(float volume)
+    {
+        Command command;
+        command.type = CommandType::MusicVolume;
+        command.gainLeft = toGain(volume);
+        send(command);
+    }
+
+    void AudioMixer::musicThread()
+    {
+        while (musicRunning_.load(std::memory_order_relaxed))
+        {
+            MusicCommand command;
+            while (musicCommands_.pop(command))
+            {
+                applyMusicCommand(command);
+            }
+
+            for (auto &slot : music_)
+            {
+                if (!slot.stream)
+                {
+                    continue;
+                }
+
+                slot.stream->fill();
+                if (slot.silent.load(std::memory_order_acquire) || slot.stream->isFinished())
+                {
+                    // Detach under the lock, destroy (close the file) outside it
+                    std::unique_ptr<MusicStream> retired;
+                    SDL_LockAudioDevice(device_);
+                    retired = std::move(slot.stream);
+                    SDL_UnlockAudioDevice(device_);
+                }
+            }
+
+            SDL_Delay(MUSIC_POLL_MS);
+        }
+    }
+
+    void AudioMixer::applyMusicCommand(const MusicCommand &command)
+    {
+        if (!command.play)
+        {
+            fadeOutMusic(command.fadeSeconds);
+            return;
+        }
+
+        std::string error;
+        std::unique_ptr<MusicDecoder> decoder = MusicDecoder::open(command.path, error);
+        auto stream = decoder ? std::make_unique<MusicStream>(std::move(decoder), command.loop, spec_.freq, musicBufferFrames_) : nullptr;
+        if (!stream || !stream->isValid())
+        {
+            // playMusic() returned long ago, the log and the counter are the only report
+            LOG_ERROR("Cannot play music %s: %s", command.path.c_str(), stream ? "stream setup failed" : error.c_str());
+            musicFailures_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        // Decode ahead before it becomes audible
+        stream->fill();
+
+        std::unique_ptr<MusicStream> retired;
+        float fadeFrames = std::max(command.fadeSeconds * spec_.freq, 1.0f);
+        SDL_LockAudioDevice(device_);
+        fadeOutMusic(command.fadeSeconds);
+
+        // Both slots busy (a crossfade is still running): replace the quieter one
+        MusicSlot *target = &music_[0];
+        for (auto &slot : music_)
+        {
+            if (!slot.stream)
+            {
+                target = &slot;
+                break;
+            }
+            if (slot.gain < target->gain)
+            {
+                target = &slot;
+            }
+        }
+        retired = std::move(target->stream);
+        target->stream = std::move(stream);
+        target->gain = command.fadeSeconds > 0.0f ? 0.0f : 1.0f;
+        target->gainStep = command.fadeSeconds > 0.0f ? 1.0f / fadeFrames : 0.0f;
+        target->silent.store(false, std::memory_order_relaxed);
+        SDL_UnlockAudioDevice(device_);
+    }
+
+    void AudioMixer::fadeOutMusic(float fadeSeconds)
+    {
+        // Recursive device lock: also called from applyMusicCommand() with the lock held
+        float fadeFrames = std::max(fadeSeconds * spec_.freq, 1.0f);
+        SDL_LockAudioDevice(device_);
+        for (auto &slot : music_)
+        {
+            if (slot.stream && slot.gainStep >= 0.0f)
+            {
+                slot.gainStep = -std::max(slot.gain, 1.0f / fadeFrames) / fadeFrames;
+            }
+        }
+        SDL_UnlockAudioDevice(device_);
+    }
+
+    bool AudioMixer::send(Command command)
+    {
+        if (!device_)
+        {
+            return false;
+        }
+
+        command.issued = SDL_GetPerformanceCounter();
+        if (!commands_.push(command))
+        {
+            ++droppedCommands_;
+            return false;
+        }
+        return true;
+    }
+
+    void AudioMixer::audioCallback(void *userdata, Uint8 *stream, int len)
+    {
+        auto *mixer = static_cast<AudioMixer *>(userdata);
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        Command command;
+        while (mixer->commands_.pop(command))
+        {
+            mixer->applyCommand(command, start);
+        }
+
+        mixer->mix(reinterpret_cast<int16_t *>(stream), len / static_cast<int>(2 * sizeof(int16_t)));
+
+        uint64_t ticks = SDL_GetPerformanceCounter() - start;
+        mixer->lastCallbackTicks_.store(ticks, std::memory_order_relaxed);
+        mixer->totalCallbackTicks_.fetch_add(ticks, std::memory_order_relaxed);
+        updateMax(mixer->maxCallbackTicks_, ticks);
+        mixer->callbacks_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AudioMixer::applyCommand(const Command &command, Uint64 now)
+    {
+        uint64_t latency = now - command.issued;
+        totalCommandTicks_.fetch_add(latency, std::memory_order_relaxed);
+        updateMax(maxCommandTicks_, latency);
+        commandsApplied_.fetch_add(1, std::memory_order_relaxed);
+
+        switch (command.type)
+        {
+        case CommandType::Play:
+        {
+            // Free voice, or steal the one-shot closest to its end
+            Voice *slot = nullptr;
+            for (auto &voice : voices_)
+            {
+                if (voice.id == 0)
+                {
+                    slot = &voice;
+                    break;
+                }
+            }
+            if (!slot)
+            {
+                for (auto &voice : voices_)
+                {
+                    if (!voice.loop && (!slot || voice.sample->frameCount - voice.position < slot->sample->frameCount - slot->position))
+                    {
+                        slot = &voice;
+                    }
+                }
+                slot = slot ? slot : &voices_[0];
+                stolenVoices_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            slot->id = command.voice;
+            slot->sample = command.sample;
+            slot->position = 0;
+            slot->gainLeft = command.gainLeft;
+            slot->gainRight = command.gainRight;
+            slot->loop = command.loop;
+            break;
+        }
+        case CommandType::Stop:
+            for (auto &voice : voices_)
+            {
+                if (voice.id == command.voice)
+                {
+                    voice.id = 0;
+                }
+            }
+            break;
+        case CommandType::StopAll:
+            for (auto &voice : voices_)
+            {
+                voice.id = 0;
+            }
+            break;
+        case CommandType::MasterVolume:
+            masterGain_ = command.gainLeft;
+            break;
+        case CommandType::MusicVolume:
+            musicGain_ = command.gainLeft / static_cast<float>(1 << GAIN_SHIFT);
+            break;
+        }
+    }
+
+    void AudioMixer::mix(int16_t *output, int frames)
+    {
+        uint32_t active = 0;
+
+        while (frames > 0)
+        {
+            int chunk = std::min(frames, static_cast<int>(mixBuffer_.size() / 2));
+            int32_t *acc = mixBuffer_.data();
+            std::fill(acc, acc + chunk * 2, 0);
+
+            active = 0;
+            for (auto &voice : voices_)
+            {
+                if (voice.id == 0)
+                {
+                    continue;
+                }
+                ++active;
+
+                const int16_t *src = voice.sample->frames.data();
+                int written = 0;
+                while (written < chunk && voice.id != 0)
+                {
+                    size_t available = voice.sample->frameCount - voice.position;
+                    int count = static_cast<int>(std::min<size_t>(available, static_cast<size_t>(chunk - written)));
+                    const int16_t *in = src + voice.position * 2;
+                    int32_t *out = acc + written * 2;
+                    for (int i = 0; i < count; ++i)
+                    {
+                        out[2 * i] += (in[2 * i] * voice.gainLeft) >> GAIN_SHIFT;
+                        out[2 * i + 1] += (in[2 * i + 1] * voice.gainRight) >> GAIN_SHIFT;
+                    }
+                    written += count;
+                    voice.position += count;
+
+                    if (voice.position >= voice.sample->frameCount)
+                    {
+                        if (voice.loop && voice.sample->frameCount > 0)
+                        {
+                            voice.position = 0;
+                        }
+                        else
+                        {
+                            voice.id = 0;
+                        }
+                    }
+                }
+            }
+
+            mixMusic(acc, chunk);
+
+            for (int i = 0; i < chunk * 2; ++i)
+            {
+                // 16 voices and music near full scale times a gain above 1.0 overflow 32 bits
+                int64_t value = (static_cast<int64_t>(acc[i]) * masterGain_) >> GAIN_SHIFT;
+                output[i] = static_cast<int16_t>(std::min<int64_t>(std::max<int64_t>(value, -32768), 32767));
+            }
+
+            output += chunk * 2;
+            frames -= chunk;
+        }
+
+        activeVoices_.store(active, std::memory_order_relaxed);
+    }
+
+    void AudioMixer::mixMusic(int32_t *acc, int frames)
+    {
+        uint32_t streams = 0;
+        for (auto &slot : music_)
+        {
+            MusicStream *stream = slot.stream.get();
+            if (!stream || slot.silent.load(std::memory_order_relaxed))
+            {
+                continue;
+            }
+            ++streams;
+
+            size_t count = stream->read(musicBuffer_.data(), static_cast<size_t>(frames));
+            if (count < static_cast<size_t>(frames) && !stream->isDecodeDone())
+            {
+                musicUnderruns_.fetch_add(1, std::memory_order_relaxed);
+            }
+            musicBufferedFrames_.store(static_cast<uint32_t>(stream->bufferedFrames()), std::memory_order_relaxed);
+
+            const int16_t *in = musicBuffer_.data();
+            float gain = slot.gain;
+            float step = slot.gainStep;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (step != 0.0f)
+                {
+                    gain += step;
+                    if (gain >= 1.0f)
+                    {
+                        gain = 1.0f;
+                        step = 0.0f;
+                    }
+                    else if (gain <= 0.0f)
+                    {
+                        gain = 0.0f;
+                        break;
+                    }
+                }
+                float volume = gain * musicGain_;
+                acc[2 * i] += static_cast<int32_t>(in[2 * i] * volume);
+                acc[2 * i + 1] += static_cast<int32_t>(in[2 * i + 1] * volume);
+            }
+            slot.gain = gain;
+            slot.gainStep = step;
+            if (gain <= 0.0f && step < 0.0f)
+            {
+                slot.silent.store(true, std::memory_order_release); // The music thread removes it
+            }
+        }
+        musicStreams_.store(streams, std::memory_order_relaxed);
+    }
+
+    AudioStats AudioMixer::getStats() const
+    {
+        AudioStats stats;
+        stats.frequency = spec_.freq;
+        stats.bufferFrames = spec_.samples;
+        stats.bufferMs = spec_.freq > 0 ? spec_.samples * 1000.0f / spec_.freq : 0.0f;
+
+        float usPerTick = 1000000.0f / static_cast<float>(perfFrequency_);
+        stats.callbacks = callbacks_.load(std::memory_order_relaxed);
+        stats.lastCallbackUs = lastCallbackTicks_.load(std::memory_order_relaxed) * usPerTick;
+        stats.maxCallbackUs = maxCallbackTicks_.load(std::memory_order_relaxed) * usPerTick;
+        if (stats.callbacks > 0)
+        {
+            stats.avgCallbackUs = totalCallbackTicks_.load(std::memory_order_relaxed) * usPerTick / stats.callbacks;
+        }
+
+        uint64_t commands = commandsApplied_.load(std::memory_order_relaxed);
+        stats.maxCommandLatencyUs = maxCommandTicks_.load(std::memory_order_relaxed) * usPerTick;
+        if (commands > 0)
+        {
+            stats.avgCommandLatencyUs = totalCommandTicks_.load(std::memory_order_relaxed) * usPerTick / commands;
+        }
+
+        stats.activeVoices = activeVoices_.load(std::memory_order_relaxed);
+        stats.droppedCommands = droppedCommands_;
+        stats.stolenVoices = stolenVoices_.load(std::memory_order_relaxed);
+        stats.musicStreams = musicStreams_.load(std::memory_order_relaxed);
+        stats.musicBufferedMs = spec_.freq > 0 ? musicBufferedFrames_.load(std::memory_order_relaxed) * 1000.0f / spec_.freq : 0.0f;
+        stats.musicUnderruns = musicUnderruns_.load(std::memory_order_relaxed);
+        stats.musicFailures = musicFailures_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void AudioMixer::resetStats()
+    {
+        callbacks_ = 0;
+        lastCallbackTicks_ = 0;
+        totalCallbackTicks_ = 0;
+        maxCallbackTicks_ = 0;
+        commandsApplied_ = 0;
+        totalCommandTicks_ = 0;
+        maxCommandTicks_ = 0;
+        stolenVoices_ = 0;
+        musicUnderruns_ = 0;
+        musicFailures_ = 0;
+        droppedCommands_ = 0;
+    }
+
+    void AudioMixer::logStats() const
+    {
+        AudioStats stats = getStats();
+        LOG_INFO("Audio: %d Hz, %d frames (%.1f ms), %llu callbacks, callback avg %.1f us / max %.1f us, "
+                 "command latency avg %.1f us / max %.1f us, %llu dropped commands, %llu stolen voices, "
+                 "%llu music underruns, %llu music failures",
+                 stats.frequency, stats.bufferFrames, stats.bufferMs, static_cast<unsigned long long>(stats.callbacks),
+                 stats.avgCallbackUs, stats.maxCallbackUs, stats.avgCommandLatencyUs, stats.maxCommandLatencyUs,
+                 static_cast<unsigned long long>(stats.droppedCommands), static_cast<unsigned long long>(stats.stolenVoices),
+                 static_cast<unsigned long long>(stats.musicUnderruns), static_cast<unsigned long long>(stats.musicFailures));
+    }
+
+} // namespace TG5040
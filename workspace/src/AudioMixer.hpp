@@ -0,0 +1,205 @@
+#pragma once
+
+#include "MusicStream.hpp"
+#include "SpscQueue.hpp"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TG5040
+{
+
+    // Handle to a sample converted to the device format
+    using SampleId = uint16_t;
+    constexpr SampleId INVALID_SAMPLE = 0xFFFF;
+
+    // Handle to one playback of a sample, 0 = none
+    using VoiceId = uint32_t;
+
+    struct AudioConfig
+    {
+        int frequency = 48000;
+        int bufferFrames = 256; // Per callback, ~5 ms at 48 kHz
+        int musicBufferMs = 500; // Decoded ahead per music stream
+    };
+
+    struct AudioStats
+    {
+        int frequency = 0;
+        int bufferFrames = 0;
+        float bufferMs = 0.0f; // Device buffer duration, the floor for output latency
+        uint64_t callbacks = 0;
+        float lastCallbackUs = 0.0f;
+        float avgCallbackUs = 0.0f;
+        float maxCallbackUs = 0.0f;
+        float avgCommandLatencyUs = 0.0f; // From play() until the callback picked it up
+        float maxCommandLatencyUs = 0.0f;
+        uint32_t activeVoices = 0;
+        uint64_t droppedCommands = 0; // Queue was full
+        uint64_t stolenVoices = 0;    // All voices busy, the oldest one was replaced
+        uint32_t musicStreams = 0;    // Playing or fading out
+        float musicBufferedMs = 0.0f; // Decoded ahead of the newest music stream
+        uint64_t musicUnderruns = 0;  // Callbacks that found a music buffer short
+        uint64_t musicFailures = 0;   // Tracks that could not be opened
+    };
+
+    // Sound effect mixer running in the SDL audio callback.
+    //
+    // Samples are converted to the device format (16-bit stereo at the device rate) once when
+    // loaded, so the callback only adds them up. The main thread controls playback through a
+    // lock-free single-producer/single-consumer command queue: play() and stop() never take a
+    // lock and never wait for the audio thread.
+    //
+    // Music is streamed instead: a decoder thread fills a lock-free ring buffer per track that
+    // the callback drains, so neither the main thread nor the callback ever decodes.
+    class AudioMixer
+    {
+    public:
+        static constexpr int MAX_VOICES = 16;
+        static constexpr size_t COMMAND_QUEUE_SIZE = 64;
+        static constexpr int MUSIC_SLOTS = 2; // Current track and the one fading out
+
+        static AudioMixer &getInstance();
+
+        bool initialize(const AudioConfig &config = AudioConfig());
+        void shutdown();
+        bool isInitialized() const { return device_ != 0; }
+
+        // Decode a WAV through the ResourceManager and convert it; loaded samples stay until shutdown
+        SampleId loadSample(const std::string &path);
+
+        // Main thread only. volume 0..1, pan -1 (left) .. 1 (right)
+        VoiceId play(SampleId sample, float volume = 1.0f, float pan = 0.0f, bool loop = false);
+        void stop(VoiceId voice);
+        void stopAll();
+        void setMasterVolume(float volume);
+
+        // Stream a WAV (or OGG with VORBIS=1) on the decoder thread, crossfading from the current
+        // track over fadeSeconds. Looping tracks restart without a gap.
+        bool playMusic(const std::string &path, bool loop = true, float fadeSeconds = 0.0f);
+        void stopMusic(float fadeSeconds = 0.0f);
+        void setMusicVolume(float volume);
+
+        AudioStats getStats() const;
+        void resetStats();
+        void logStats() const;
+
+        // Prevent copying
+        AudioMixer(const AudioMixer &) = delete;
+        AudioMixer &operator=(const AudioMixer &) = delete;
+
+    private:
+        AudioMixer() = default;
+        ~AudioMixer() = default;
+
+        static constexpr int GAIN_SHIFT = 12; // Fixed point gains, 1.0 = 4096
+
+        struct Sample
+        {
+            std::vector<int16_t> frames; // Interleaved stereo
+            size_t frameCount = 0;
+        };
+
+        enum class CommandType : uint8_t
+        {
+            Play,
+            Stop,
+            StopAll,
+            MasterVolume,
+            MusicVolume
+        };
+
+        struct Command
+        {
+            CommandType type = CommandType::Play;
+            bool loop = false;
+            VoiceId voice = 0;
+            const Sample *sample = nullptr;
+            int32_t gainLeft = 0;
+            int32_t gainRight = 0;
+            Uint64 issued = 0; // Performance counter
+        };
+
+        // Owned by the audio thread
+        struct Voice
+        {
+            VoiceId id = 0; // 0 = free
+            const Sample *sample = nullptr;
+            size_t position = 0; // In frames
+            int32_t gainLeft = 0;
+            int32_t gainRight = 0;
+            bool loop = false;
+        };
+
+        struct MusicCommand
+        {
+            bool play = false; // Otherwise stop
+            bool loop = false;
+            float fadeSeconds = 0.0f;
+            std::string path;
+        };
+
+        // Stream pointer and ramp change only with the device locked; the callback owns the rest
+        struct MusicSlot
+        {
+            std::unique_ptr<MusicStream> stream; // Owned by the music thread
+            float gain = 0.0f;
+            float gainStep = 0.0f; // Per frame, > 0 fading in, < 0 fading out
+            std::atomic<bool> silent{false}; // Faded out, set by the callback
+        };
+
+        SDL_AudioDeviceID device_ = 0;
+        SDL_AudioSpec spec_ = {};
+        std::vector<std::unique_ptr<Sample>> samples_; // Pointers stay valid while the device is open
+        VoiceId nextVoice_ = 0;
+
+        SpscQueue<Command, COMMAND_QUEUE_SIZE> commands_;
+
+        // Audio thread state
+        Voice voices_[MAX_VOICES];
+        int32_t masterGain_ = 1 << GAIN_SHIFT;
+        std::vector<int32_t> mixBuffer_;
+        std::vector<int16_t> musicBuffer_;
+        float musicGain_ = 1.0f;
+
+        // Music decoder thread
+        SpscQueue<MusicCommand, 8> musicCommands_;
+        MusicSlot music_[MUSIC_SLOTS];
+        std::thread musicThread_;
+        std::atomic<bool> musicRunning_{false};
+        size_t musicBufferFrames_ = 0;
+
+        // Written by the audio thread, read by getStats()
+        Uint64 perfFrequency_ = 1;
+        std::atomic<uint64_t> callbacks_{0};
+        std::atomic<uint64_t> lastCallbackTicks_{0};
+        std::atomic<uint64_t> totalCallbackTicks_{0};
+        std::atomic<uint64_t> maxCallbackTicks_{0};
+        std::atomic<uint64_t> commandsApplied_{0};
+        std::atomic<uint64_t> totalCommandTicks_{0};
+        std::atomic<uint64_t> maxCommandTicks_{0};
+        std::atomic<uint32_t> activeVoices_{0};
+        std::atomic<uint64_t> stolenVoices_{0};
+        std::atomic<uint64_t> musicUnderruns_{0};
+        std::atomic<uint32_t> musicStreams_{0};
+        std::atomic<uint32_t> musicBufferedFrames_{0};
+        std::atomic<uint64_t> musicFailures_{0};
+        uint64_t droppedCommands_ = 0; // Main thread
+
+        bool send(Command command);
+
+        static void audioCallback(void *userdata, Uint8 *stream, int len);
+        void mix(int16_t *output, int frames);
+        void applyCommand(const Command &command, Uint64 now);
+        void mixMusic(int32_t *acc, int frames);
+
+        void musicThread();
+        void applyMusicCommand(const MusicCommand &command);
+        void fadeOutMusic(float fadeSeconds);
+    };
+
+} // namespace TG5040
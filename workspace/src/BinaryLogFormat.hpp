@@ -0,0 +1,106 @@
+#pragma once
+
+// Layout of binary log files, written by Logger in LogOutput::Binary mode, and of flight
+// recorder files. Both are turned back into text by the host-side decoder
+// (tools/logdecode.cpp), so this header must not depend on SDL.
+//
+// A file is a Header followed by entries. A SiteEntry describes a log statement the first
+// time it is used in the file: its level, source location and format string. Each RecordEntry
+// then refers to a site and carries the timestamp and the raw arguments, so nothing is
+// formatted on the device. Values are stored in the device's (little-endian) byte order.
+
+#include <cstdint>
+
+namespace TG5040
+{
+    namespace BinaryLogFormat
+    {
+
+        constexpr char MAGIC[4] = {'T', 'G', 'L', 'B'};
+        constexpr uint16_t VERSION = 1;
+
+        enum EntryType : uint8_t
+        {
+            ENTRY_SITE = 1,
+            ENTRY_RECORD = 2
+        };
+
+        // Each argument is a tag byte and its value: int32 (ARG_INT), int64 (ARG_INT64), uint32
+        // (ARG_UINT), uint64 (ARG_UINT64, ARG_POINTER), double (ARG_DOUBLE), or a uint16 length and
+        // that many bytes (ARG_STRING)
+        enum ArgType : uint8_t
+        {
+            ARG_INT = 'i',
+            ARG_INT64 = 'l',
+            ARG_UINT = 'u',
+            ARG_UINT64 = 'q',
+            ARG_DOUBLE = 'd',
+            ARG_STRING = 's',
+            ARG_POINTER = 'p'
+        };
+
+        struct Header
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t reserved;
+        };
+
+        // Followed by the file name and the format string, neither terminated
+        struct SiteEntry
+        {
+            uint8_t type; // ENTRY_SITE
+            uint8_t level; // LogLevel
+            uint16_t fileLength;
+            uint32_t id; // Numbered from 1 in each file
+            uint32_t line;
+            uint32_t formatLength;
+        };
+
+        // Followed by payloadLength bytes of arguments
+        struct RecordEntry
+        {
+            uint8_t type; // ENTRY_RECORD
+            uint8_t reserved;
+            uint16_t payloadLength;
+            uint32_t site;
+            uint64_t timeNs; // Wall clock, nanoseconds since the Unix epoch
+        };
+
+        // Flight recorder files (FlightRecorder): a FlightHeader followed by slotCount fixed-size
+        // slots used as a ring. Each slot holds one record, its sequence number orders them.
+        constexpr char FLIGHT_MAGIC[4] = {'T', 'G', 'F', 'R'};
+        constexpr uint16_t FLIGHT_VERSION = 1;
+        constexpr uint32_t FLIGHT_SLOT_SIZE = 256;
+        constexpr uint32_t FLIGHT_FILE_SIZE = 32;
+        constexpr uint32_t FLIGHT_PAYLOAD_SIZE = 200;
+
+        struct FlightHeader
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t slotSize;
+            uint32_t slotCount;
+            uint32_t reserved;
+        };
+
+        struct FlightSlot
+        {
+            uint64_t sequence; // From 1, 0 while the slot is being written
+            uint64_t timeNs;   // Wall clock, nanoseconds since the Unix epoch
+            uint32_t line;
+            uint8_t level;
+            uint8_t packed;  // 0: payload is the message; 1: format string, its terminator, packed arguments
+            uint16_t length; // Payload bytes used
+            char file[FLIGHT_FILE_SIZE];
+            char payload[FLIGHT_PAYLOAD_SIZE];
+        };
+
+        static_assert(sizeof(Header) == 8, "Binary log header layout changed");
+        static_assert(sizeof(FlightHeader) == 16, "Flight recorder header layout changed");
+        static_assert(sizeof(FlightSlot) == FLIGHT_SLOT_SIZE, "Flight recorder slot layout changed");
+        static_assert(sizeof(SiteEntry) == 16, "Binary log site entry layout changed");
+        static_assert(sizeof(RecordEntry) == 16, "Binary log record entry layout changed");
+
+    } // namespace BinaryLogFormat
+} // namespace TG5040
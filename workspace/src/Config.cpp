@@ -0,0 +1,158 @@
+#include "Config.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace TG5040
+{
+    namespace
+    {
+        std::string trim(const std::string &s)
+        {
+            size_t start = s.find_first_not_of(" \t\r\n");
+            if (start == std::string::npos)
+            {
+                return "";
+            }
+            size_t end = s.find_last_not_of(" \t\r\n");
+            return s.substr(start, end - start + 1);
+        }
+
+        std::string lower(std::string s)
+        {
+            std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+        std::string environmentName(const std::string &section, const std::string &key)
+        {
+            std::string name = "TG5040_" + section + "_" + key;
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c)
+                           { return std::isalnum(c) ? static_cast<char>(std::toupper(c)) : '_'; });
+            return name;
+        }
+    } // namespace
+
+    Config &Config::getInstance()
+    {
+        static Config instance;
+        return instance;
+    }
+
+    bool Config::load(const std::string &path)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            values_.clear();
+            return false;
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        return parse(buffer.str());
+    }
+
+    bool Config::parse(const std::string &text)
+    {
+        values_.clear();
+
+        std::istringstream stream(text);
+        std::string line;
+        std::string section;
+
+        while (std::getline(stream, line))
+        {
+            line = trim(line);
+            if (line.empty() || line[0] == ';' || line[0] == '#')
+            {
+                continue;
+            }
+
+            if (line.front() == '[')
+            {
+                size_t close = line.find(']');
+                section = lower(trim(line.substr(1, close == std::string::npos ? std::string::npos : close - 1)));
+                continue;
+            }
+
+            size_t equals = line.find('=');
+            if (equals == std::string::npos)
+            {
+                continue;
+            }
+
+            set(section, trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+        }
+
+        return true;
+    }
+
+    const std::string *Config::find(const std::string &section, const std::string &key) const
+    {
+        auto it = values_.find(lower(section) + "." + lower(key));
+        return it != values_.end() ? &it->second : nullptr;
+    }
+
+    bool Config::has(const std::string &section, const std::string &key) const
+    {
+        return std::getenv(environmentName(section, key).c_str()) || find(section, key);
+    }
+
+    std::string Config::getString(const std::string &section, const std::string &key, const std::string &defaultValue) const
+    {
+        if (const char *env = std::getenv(environmentName(section, key).c_str()))
+        {
+            return env;
+        }
+        const std::string *value = find(section, key);
+        return value ? *value : defaultValue;
+    }
+
+    int Config::getInt(const std::string &section, const std::string &key, int defaultValue) const
+    {
+        std::string value = getString(section, key);
+        if (value.empty())
+        {
+            return defaultValue;
+        }
+        char *end = nullptr;
+        long result = std::strtol(value.c_str(), &end, 10);
+        return *end == '\0' ? static_cast<int>(result) : defaultValue;
+    }
+
+    float Config::getFloat(const std::string &section, const std::string &key, float defaultValue) const
+    {
+        std::string value = getString(section, key);
+        if (value.empty())
+        {
+            return defaultValue;
+        }
+        char *end = nullptr;
+        float result = std::strtof(value.c_str(), &end);
+        return *end == '\0' ? result : defaultValue;
+    }
+
+    bool Config::getBool(const std::string &section, const std::string &key, bool defaultValue) const
+    {
+        std::string value = lower(getString(section, key));
+        if (value == "1" || value == "true" || value == "yes" || value == "on")
+        {
+            return true;
+        }
+        if (value == "0" || value == "false" || value == "no" || value == "off")
+        {
+            return false;
+        }
+        return defaultValue;
+    }
+
+    void Config::set(const std::string &section, const std::string &key, const std::string &value)
+    {
+        values_[lower(section) + "." + lower(key)] = value;
+    }
+
+} // namespace TG5040
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+namespace TG5040
+{
+
+    // Runtime settings read from config.ini (the same file the makefile reads the project
+    // name from, copied next to the executable by make pak).
+    //
+    //   [render]
+    //   backend = opengles2
+    //
+    // Every key can be overridden from the environment as TG5040_<SECTION>_<KEY>,
+    // e.g. TG5040_RENDER_BACKEND=software, which is how CI switches settings without a file.
+    class Config
+    {
+    public:
+        static Config &getInstance();
+
+        // Replaces all values, false if the file could not be opened
+        bool load(const std::string &path);
+        bool parse(const std::string &text);
+
+        bool has(const std::string &section, const std::string &key) const;
+        std::string getString(const std::string &section, const std::string &key, const std::string &defaultValue = "") const;
+        int getInt(const std::string &section, const std::string &key, int defaultValue = 0) const;
+        float getFloat(const std::string &section, const std::string &key, float defaultValue = 0.0f) const;
+        bool getBool(const std::string &section, const std::string &key, bool defaultValue = false) const;
+
+        void set(const std::string &section, const std::string &key, const std::string &value);
+
+        // Prevent copying
+        Config(const Config &) = delete;
+        Config &operator=(const Config &) = delete;
+
+    private:
+        Config() = default;
+        ~Config() = default;
+
+        std::unordered_map<std::string, std::string> values_; // Key is "section.key"
+
+        const std::string *find(const std::string &section, const std::string &key) const;
+    };
+
+} // namespace TG5040
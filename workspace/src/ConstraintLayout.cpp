@@ -1,4 +1,6 @@
 #include "ConstraintLayout.hpp"
+#include "Animator.hpp"
+#include "StyleSheet.hpp"
 #include "SDLManager.hpp"
 #include "Logger.hpp"
 #include <algorithm>
@@ -27,8 +29,15 @@ namespace TG5040
         }
 
         // Element implementation
-        Element::Element(const std::string &tag) : tag_(tag)
+        uint32_t Element::hierarchyGeneration_ = 0;
+
+        Element::Element(const std::string &tag) : tag_(tag), tagId_(StyleSheet::intern(tag))
+        {
+        }
+
+        Element::~Element()
         {
+            Animator::getInstance().forget(this);
         }
 
         void Element::addChild(ElementPtr child)
@@ -46,6 +55,8 @@ namespace TG5040
 
             children_.push_back(child);
             child->parent_ = this;
+            child->setNeedsStyle();
+            ++hierarchyGeneration_;
             setNeedsLayout();
         }
 
@@ -56,6 +67,7 @@ namespace TG5040
             {
                 (*it)->parent_ = nullptr;
                 children_.erase(it);
+                ++hierarchyGeneration_;
                 setNeedsLayout();
             }
         }
@@ -157,6 +169,143 @@ namespace TG5040
             setNeedsLayout();
         }
 
+        void Element::translate(float dx, float dy)
+        {
+            frame.x += dx;
+            frame.y += dy;
+            for (auto &child : children_)
+            {
+                child->translate(dx, dy);
+            }
+        }
+
+        void Element::setFocused(bool focused)
+        {
+            if (focused_ != focused)
+            {
+                focused_ = focused;
+                setState(ElementState::Focused, focused);
+                onFocusChanged(focused);
+            }
+        }
+
+        void Element::setTag(const std::string &tag)
+        {
+            tag_ = tag;
+            tagId_ = StyleSheet::intern(tag);
+            setNeedsStyle();
+        }
+
+        void Element::setId(const std::string &id)
+        {
+            id_ = id;
+            idId_ = StyleSheet::intern(id);
+            setNeedsStyle();
+        }
+
+        void Element::addClass(const std::string &name)
+        {
+            uint32_t cls = StyleSheet::intern(name);
+            if (cls && std::find(classIds_.begin(), classIds_.end(), cls) == classIds_.end())
+            {
+                classIds_.push_back(cls);
+                setNeedsStyle();
+            }
+        }
+
+        void Element::removeClass(const std::string &name)
+        {
+            auto it = std::find(classIds_.begin(), classIds_.end(), StyleSheet::intern(name));
+            if (it != classIds_.end())
+            {
+                classIds_.erase(it);
+                setNeedsStyle();
+            }
+        }
+
+        bool Element::hasClass(const std::string &name) const
+        {
+            return std::find(classIds_.begin(), classIds_.end(), StyleSheet::intern(name)) != classIds_.end();
+        }
+
+        void Element::setState(ElementState state, bool enabled)
+        {
+            uint32_t bits = enabled ? (state_ | static_cast<uint32_t>(state)) : (state_ & ~static_cast<uint32_t>(state));
+            if (bits != state_)
+            {
+                state_ = bits;
+                setNeedsStyle();
+            }
+        }
+
+        void Element::setNeedsStyle()
+        {
+            styleDirty_ = true;
+            for (Element *e = parent_; e && !e->childNeedsStyle_; e = e->parent_)
+            {
+                e->childNeedsStyle_ = true;
+            }
+        }
+
+        // The value a property takes under `style`: the styled one, or the element's own value
+        // saved when it was first styled once no rule sets it. Null leaves the property alone.
+        template <typename T>
+        static const T *restyle(const ComputedStyle &style, ComputedStyle *unstyled, ComputedStyle::Property property,
+                                T ComputedStyle::*field, const T &current)
+        {
+            if (style.has(property))
+            {
+                if (!unstyled->has(property))
+                {
+                    unstyled->*field = current;
+                    unstyled->mask |= property;
+                }
+                return &(style.*field);
+            }
+            if (unstyled && unstyled->has(property))
+            {
+                unstyled->mask &= ~static_cast<uint32_t>(property);
+                return &(unstyled->*field);
+            }
+            return nullptr;
+        }
+
+        void Element::applyStyle(const ComputedStyle &style)
+        {
+            if (style.mask && !unstyled_)
+            {
+                unstyled_ = std::make_unique<ComputedStyle>();
+            }
+            ComputedStyle *unstyled = unstyled_.get();
+            if (const Color *value = restyle(style, unstyled, ComputedStyle::BackgroundColor, &ComputedStyle::backgroundColor, backgroundColor))
+                backgroundColor = *value;
+            if (const Color *value = restyle(style, unstyled, ComputedStyle::BorderColor, &ComputedStyle::borderColor, borderColor))
+                borderColor = *value;
+            if (const float *value = restyle(style, unstyled, ComputedStyle::BorderWidth, &ComputedStyle::borderWidth, borderWidth))
+                borderWidth = *value;
+            if (const float *value = restyle(style, unstyled, ComputedStyle::Opacity, &ComputedStyle::opacity, opacity))
+                opacity = *value;
+            if (const float *value = restyle(style, unstyled, ComputedStyle::CornerRadius, &ComputedStyle::cornerRadius, cornerRadius))
+                cornerRadius = *value;
+        }
+
+        float Element::effectiveOpacity() const
+        {
+            float result = opacity;
+            for (const Element *e = parent_; e; e = e->parent_)
+            {
+                result *= e->opacity;
+            }
+            return result;
+        }
+
+        Color Element::applyOpacity(const Color &color) const
+        {
+            Color result = color;
+            result.a = static_cast<uint8_t>(color.a * std::min(std::max(effectiveOpacity(), 0.0f), 1.0f));
+            return result;
+        }
+
         void Element::layoutSubviews()
         {
             // Layout children
@@ -185,9 +334,10 @@ namespace TG5040
 
         void Element::renderBackground(SDL_Renderer *renderer)
         {
-            if (backgroundColor.a > 0)
+            Color color = applyOpacity(backgroundColor);
+            if (color.a > 0)
             {
-                SDL_SetRenderDrawColor(renderer, backgroundColor.r, backgroundColor.g, backgroundColor.b, backgroundColor.a);
+                SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
                 SDL_Rect rect = frame.toSDL();
                 SDL_RenderFillRect(renderer, &rect);
             }
@@ -197,7 +347,8 @@ namespace TG5040
         {
             if (borderWidth > 0)
             {
-                SDL_SetRenderDrawColor(renderer, borderColor.r, borderColor.g, borderColor.b, borderColor.a);
+                Color color = applyOpacity(borderColor);
+                SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
                 SDL_Rect rect = frame.toSDL();
 
                 for (int i = 0; i < static_cast<int>(borderWidth); ++i)
@@ -310,6 +461,7 @@ namespace TG5040
         Text::Text(const std::string &text, int fontSize)
             : Element("text"), text_(text), fontSize_(fontSize)
         {
+            fontId_ = SDLManager::getInstance().registerFont(fontPath_, fontSize_);
             calculateTextSize();
         }
 
@@ -328,6 +480,7 @@ namespace TG5040
             if (fontSize_ != size)
             {
                 fontSize_ = size;
+                fontId_ = SDLManager::getInstance().registerFont(fontPath_, fontSize_);
                 calculateTextSize();
                 setNeedsLayout();
             }
@@ -338,105 +491,115 @@ namespace TG5040
             if (fontPath_ != fontPath)
             {
                 fontPath_ = fontPath;
+                fontId_ = SDLManager::getInstance().registerFont(fontPath_, fontSize_);
                 calculateTextSize();
                 setNeedsLayout();
             }
         }
 
-        void Text::renderContent(SDL_Renderer *renderer)
+        void Text::setNumberOfLines(int lines)
         {
-            if (text_.empty())
+            if (numberOfLines_ != lines)
             {
-                return;
+                numberOfLines_ = lines;
+                calculateTextSize();
+                setNeedsLayout();
             }
+        }
 
-            // Get font from SDLManager
-            TTF_Font *font = nullptr;
-            if (fontPath_.empty())
+        void Text::setPreferredMaxWidth(float width)
+        {
+            if (preferredMaxWidth_ != width)
             {
-                font = SDLManager::getInstance().getDefaultFont(fontSize_);
+                preferredMaxWidth_ = width;
+                calculateTextSize();
+                setNeedsLayout();
             }
-            else
+        }
+
+        void Text::setLineSpacing(float spacing)
+        {
+            if (lineSpacing_ != spacing)
             {
-                font = SDLManager::getInstance().getFont(fontPath_, fontSize_);
+                lineSpacing_ = spacing;
+                calculateTextSize();
+                setNeedsLayout();
             }
+        }
 
-            if (!font)
+        void Text::setTruncatesWithEllipsis(bool ellipsis)
+        {
+            if (ellipsis_ != ellipsis)
             {
-                // Fallback to simple rectangle rendering if font loading fails
-                SDL_SetRenderDrawColor(renderer, textColor_.r, textColor_.g, textColor_.b, textColor_.a);
-
-                float charWidth = fontSize_ * 0.6f;
-                float x = frame.x + 5;
-                float y = frame.y + 5;
-
-                for (size_t i = 0; i < text_.length() && x < frame.x + frame.width - charWidth; ++i)
-                {
-                    SDL_Rect charRect = {
-                        static_cast<int>(x),
-                        static_cast<int>(y),
-                        static_cast<int>(charWidth * 0.8f),
-                        static_cast<int>(fontSize_)};
-                    SDL_RenderDrawRect(renderer, &charRect);
-                    x += charWidth;
-                }
-                return;
+                ellipsis_ = ellipsis;
+                calculateTextSize();
+                setNeedsLayout();
             }
+        }
 
-            // Render actual text using TTF
-            SDL_Color sdlColor = textColor_.toSDL();
-            SDL_Surface *textSurface = TTF_RenderText_Blended(font, text_.c_str(), sdlColor);
+        void Text::applyStyle(const ComputedStyle &style)
+        {
+            Element::applyStyle(style);
+            ComputedStyle *unstyled = unstyled_.get();
+            if (const Color *value = restyle(style, unstyled, ComputedStyle::TextColor, &ComputedStyle::textColor, textColor_))
+                textColor_ = *value;
+            if (const int *value = restyle(style, unstyled, ComputedStyle::FontSize, &ComputedStyle::fontSize, fontSize_))
+                setFontSize(*value);
+            if (const std::string *value = restyle(style, unstyled, ComputedStyle::FontPath, &ComputedStyle::fontPath, fontPath_))
+                setFontPath(*value);
+        }
 
-            if (!textSurface)
+        void Text::renderContent(SDL_Renderer *renderer)
+        {
+            if (text_.empty())
             {
-                LOG_ERROR("Failed to render text surface: %s", TTF_GetError());
                 return;
             }
 
-            SDL_Texture *textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-            SDL_FreeSurface(textSurface);
+            Color color = applyOpacity(textColor_);
 
-            if (!textTexture)
+            // Wrap to the frame (minus padding) and center the block vertically
+            int boxWidth = static_cast<int>(frame.width) - 10;
+            layout_.layout(boxWidth, numberOfLines_, ellipsis_);
+            if (layout_.lineHeight() > 0)
             {
-                LOG_ERROR("Failed to create text texture: %s", SDL_GetError());
+                int y = static_cast<int>(frame.y + (frame.height - layout_.height(lineSpacing_)) * 0.5f);
+                layout_.draw(static_cast<int>(frame.x) + 5, y, boxWidth, alignment_, lineSpacing_, color.toSDL());
                 return;
             }
 
-            // Get text dimensions
-            int textWidth, textHeight;
-            SDL_QueryTexture(textTexture, NULL, NULL, &textWidth, &textHeight);
+            // Fallback to simple rectangle rendering if font loading fails
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
 
-            // Center text in the frame
-            SDL_Rect destRect = {
-                static_cast<int>(frame.x + (frame.width - textWidth) * 0.5f),
-                static_cast<int>(frame.y + (frame.height - textHeight) * 0.5f),
-                textWidth,
-                textHeight};
+            float charWidth = fontSize_ * 0.6f;
+            float x = frame.x + 5;
+            float y = frame.y + 5;
 
-            SDL_RenderCopy(renderer, textTexture, NULL, &destRect);
-            SDL_DestroyTexture(textTexture);
+            for (size_t i = 0; i < text_.length() && x < frame.x + frame.width - charWidth; ++i)
+            {
+                SDL_Rect charRect = {
+                    static_cast<int>(x),
+                    static_cast<int>(y),
+                    static_cast<int>(charWidth * 0.8f),
+                    static_cast<int>(fontSize_)};
+                SDL_RenderDrawRect(renderer, &charRect);
+                x += charWidth;
+            }
         }
 
         void Text::calculateTextSize()
         {
-            // Try to get actual text dimensions using font
-            TTF_Font *font = nullptr;
-            if (fontPath_.empty())
-            {
-                font = SDLManager::getInstance().getDefaultFont(fontSize_);
-            }
-            else
+            // Try to get actual text dimensions from the glyph metrics
+            layout_.setFont(fontId_);
+            layout_.setText(text_);
+            if (!text_.empty())
             {
-                font = SDLManager::getInstance().getFont(fontPath_, fontSize_);
-            }
-
-            if (font && !text_.empty())
-            {
-                int textWidth, textHeight;
-                if (TTF_SizeText(font, text_.c_str(), &textWidth, &textHeight) == 0)
+                int maxWidth = preferredMaxWidth_ > 0 ? static_cast<int>(preferredMaxWidth_) - 10 : 0;
+                layout_.layout(maxWidth, numberOfLines_, ellipsis_);
+                if (layout_.lineHeight() > 0)
                 {
-                    frame.width = textWidth + 10;   // 5px padding on each side
-                    frame.height = textHeight + 10; // 5px padding top/bottom
+                    frame.width = layout_.width() + 10;                 // 5px padding on each side
+                    frame.height = layout_.height(lineSpacing_) + 10; // 5px padding top/bottom
                     return;
                 }
             }
@@ -466,7 +629,9 @@ namespace TG5040
                 if (frame.contains(event.button.x, event.button.y))
                 {
                     isPressed_ = true;
+                    normalColor_ = backgroundColor;
                     backgroundColor = pressedColor_;
+                    setState(ElementState::Pressed, true);
                     return true;
                 }
             }
@@ -476,6 +641,7 @@ namespace TG5040
                 {
                     isPressed_ = false;
                     backgroundColor = normalColor_;
+                    setState(ElementState::Pressed, false);
 
                     if (frame.contains(event.button.x, event.button.y) && onClickCallback_)
                     {
@@ -488,6 +654,29 @@ namespace TG5040
             return Element::handleEvent(event);
         }
 
+        bool Button::activate()
+        {
+            if (onClickCallback_)
+            {
+                onClickCallback_();
+                return true;
+            }
+            return false;
+        }
+
+        void Button::applyStyle(const ComputedStyle &style)
+        {
+            Element::applyStyle(style);
+            ComputedStyle *unstyled = unstyled_.get();
+            if (const Color *value = restyle(style, unstyled, ComputedStyle::TextColor, &ComputedStyle::textColor, textColor_))
+                textColor_ = *value;
+            if (const int *value = restyle(style, unstyled, ComputedStyle::FontSize, &ComputedStyle::fontSize, fontSize_))
+            {
+                fontSize_ = *value;
+                setNeedsLayout();
+            }
+        }
+
         void Button::renderContent(SDL_Renderer *renderer)
         {
             if (title_.empty())
@@ -496,7 +685,8 @@ namespace TG5040
             }
 
             // Simple button text rendering
-            SDL_SetRenderDrawColor(renderer, textColor_.r, textColor_.g, textColor_.b, textColor_.a);
+            Color color = applyOpacity(textColor_);
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
 
             float charWidth = fontSize_ * 0.6f;
             float textWidth = title_.length() * charWidth;
@@ -525,7 +715,8 @@ namespace TG5040
             if (imagePath_ != path)
             {
                 imagePath_ = path;
-                texture_ = nullptr; // Will be reloaded on next render
+                texture_.reset(); // Will be reloaded on next render
+                loadAttempted_ = false;
                 setNeedsLayout();
             }
         }
@@ -537,15 +728,17 @@ namespace TG5040
                 return;
             }
 
-            if (!texture_)
+            if (!loadAttempted_)
             {
-                loadTexture(renderer);
+                texture_ = ResourceManager::getInstance().loadTexture(imagePath_);
+                loadAttempted_ = true;
             }
 
-            if (texture_)
+            if (SDL_Texture *texture = texture_.get())
             {
                 SDL_Rect destRect = frame.toSDL();
-                SDL_RenderCopy(renderer, texture_, nullptr, &destRect);
+                SDL_SetTextureAlphaMod(texture, static_cast<Uint8>(std::min(std::max(effectiveOpacity(), 0.0f), 1.0f) * 255.0f));
+                SDL_RenderCopy(renderer, texture, nullptr, &destRect);
             }
             else
             {
@@ -556,23 +749,5 @@ namespace TG5040
             }
         }
 
-        void Image::loadTexture(SDL_Renderer *renderer)
-        {
-            // This would load the actual image using SDL_image
-            // For now, just create a simple colored texture as placeholder
-            texture_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
-                                         SDL_TEXTUREACCESS_TARGET,
-                                         static_cast<int>(frame.width),
-                                         static_cast<int>(frame.height));
-
-            if (texture_)
-            {
-                SDL_SetRenderTarget(renderer, texture_);
-                SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
-                SDL_RenderClear(renderer);
-                SDL_SetRenderTarget(renderer, nullptr);
-            }
-        }
-
     } // namespace UI
 } // namespace TG5040
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "ResourceManager.hpp"
+#include "SDLManager.hpp"
+#include "TextLayout.hpp"
 #include <SDL2/SDL.h>
 #include <memory>
 #include <vector>
@@ -15,6 +18,8 @@ namespace TG5040
         // Forward declarations
         class Element;
         class Container;
+        class StyleSheet;
+        struct ComputedStyle;
         using ElementPtr = std::shared_ptr<Element>;
 
         // Color structure
@@ -78,6 +83,24 @@ namespace TG5040
             GreaterThanOrEqual
         };
 
+        // Directions for D-pad focus navigation
+        enum class FocusDirection
+        {
+            Up = 0,
+            Down,
+            Left,
+            Right
+        };
+
+        // Interaction states matched by :pressed / :focused / :disabled selectors
+        enum class ElementState : uint32_t
+        {
+            None = 0,
+            Pressed = 1 << 0,
+            Focused = 1 << 1,
+            Disabled = 1 << 2
+        };
+
         // Layout priority (higher = more important)
         enum class LayoutPriority
         {
@@ -125,7 +148,7 @@ namespace TG5040
         {
         public:
             Element(const std::string &tag = "div");
-            virtual ~Element() = default;
+            virtual ~Element();
 
             // Layout properties
             Rect frame; // Final computed frame
@@ -136,6 +159,15 @@ namespace TG5040
             float cornerRadius = 0.0f;
             float borderWidth = 0.0f;
             Color borderColor = Color::black();
+            float opacity = 1.0f; // Multiplied with the parent's opacity when rendering
+
+            // Pointer events are only routed to elements (and subtrees) with interaction enabled
+            bool userInteractionEnabled = true;
+
+            // Focus navigation - focusable elements take part in the D-pad focus graph,
+            // a focus scope keeps navigation among its own descendants
+            bool focusable = false;
+            bool focusScope = false;
 
             // Hierarchy
             void addChild(ElementPtr child);
@@ -145,6 +177,9 @@ namespace TG5040
             Element *parent() const { return parent_; }
             Container *superview() const;
 
+            // Bumped whenever any element is added or removed
+            static uint32_t hierarchyGeneration() { return hierarchyGeneration_; }
+
             // Constraints - iOS-style API
             ConstraintPtr leftAnchor();
             ConstraintPtr rightAnchor();
@@ -163,24 +198,59 @@ namespace TG5040
             void removeConstraint(ConstraintPtr constraint);
             void removeAllConstraints();
 
+            // Move the element and its subtree without going through the constraint solver
+            void translate(float dx, float dy);
+
+            // Opacity including all ancestors
+            float effectiveOpacity() const;
+
             // Layout
             virtual void layoutSubviews();
             void setNeedsLayout() { needsLayout_ = true; }
             bool needsLayout() const { return needsLayout_; }
 
-            // Events
-            virtual bool handleEvent(const SDL_Event &event) { return false; }
+            // Events - pointer events bubble from the hit element up through its ancestors
+            virtual bool handleEvent(const SDL_Event &/*event*/) { return false; }
+
+            // Called on ancestors (root first) before the hit element sees a pointer event
+            virtual bool handleCaptureEvent(const SDL_Event &/*event*/) { return false; }
+
+            // Focus
+            bool isFocused() const { return focused_; }
+            void setFocused(bool focused);
+            virtual void onFocusChanged(bool /*focused*/) {}
+
+            // Explicit D-pad neighbor, overrides the computed nearest element
+            void setNextFocus(FocusDirection direction, ElementPtr element) { nextFocus_[static_cast<int>(direction)] = element; }
+            ElementPtr nextFocus(FocusDirection direction) const { return nextFocus_[static_cast<int>(direction)].lock(); }
+
+            // Called when the focused element is selected (A button / Return)
+            virtual bool activate() { return false; }
 
             // Rendering
             virtual void render(SDL_Renderer *renderer);
 
             // Identification
-            void setTag(const std::string &tag) { tag_ = tag; }
+            void setTag(const std::string &tag);
             const std::string &tag() const { return tag_; }
+            void setId(const std::string &id);
+            const std::string &id() const { return id_; }
+
+            // Style classes and interaction state - changing either re-matches the element
+            void addClass(const std::string &name);
+            void removeClass(const std::string &name);
+            bool hasClass(const std::string &name) const;
+            void setState(ElementState state, bool enabled);
+            bool hasState(ElementState state) const { return (state_ & static_cast<uint32_t>(state)) != 0; }
+
+            // Style resolved by the active StyleSheet (shared between identically matched elements)
+            const std::shared_ptr<const ComputedStyle> &computedStyle() const { return computedStyle_; }
+            void setNeedsStyle();
 
             // Allow Container to access constraint internals
             friend class Container;
             friend class Constraint;
+            friend class StyleSheet;
 
         public: // Make these public for constraint system
             float getConstraintValue(ConstraintAttribute attribute) const;
@@ -188,17 +258,42 @@ namespace TG5040
 
         protected:
             std::string tag_;
+            std::string id_;
             std::vector<ElementPtr> children_;
             Element *parent_ = nullptr;
             bool needsLayout_ = true;
 
+            static uint32_t hierarchyGeneration_;
+
+            bool focused_ = false;
+            std::weak_ptr<Element> nextFocus_[4];
+
+            // Styling - names are interned so selector matching compares integers
+            uint32_t tagId_ = 0;
+            uint32_t idId_ = 0;
+            std::vector<uint32_t> classIds_;
+            uint32_t state_ = 0;
+            bool styleDirty_ = true;
+            bool childNeedsStyle_ = true;
+            std::shared_ptr<const ComputedStyle> computedStyle_;
+            // The element's own values of the properties in its mask, saved when each was first
+            // styled and put back once no matching rule sets them
+            std::unique_ptr<ComputedStyle> unstyled_;
+
         public: // Make constraints public for constraint system
             std::vector<ConstraintPtr> constraints_;
 
         protected:
             virtual void renderBackground(SDL_Renderer *renderer);
-            virtual void renderContent(SDL_Renderer *renderer) {}
+            virtual void renderContent(SDL_Renderer *) {}
             virtual void renderBorder(SDL_Renderer *renderer);
+
+            // Copy the properties set in a computed style onto this element and restore the
+            // previously styled ones it no longer sets
+            virtual void applyStyle(const ComputedStyle &style);
+
+            // Apply effectiveOpacity() to a color's alpha
+            Color applyOpacity(const Color &color) const;
         };
 
         // Container element
@@ -233,14 +328,40 @@ namespace TG5040
             void setFontPath(const std::string &fontPath);
             const std::string &getFontPath() const { return fontPath_; }
 
+            // Handle registered with SDLManager for the current path and size
+            FontId getFontId() const { return fontId_; }
+
+            // Multi-line layout. 1 line (the default) never wraps, 0 means unlimited.
+            // Wrapping happens at the frame width; preferredMaxWidth is the width used for
+            // the intrinsic size, set it when the text is meant to wrap.
+            void setNumberOfLines(int lines);
+            int getNumberOfLines() const { return numberOfLines_; }
+            void setPreferredMaxWidth(float width);
+            float getPreferredMaxWidth() const { return preferredMaxWidth_; }
+            void setAlignment(TextAlignment alignment) { alignment_ = alignment; }
+            TextAlignment getAlignment() const { return alignment_; }
+            void setLineSpacing(float spacing);
+            float getLineSpacing() const { return lineSpacing_; }
+            void setTruncatesWithEllipsis(bool ellipsis);
+            bool getTruncatesWithEllipsis() const { return ellipsis_; }
+
         protected:
             void renderContent(SDL_Renderer *renderer) override;
+            void applyStyle(const ComputedStyle &style) override;
 
         private:
             std::string text_;
             int fontSize_ = 16;
             Color textColor_ = Color::black();
             std::string fontPath_; // Empty means use default font
+            FontId fontId_ = INVALID_FONT;
+
+            TextLayout layout_;
+            int numberOfLines_ = 1;
+            float preferredMaxWidth_ = 0.0f;
+            TextAlignment alignment_ = TextAlignment::Center;
+            float lineSpacing_ = 1.0f;
+            bool ellipsis_ = true;
 
             void calculateTextSize();
         };
@@ -257,9 +378,11 @@ namespace TG5040
             void setOnClick(std::function<void()> callback) { onClickCallback_ = callback; }
 
             bool handleEvent(const SDL_Event &event) override;
+            bool activate() override;
 
         protected:
             void renderContent(SDL_Renderer *renderer) override;
+            void applyStyle(const ComputedStyle &style) override;
 
         private:
             std::string title_;
@@ -285,9 +408,8 @@ namespace TG5040
 
         private:
             std::string imagePath_;
-            SDL_Texture *texture_ = nullptr;
-
-            void loadTexture(SDL_Renderer *renderer);
+            TextureHandle texture_; // Shared with other images of the same file
+            bool loadAttempted_ = false;
         };
 
     } // namespace UI
@@ -1,6 +1,9 @@
+#define TG5040_LOG_CATEGORY Input
 #include "ControllerManager.hpp"
 #include "Logger.hpp"
 #include <algorithm>
+#include <cmath>
+#include <iterator>
 
 namespace TG5040
 {
@@ -11,7 +14,7 @@ namespace TG5040
         return instance;
     }
 
-    bool ControllerManager::initialize()
+    bool ControllerManager::initialize(bool openDevices)
     {
         if (initialized_)
         {
@@ -23,7 +26,7 @@ namespace TG5040
 
         // SDL should already be initialized by SDLManager
         // Just scan for existing controllers
-        int numJoysticks = SDL_NumJoysticks();
+        int numJoysticks = openDevices ? SDL_NumJoysticks() : 0;
         LOG_INFO("Found %d joystick(s)", numJoysticks);
 
         for (int i = 0; i < numJoysticks; ++i)
@@ -70,10 +73,19 @@ namespace TG5040
         }
 
         controllers_.clear();
-        buttonStates_.clear();
-        axisValues_.clear();
-        buttonPressedCallbacks_.clear();
-        buttonReleasedCallbacks_.clear();
+        for (auto &state : back_)
+        {
+            state = ControllerState();
+        }
+        for (auto &state : front_)
+        {
+            state = ControllerState();
+        }
+        for (int i = 0; i < BUTTON_COUNT; ++i)
+        {
+            buttonPressedCallbacks_[i].clear();
+            buttonReleasedCallbacks_[i].clear();
+        }
         buttonEventCallbacks_.clear();
         axisEventCallbacks_.clear();
 
@@ -117,164 +129,147 @@ namespace TG5040
             return true;
 
         case SDL_CONTROLLERBUTTONDOWN:
-        {
-            LOG_DEBUG("Controller button pressed: %d", event.cbutton.button);
-            GamepadButton button = static_cast<GamepadButton>(event.cbutton.button);
-            updateButtonState(button, ButtonState::Pressed);
-
-            // Call specific button callbacks
-            int buttonInt = static_cast<int>(button);
-            if (buttonPressedCallbacks_.count(buttonInt))
-            {
-                for (auto &callback : buttonPressedCallbacks_[buttonInt])
-                {
-                    callback();
-                }
-            }
-
-            // Call general button event callbacks
-            for (auto &callback : buttonEventCallbacks_)
-            {
-                callback(button, ButtonState::Pressed);
-            }
-
-            return true;
-        }
-
         case SDL_CONTROLLERBUTTONUP:
-        {
-            LOG_DEBUG("Controller button released: %d", event.cbutton.button);
-            GamepadButton button = static_cast<GamepadButton>(event.cbutton.button);
-            updateButtonState(button, ButtonState::Released);
-
-            // Call specific button callbacks
-            int buttonInt = static_cast<int>(button);
-            if (buttonReleasedCallbacks_.count(buttonInt))
-            {
-                for (auto &callback : buttonReleasedCallbacks_[buttonInt])
-                {
-                    callback();
-                }
-            }
+            dispatchButton(event.cbutton.which, event.cbutton.button,
+                           event.type == SDL_CONTROLLERBUTTONDOWN ? ButtonState::Pressed : ButtonState::Released, event.cbutton.timestamp);
+            return true;
 
-            // Call general button event callbacks
-            for (auto &callback : buttonEventCallbacks_)
+        // Fallback: devices not recognized as game controllers report raw joystick buttons,
+        // the common ones line up with GamepadButton. Mapped ones already sent the controller button.
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYBUTTONUP:
+            if (event.jbutton.button < 16 && !isGameController(event.jbutton.which)) // Limit to reasonable button count
             {
-                callback(button, ButtonState::Released);
+                dispatchButton(event.jbutton.which, event.jbutton.button,
+                               event.type == SDL_JOYBUTTONDOWN ? ButtonState::Pressed : ButtonState::Released, event.jbutton.timestamp);
             }
-
             return true;
-        }
 
         case SDL_CONTROLLERAXISMOTION:
         {
             GamepadAxis axis = static_cast<GamepadAxis>(event.caxis.axis);
             float value = event.caxis.value / 32768.0f; // Normalize to -1.0 to 1.0
-            updateAxisValue(axis, value);
+            updateAxisValue(event.caxis.which, axis, value, event.caxis.timestamp);
 
             // Call axis event callbacks
-            for (auto &callback : axisEventCallbacks_)
-            {
-                callback(axis, value);
-            }
-
+            axisEventCallbacks_(axis, value);
             return true;
         }
 
-        // Fallback: Handle joystick events if device isn't recognized as game controller
-        case SDL_JOYBUTTONDOWN:
-        {
-            LOG_DEBUG("Joystick button pressed: %d", event.jbutton.button);
-            // Map common joystick buttons to GamepadButton enum
-            if (event.jbutton.button < 16) // Limit to reasonable button count
-            {
-                GamepadButton button = static_cast<GamepadButton>(event.jbutton.button);
-                updateButtonState(button, ButtonState::Pressed);
-
-                // Call callbacks
-                int buttonInt = static_cast<int>(button);
-                if (buttonPressedCallbacks_.count(buttonInt))
-                {
-                    for (auto &callback : buttonPressedCallbacks_[buttonInt])
-                    {
-                        callback();
-                    }
-                }
-
-                for (auto &callback : buttonEventCallbacks_)
-                {
-                    callback(button, ButtonState::Pressed);
-                }
-            }
-            return true;
+        default:
+            return false;
         }
+    }
 
-        case SDL_JOYBUTTONUP:
+    CallbackId ControllerManager::onButtonPressed(GamepadButton button, ButtonHandler callback)
+    {
+        int index = static_cast<int>(button);
+        if (index < 0 || index >= BUTTON_COUNT)
         {
-            LOG_DEBUG("Joystick button released: %d", event.jbutton.button);
-            // Map common joystick buttons to GamepadButton enum
-            if (event.jbutton.button < 16) // Limit to reasonable button count
-            {
-                GamepadButton button = static_cast<GamepadButton>(event.jbutton.button);
-                updateButtonState(button, ButtonState::Released);
-
-                // Call callbacks
-                int buttonInt = static_cast<int>(button);
-                if (buttonReleasedCallbacks_.count(buttonInt))
-                {
-                    for (auto &callback : buttonReleasedCallbacks_[buttonInt])
-                    {
-                        callback();
-                    }
-                }
-
-                for (auto &callback : buttonEventCallbacks_)
-                {
-                    callback(button, ButtonState::Released);
-                }
-            }
-            return true;
+            return 0;
         }
+        CallbackId id = nextCallbackId();
+        buttonPressedCallbacks_[index].add(id, std::move(callback));
+        return id;
+    }
 
-        default:
-            return false;
+    CallbackId ControllerManager::onButtonReleased(GamepadButton button, ButtonHandler callback)
+    {
+        int index = static_cast<int>(button);
+        if (index < 0 || index >= BUTTON_COUNT)
+        {
+            return 0;
         }
+        CallbackId id = nextCallbackId();
+        buttonReleasedCallbacks_[index].add(id, std::move(callback));
+        return id;
     }
 
-    void ControllerManager::onButtonPressed(GamepadButton button, std::function<void()> callback)
+    CallbackId ControllerManager::onButtonEvent(ButtonCallback callback)
     {
-        int buttonInt = static_cast<int>(button);
-        buttonPressedCallbacks_[buttonInt].push_back(callback);
+        CallbackId id = nextCallbackId();
+        buttonEventCallbacks_.add(id, std::move(callback));
+        return id;
     }
 
-    void ControllerManager::onButtonReleased(GamepadButton button, std::function<void()> callback)
+    CallbackId ControllerManager::onAxisEvent(AxisCallback callback)
     {
-        int buttonInt = static_cast<int>(button);
-        buttonReleasedCallbacks_[buttonInt].push_back(callback);
+        CallbackId id = nextCallbackId();
+        axisEventCallbacks_.add(id, std::move(callback));
+        return id;
     }
 
-    void ControllerManager::onButtonEvent(ButtonCallback callback)
+    void ControllerManager::removeCallback(CallbackId id)
     {
-        buttonEventCallbacks_.push_back(callback);
+        for (int i = 0; i < BUTTON_COUNT; ++i)
+        {
+            if (buttonPressedCallbacks_[i].remove(id) || buttonReleasedCallbacks_[i].remove(id))
+            {
+                return;
+            }
+        }
+        if (!buttonEventCallbacks_.remove(id))
+        {
+            axisEventCallbacks_.remove(id);
+        }
     }
 
-    void ControllerManager::onAxisEvent(AxisCallback callback)
+    CallbackId ControllerManager::nextCallbackId()
     {
-        axisEventCallbacks_.push_back(callback);
+        if (++nextCallback_ == 0)
+        {
+            ++nextCallback_; // 0 means no callback
+        }
+        return nextCallback_;
     }
 
-    bool ControllerManager::isButtonPressed(GamepadButton button) const
+    void ControllerManager::dispatchButton(SDL_JoystickID instanceId, int button, ButtonState state, Uint32 timestamp)
     {
-        int buttonInt = static_cast<int>(button);
-        auto it = buttonStates_.find(buttonInt);
-        return it != buttonStates_.end() && it->second;
+        LOG_DEBUG("Controller button %s: %d", state == ButtonState::Pressed ? "pressed" : "released", button);
+        if (button < 0 || button >= BUTTON_COUNT)
+        {
+            return;
+        }
+
+        GamepadButton gamepadButton = static_cast<GamepadButton>(button);
+        updateButtonState(instanceId, gamepadButton, state, timestamp);
+
+        // Specific button callbacks, then general ones
+        if (state == ButtonState::Pressed)
+        {
+            buttonPressedCallbacks_[button]();
+        }
+        else
+        {
+            buttonReleasedCallbacks_[button]();
+        }
+        buttonEventCallbacks_(gamepadButton, state);
     }
 
-    float ControllerManager::getAxisValue(GamepadAxis axis) const
+    void ControllerManager::snapshot()
     {
-        int axisInt = static_cast<int>(axis);
-        auto it = axisValues_.find(axisInt);
-        return it != axisValues_.end() ? it->second : 0.0f;
+        ControllerState &merged = front_[MAX_CONTROLLERS];
+        merged = ControllerState();
+
+        for (int i = 0; i < MAX_CONTROLLERS; ++i)
+        {
+            front_[i] = back_[i];
+            back_[i].pressed = 0;
+            back_[i].released = 0;
+
+            merged.buttons |= front_[i].buttons;
+            merged.pressed |= front_[i].pressed;
+            merged.released |= front_[i].released;
+            merged.timestamp = std::max(merged.timestamp, front_[i].timestamp);
+            for (int axis = 0; axis < ControllerState::AXIS_COUNT; ++axis)
+            {
+                // The stick pushed furthest wins
+                if (std::abs(front_[i].axes[axis]) > std::abs(merged.axes[axis]))
+                {
+                    merged.axes[axis] = front_[i].axes[axis];
+                }
+            }
+        }
     }
 
     void ControllerManager::addController(int deviceIndex)
@@ -296,6 +291,7 @@ namespace TG5040
         controllerInfo->name = name ? name : "Unknown Controller";
         controllerInfo->connected = true;
         controllerInfo->isGameController = true;
+        controllerInfo->slot = freeSlot();
 
         controllers_.push_back(std::move(controllerInfo));
 
@@ -321,12 +317,28 @@ namespace TG5040
         controllerInfo->name = name ? name : "Unknown Joystick";
         controllerInfo->connected = true;
         controllerInfo->isGameController = false;
+        controllerInfo->slot = freeSlot();
 
         controllers_.push_back(std::move(controllerInfo));
 
         LOG_INFO("Joystick connected: %s (ID: %d)", name ? name : "Unknown", instanceId);
     }
 
+    SDL_JoystickID ControllerManager::addVirtualController(const std::string &name)
+    {
+        auto controllerInfo = std::make_unique<ControllerInfo>();
+        controllerInfo->instanceId = nextVirtualId_++;
+        controllerInfo->name = name;
+        controllerInfo->connected = true;
+        controllerInfo->isGameController = true;
+        controllerInfo->slot = freeSlot();
+
+        SDL_JoystickID instanceId = controllerInfo->instanceId;
+        controllers_.push_back(std::move(controllerInfo));
+        LOG_INFO("Controller connected: %s (ID: %d)", name.c_str(), instanceId);
+        return instanceId;
+    }
+
     void ControllerManager::removeController(SDL_JoystickID instanceId)
     {
         auto it = std::find_if(controllers_.begin(), controllers_.end(), [instanceId](const std::unique_ptr<ControllerInfo> &info)
@@ -345,10 +357,31 @@ namespace TG5040
                 SDL_JoystickClose((*it)->joystick);
             }
 
+            // Whatever was held is released with the device
+            if ((*it)->slot >= 0)
+            {
+                ControllerState &state = back_[(*it)->slot];
+                state.released |= state.buttons;
+                state.buttons = 0;
+                std::fill(std::begin(state.axes), std::end(state.axes), 0.0f);
+            }
+
             controllers_.erase(it);
         }
     }
 
+    bool ControllerManager::isGameController(SDL_JoystickID instanceId) const
+    {
+        for (const auto &info : controllers_)
+        {
+            if (info->instanceId == instanceId)
+            {
+                return info->isGameController;
+            }
+        }
+        return false;
+    }
+
     ControllerManager::ControllerInfo *ControllerManager::findController(SDL_JoystickID instanceId)
     {
         auto it = std::find_if(controllers_.begin(), controllers_.end(), [instanceId](const std::unique_ptr<ControllerInfo> &info)
@@ -357,16 +390,51 @@ namespace TG5040
         return it != controllers_.end() ? it->get() : nullptr;
     }
 
-    void ControllerManager::updateButtonState(GamepadButton button, ButtonState state)
+    int ControllerManager::freeSlot() const
+    {
+        for (int slot = 0; slot < MAX_CONTROLLERS; ++slot)
+        {
+            bool used = std::any_of(controllers_.begin(), controllers_.end(), [slot](const std::unique_ptr<ControllerInfo> &info)
+                                    { return info->slot == slot; });
+            if (!used)
+            {
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    void ControllerManager::updateButtonState(SDL_JoystickID instanceId, GamepadButton button, ButtonState state, Uint32 timestamp)
     {
-        int buttonInt = static_cast<int>(button);
-        buttonStates_[buttonInt] = (state == ButtonState::Pressed);
+        ControllerInfo *info = findController(instanceId);
+        if (!info || info->slot < 0)
+        {
+            return;
+        }
+
+        uint32_t bit = 1u << static_cast<int>(button);
+        ControllerState &target = back_[info->slot];
+        target.timestamp = timestamp;
+        if (state == ButtonState::Pressed)
+        {
+            target.buttons |= bit;
+            target.pressed |= bit;
+        }
+        else
+        {
+            target.buttons &= ~bit;
+            target.released |= bit;
+        }
     }
 
-    void ControllerManager::updateAxisValue(GamepadAxis axis, float value)
+    void ControllerManager::updateAxisValue(SDL_JoystickID instanceId, GamepadAxis axis, float value, Uint32 timestamp)
     {
-        int axisInt = static_cast<int>(axis);
-        axisValues_[axisInt] = value;
+        ControllerInfo *info = findController(instanceId);
+        if (info && info->slot >= 0)
+        {
+            back_[info->slot].axes[static_cast<int>(axis)] = value;
+            back_[info->slot].timestamp = timestamp;
+        }
     }
 
 } // namespace TG5040
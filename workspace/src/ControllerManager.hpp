@@ -1,10 +1,11 @@
 #pragma once
 
+#include "InlineFunction.hpp"
 #include <SDL2/SDL.h>
-#include <functional>
-#include <unordered_map>
-#include <vector>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace TG5040
 {
@@ -47,21 +48,44 @@ namespace TG5040
         Released
     };
 
-    // Event callbacks
-    using ButtonCallback = std::function<void(GamepadButton button, ButtonState state)>;
-    using AxisCallback = std::function<void(GamepadAxis axis, float value)>;
+    // Input state of one controller as of the last snapshot
+    struct ControllerState
+    {
+        static constexpr int AXIS_COUNT = SDL_CONTROLLER_AXIS_MAX;
+
+        uint32_t buttons = 0;  // Bit per GamepadButton, held down
+        uint32_t pressed = 0;  // Went down since the previous snapshot
+        uint32_t released = 0; // Went up since the previous snapshot
+        Uint32 timestamp = 0;  // SDL time (ms) of the latest button or axis event
+        float axes[AXIS_COUNT] = {};
+    };
+
+    static_assert(SDL_CONTROLLER_BUTTON_MAX <= 32, "Button state is a 32-bit mask");
 
+    // Event callbacks, stored inline (see InlineFunction)
+    using ButtonHandler = InlineFunction<void()>;
+    using ButtonCallback = InlineFunction<void(GamepadButton button, ButtonState state)>;
+    using AxisCallback = InlineFunction<void(GamepadAxis axis, float value)>;
+
+    // Tracks connected controllers and their buttons and axes.
+    //
+    // Events update a back buffer of per-controller state; snapshot() (called by Application
+    // once per frame after the events) copies it to the front buffer all queries read, so game
+    // logic sees one consistent state for the whole frame. Presses and releases are latched
+    // until the next snapshot, so a tap that starts and ends within one frame is not lost.
     class ControllerManager
     {
     public:
+        static constexpr int MAX_CONTROLLERS = 4;
+        static constexpr int ANY_CONTROLLER = -1; // All controllers merged
         // Singleton pattern
         static ControllerManager &getInstance();
 
         ControllerManager(const ControllerManager &) = delete;
         ControllerManager &operator=(const ControllerManager &) = delete;
 
-        // Initialize controller system
-        bool initialize();
+        // Initialize controller system; openDevices = false leaves SDL's devices to another backend
+        bool initialize(bool openDevices = true);
 
         // Shutdown controller system
         void shutdown();
@@ -69,19 +93,52 @@ namespace TG5040
         // Process SDL events (call from main event loop)
         bool handleEvent(const SDL_Event &event);
 
-        // Register callbacks for button events
-        void onButtonPressed(GamepadButton button, std::function<void()> callback);
-        void onButtonReleased(GamepadButton button, std::function<void()> callback);
-        void onButtonEvent(ButtonCallback callback);
+        // Register callbacks for button events; the returned id unregisters them
+        CallbackId onButtonPressed(GamepadButton button, ButtonHandler callback);
+        CallbackId onButtonReleased(GamepadButton button, ButtonHandler callback);
+        CallbackId onButtonEvent(ButtonCallback callback);
 
         // Register callbacks for axis events
-        void onAxisEvent(AxisCallback callback);
+        CallbackId onAxisEvent(AxisCallback callback);
+
+        void removeCallback(CallbackId id);
+
+        // Register a device read by another backend (see EvdevInput); its events use the returned id
+        SDL_JoystickID addVirtualController(const std::string &name);
 
-        // Check current button state
-        bool isButtonPressed(GamepadButton button) const;
+        // For game logic that maps inputs to named actions, see InputActions
+
+        // Publish the state built from this frame's events (once per frame)
+        void snapshot();
+
+        // Polling queries on the last snapshot; controller is a player slot (0-3) or ANY_CONTROLLER
+        bool isButtonPressed(GamepadButton button, int controller = ANY_CONTROLLER) const
+        {
+            return (getState(controller).buttons >> static_cast<int>(button)) & 1u;
+        }
+
+        // Went down / up during the last frame
+        bool wasPressed(GamepadButton button, int controller = ANY_CONTROLLER) const
+        {
+            return (getState(controller).pressed >> static_cast<int>(button)) & 1u;
+        }
+
+        bool wasReleased(GamepadButton button, int controller = ANY_CONTROLLER) const
+        {
+            return (getState(controller).released >> static_cast<int>(button)) & 1u;
+        }
 
         // Get current axis value (-1.0 to 1.0)
-        float getAxisValue(GamepadAxis axis) const;
+        float getAxisValue(GamepadAxis axis, int controller = ANY_CONTROLLER) const
+        {
+            return getState(controller).axes[static_cast<int>(axis)];
+        }
+
+        // Out of range slots read the merged state
+        const ControllerState &getState(int controller = ANY_CONTROLLER) const
+        {
+            return front_[static_cast<unsigned>(controller) < MAX_CONTROLLERS ? controller : MAX_CONTROLLERS];
+        }
 
         // Get number of connected controllers
         int getControllerCount() const { return static_cast<int>(controllers_.size()); }
@@ -89,6 +146,10 @@ namespace TG5040
         // Check if any controller is connected
         bool hasController() const { return !controllers_.empty(); }
 
+        // Opened with a game controller mapping; such a device reports each button twice, as a
+        // controller button and as a raw joystick button whose index need not match
+        bool isGameController(SDL_JoystickID instanceId) const;
+
     private:
         ControllerManager() = default;
         ~ControllerManager() = default;
@@ -98,30 +159,38 @@ namespace TG5040
             SDL_GameController *controller = nullptr;
             SDL_Joystick *joystick = nullptr; // Fallback for non-gamecontroller devices
             SDL_JoystickID instanceId = -1;
+            int slot = -1; // Index into the state buffers, -1 if all slots are taken
             std::string name;
             bool connected = false;
             bool isGameController = false; // Track whether this is a proper game controller
         };
 
         std::vector<std::unique_ptr<ControllerInfo>> controllers_;
-        std::unordered_map<int, bool> buttonStates_; // button -> pressed state
-        std::unordered_map<int, float> axisValues_;  // axis -> value
-
-        // Event callbacks
-        std::unordered_map<int, std::vector<std::function<void()>>> buttonPressedCallbacks_;
-        std::unordered_map<int, std::vector<std::function<void()>>> buttonReleasedCallbacks_;
-        std::vector<ButtonCallback> buttonEventCallbacks_;
-        std::vector<AxisCallback> axisEventCallbacks_;
+        // Written by events / read by queries; the last entry is all controllers merged
+        ControllerState back_[MAX_CONTROLLERS];
+        ControllerState front_[MAX_CONTROLLERS + 1];
+
+        // Event callbacks, indexed by button
+        static constexpr int BUTTON_COUNT = 32;
+        CallbackList<void()> buttonPressedCallbacks_[BUTTON_COUNT];
+        CallbackList<void()> buttonReleasedCallbacks_[BUTTON_COUNT];
+        CallbackList<void(GamepadButton, ButtonState)> buttonEventCallbacks_;
+        CallbackList<void(GamepadAxis, float)> axisEventCallbacks_;
+        CallbackId nextCallback_ = 0;
 
         bool initialized_ = false;
+        SDL_JoystickID nextVirtualId_ = 0x40000000; // Far above SDL's instance ids
 
         // Helper methods
         void addController(int deviceIndex);
         void addJoystick(int deviceIndex); // Fallback for non-gamecontroller devices
         void removeController(SDL_JoystickID instanceId);
         ControllerInfo *findController(SDL_JoystickID instanceId);
-        void updateButtonState(GamepadButton button, ButtonState state);
-        void updateAxisValue(GamepadAxis axis, float value);
+        int freeSlot() const;
+        CallbackId nextCallbackId();
+        void dispatchButton(SDL_JoystickID instanceId, int button, ButtonState state, Uint32 timestamp);
+        void updateButtonState(SDL_JoystickID instanceId, GamepadButton button, ButtonState state, Uint32 timestamp);
+        void updateAxisValue(SDL_JoystickID instanceId, GamepadAxis axis, float value, Uint32 timestamp);
     };
 
 } // namespace TG5040
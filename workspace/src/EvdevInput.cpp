@@ -0,0 +1,483 @@
+#define TG5040_LOG_CATEGORY Input
+#include "EvdevInput.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+// Older kernel headers only have the timeval member
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+#endif
+
+namespace TG5040
+{
+#ifdef __linux__
+    namespace
+    {
+        constexpr int NO_MAPPING = -1;
+        constexpr int HAT_X = -2;
+        constexpr int HAT_Y = -3;
+
+        // Linux key codes -> GamepadButton, flat table over the gamepad code range
+        constexpr int BUTTON_CODE_FIRST = BTN_SOUTH;
+        constexpr int BUTTON_CODE_LAST = BTN_DPAD_RIGHT;
+
+        struct ButtonTable
+        {
+            int8_t buttons[BUTTON_CODE_LAST - BUTTON_CODE_FIRST + 1];
+
+            ButtonTable()
+            {
+                std::fill(std::begin(buttons), std::end(buttons), static_cast<int8_t>(NO_MAPPING));
+                set(BTN_SOUTH, GamepadButton::A);
+                set(BTN_EAST, GamepadButton::B);
+                set(BTN_NORTH, GamepadButton::X);
+                set(BTN_WEST, GamepadButton::Y);
+                set(BTN_TL, GamepadButton::LEFT_SHOULDER);
+                set(BTN_TR, GamepadButton::RIGHT_SHOULDER);
+                set(BTN_SELECT, GamepadButton::BACK);
+                set(BTN_START, GamepadButton::START);
+                set(BTN_MODE, GamepadButton::GUIDE);
+                set(BTN_THUMBL, GamepadButton::LEFT_STICK);
+                set(BTN_THUMBR, GamepadButton::RIGHT_STICK);
+                set(BTN_DPAD_UP, GamepadButton::DPAD_UP);
+                set(BTN_DPAD_DOWN, GamepadButton::DPAD_DOWN);
+                set(BTN_DPAD_LEFT, GamepadButton::DPAD_LEFT);
+                set(BTN_DPAD_RIGHT, GamepadButton::DPAD_RIGHT);
+            }
+
+            void set(int code, GamepadButton button) { buttons[code - BUTTON_CODE_FIRST] = static_cast<int8_t>(button); }
+
+            int lookup(int code) const
+            {
+                return code >= BUTTON_CODE_FIRST && code <= BUTTON_CODE_LAST ? buttons[code - BUTTON_CODE_FIRST] : NO_MAPPING;
+            }
+        };
+
+        const ButtonTable BUTTONS;
+
+        // Absolute axis codes -> GamepadAxis, or the hat the D-pad is reported on
+        int axisFor(int code)
+        {
+            switch (code)
+            {
+            case ABS_X:
+                return static_cast<int>(GamepadAxis::LEFT_X);
+            case ABS_Y:
+                return static_cast<int>(GamepadAxis::LEFT_Y);
+            case ABS_RX:
+                return static_cast<int>(GamepadAxis::RIGHT_X);
+            case ABS_RY:
+                return static_cast<int>(GamepadAxis::RIGHT_Y);
+            case ABS_Z:
+                return static_cast<int>(GamepadAxis::LEFT_TRIGGER);
+            case ABS_RZ:
+                return static_cast<int>(GamepadAxis::RIGHT_TRIGGER);
+            case ABS_HAT0X:
+                return HAT_X;
+            case ABS_HAT0Y:
+                return HAT_Y;
+            default:
+                return NO_MAPPING;
+            }
+        }
+
+        const int AXIS_CODES[ControllerState::AXIS_COUNT] = {ABS_X, ABS_Y, ABS_RX, ABS_RY, ABS_Z, ABS_RZ};
+
+        uint64_t monotonicNs()
+        {
+            timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+        }
+
+        bool testBit(const unsigned long *bits, int bit)
+        {
+            constexpr int BITS = sizeof(unsigned long) * 8;
+            return (bits[bit / BITS] >> (bit % BITS)) & 1ul;
+        }
+    } // namespace
+#endif
+
+    EvdevInput &EvdevInput::getInstance()
+    {
+        static EvdevInput instance;
+        return instance;
+    }
+
+#ifdef __linux__
+    std::vector<std::string> EvdevInput::findGamepads()
+    {
+        std::vector<std::string> gamepads;
+        DIR *dir = opendir("/dev/input");
+        if (!dir)
+        {
+            return gamepads;
+        }
+
+        while (dirent *entry = readdir(dir))
+        {
+            if (std::strncmp(entry->d_name, "event", 5) != 0)
+            {
+                continue;
+            }
+
+            std::string path = std::string("/dev/input/") + entry->d_name;
+            int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0)
+            {
+                continue;
+            }
+            unsigned long keys[KEY_MAX / (sizeof(unsigned long) * 8) + 1] = {};
+            if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) >= 0 && testBit(keys, BTN_SOUTH))
+            {
+                gamepads.push_back(path);
+            }
+            close(fd);
+        }
+        closedir(dir);
+
+        std::sort(gamepads.begin(), gamepads.end());
+        return gamepads;
+    }
+
+    bool EvdevInput::start(const std::vector<std::string> &devices)
+    {
+        if (isRunning())
+        {
+            LOG_WARN("Evdev input already running");
+            return true;
+        }
+
+        std::vector<std::string> paths = devices.empty() ? findGamepads() : devices;
+        for (const auto &path : paths)
+        {
+            if (deviceCount_ == MAX_DEVICES)
+            {
+                LOG_WARN("Ignoring %s, at most %d evdev devices are read", path.c_str(), MAX_DEVICES);
+                break;
+            }
+            openDevice(path);
+        }
+        if (deviceCount_ == 0)
+        {
+            LOG_ERROR("No evdev input device could be opened");
+            return false;
+        }
+
+        if (pipe2(wakeFds_, O_CLOEXEC | O_NONBLOCK) != 0)
+        {
+            LOG_ERROR("Failed to create evdev wake pipe: %s", std::strerror(errno));
+            stop();
+            return false;
+        }
+
+        thread_ = std::thread(&EvdevInput::readerThread, this);
+        LOG_INFO("Evdev input thread reading %d device(s)", deviceCount_);
+        return true;
+    }
+
+    bool EvdevInput::openDevice(const std::string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            LOG_ERROR("Failed to open input device %s: %s", path.c_str(), std::strerror(errno));
+            return false;
+        }
+
+        Device &device = devices_[deviceCount_];
+        device = Device();
+        device.fd = fd;
+
+        // Real devices: kernel timestamps on the monotonic clock and the actual axis ranges.
+        // Both fail harmlessly on a pipe or file standing in for a device.
+        int clock = CLOCK_MONOTONIC;
+        device.kernelClock = ioctl(fd, EVIOCSCLOCKID, &clock) == 0;
+        char name[128] = {};
+        if (ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name) < 0)
+        {
+            std::strncpy(name, path.c_str(), sizeof(name) - 1);
+        }
+        for (int axis = 0; axis < ControllerState::AXIS_COUNT; ++axis)
+        {
+            input_absinfo info = {};
+            if (ioctl(fd, EVIOCGABS(AXIS_CODES[axis]), &info) == 0 && info.maximum > info.minimum)
+            {
+                device.ranges[axis].minimum = info.minimum;
+                device.ranges[axis].maximum = info.maximum;
+            }
+        }
+
+        device.instanceId = ControllerManager::getInstance().addVirtualController(name);
+        ++deviceCount_;
+        LOG_INFO("Reading input device %s (%s)", path.c_str(), name);
+        return true;
+    }
+
+    void EvdevInput::stop()
+    {
+        if (thread_.joinable())
+        {
+            char wake = 1;
+            if (write(wakeFds_[1], &wake, 1) < 0)
+            {
+                LOG_WARN("Failed to wake evdev input thread: %s", std::strerror(errno));
+            }
+            thread_.join();
+        }
+
+        for (int i = 0; i < deviceCount_; ++i)
+        {
+            if (devices_[i].fd >= 0)
+            {
+                close(devices_[i].fd);
+            }
+            devices_[i] = Device();
+        }
+        deviceCount_ = 0;
+        for (int &fd : wakeFds_)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+
+        Event event;
+        while (queue_.pop(event))
+        {
+        }
+    }
+
+    void EvdevInput::readerThread()
+    {
+        pollfd fds[MAX_DEVICES + 1];
+        for (;;)
+        {
+            int count = 0;
+            fds[count++] = {wakeFds_[0], POLLIN, 0};
+            int map[MAX_DEVICES];
+            for (int i = 0; i < deviceCount_; ++i)
+            {
+                if (devices_[i].fd >= 0)
+                {
+                    map[count - 1] = i;
+                    fds[count++] = {devices_[i].fd, POLLIN, 0};
+                }
+            }
+
+            if (poll(fds, count, -1) < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            if (fds[0].revents)
+            {
+                break; // stop()
+            }
+
+            uint64_t now = monotonicNs();
+            for (int i = 1; i < count; ++i)
+            {
+                if (fds[i].revents && !readDevice(map[i - 1], now))
+                {
+                    // Unplugged, or the end of a stand-in file
+                    Device &device = devices_[map[i - 1]];
+                    close(device.fd);
+                    device.fd = -1;
+                    Event removed;
+                    removed.kind = Kind::Removed;
+                    removed.device = static_cast<uint8_t>(map[i - 1]);
+                    removed.timeNs = now;
+                    push(removed);
+                }
+            }
+        }
+    }
+
+    bool EvdevInput::readDevice(int index, uint64_t now)
+    {
+        static_assert(sizeof(input_event) <= sizeof(Device::partial), "partial must hold a record");
+        Device &device = devices_[index];
+        input_event records[64];
+
+        // Pipes and files may return part of a record; it is completed by the next read
+        unsigned char *buffer = reinterpret_cast<unsigned char *>(records);
+        std::memcpy(buffer, device.partial, device.partialBytes);
+        ssize_t bytes = read(device.fd, buffer + device.partialBytes, sizeof(records) - device.partialBytes);
+        if (bytes <= 0)
+        {
+            return bytes < 0 && (errno == EAGAIN || errno == EINTR);
+        }
+
+        size_t total = device.partialBytes + static_cast<size_t>(bytes);
+        size_t count = total / sizeof(input_event);
+        device.partialBytes = total % sizeof(input_event);
+        std::memcpy(device.partial, buffer + count * sizeof(input_event), device.partialBytes);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const input_event &record = records[i];
+            if (device.kernelClock)
+            {
+                now = static_cast<uint64_t>(record.input_event_sec) * 1000000000ull + static_cast<uint64_t>(record.input_event_usec) * 1000ull;
+            }
+            if (record.type == EV_KEY)
+            {
+                int button = BUTTONS.lookup(record.code);
+                if (button != NO_MAPPING && record.value != 2) // 2 = autorepeat
+                {
+                    Event event;
+                    event.kind = Kind::Button;
+                    event.device = static_cast<uint8_t>(index);
+                    event.index = static_cast<uint8_t>(button);
+                    event.value = record.value ? 1 : 0;
+                    event.timeNs = now;
+                    push(event);
+                }
+            }
+            else if (record.type == EV_ABS)
+            {
+                int axis = axisFor(record.code);
+                if (axis == HAT_X)
+                {
+                    pushHat(index, device.hatX, record.value, GamepadButton::DPAD_LEFT, GamepadButton::DPAD_RIGHT, now);
+                }
+                else if (axis == HAT_Y)
+                {
+                    pushHat(index, device.hatY, record.value, GamepadButton::DPAD_UP, GamepadButton::DPAD_DOWN, now);
+                }
+                else if (axis != NO_MAPPING)
+                {
+                    // Sticks span the full SDL range, triggers 0..32767 like SDL's
+                    const AxisRange &range = device.ranges[axis];
+                    int64_t span = static_cast<int64_t>(range.maximum) - range.minimum;
+                    int64_t offset = std::min<int64_t>(std::max<int64_t>(record.value - static_cast<int64_t>(range.minimum), 0), span);
+                    bool trigger = axis == static_cast<int>(GamepadAxis::LEFT_TRIGGER) || axis == static_cast<int>(GamepadAxis::RIGHT_TRIGGER);
+                    int64_t value = trigger ? offset * 32767 / span : offset * 65535 / span - 32768;
+
+                    Event event;
+                    event.kind = Kind::Axis;
+                    event.device = static_cast<uint8_t>(index);
+                    event.index = static_cast<uint8_t>(axis);
+                    event.value = static_cast<int16_t>(value);
+                    event.timeNs = now;
+                    push(event);
+                }
+            }
+        }
+        return true;
+    }
+
+    void EvdevInput::pushHat(int index, int &previous, int value, GamepadButton negative, GamepadButton positive, uint64_t now)
+    {
+        value = value < 0 ? -1 : (value > 0 ? 1 : 0);
+        if (value == previous)
+        {
+            return;
+        }
+
+        Event event;
+        event.kind = Kind::Button;
+        event.device = static_cast<uint8_t>(index);
+        event.timeNs = now;
+        if (previous != 0)
+        {
+            event.index = static_cast<uint8_t>(previous < 0 ? negative : positive);
+            event.value = 0;
+            push(event);
+        }
+        if (value != 0)
+        {
+            event.index = static_cast<uint8_t>(value < 0 ? negative : positive);
+            event.value = 1;
+            push(event);
+        }
+        previous = value;
+    }
+
+    void EvdevInput::push(const Event &event)
+    {
+        if (!queue_.push(event))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool EvdevInput::pollEvent(SDL_Event &event)
+    {
+        Event input;
+        if (!queue_.pop(input))
+        {
+            return false;
+        }
+
+        // Express the read time on SDL's millisecond clock, so latency includes the time queued here
+        uint64_t ageMs = (monotonicNs() - input.timeNs) / 1000000;
+        Uint32 timestamp = SDL_GetTicks() - static_cast<Uint32>(ageMs);
+        SDL_JoystickID which = devices_[input.device].instanceId;
+
+        std::memset(&event, 0, sizeof(event));
+        switch (input.kind)
+        {
+        case Kind::Button:
+            event.type = input.value ? SDL_CONTROLLERBUTTONDOWN : SDL_CONTROLLERBUTTONUP;
+            event.cbutton.timestamp = timestamp;
+            event.cbutton.which = which;
+            event.cbutton.button = input.index;
+            event.cbutton.state = input.value ? SDL_PRESSED : SDL_RELEASED;
+            break;
+        case Kind::Axis:
+            event.type = SDL_CONTROLLERAXISMOTION;
+            event.caxis.timestamp = timestamp;
+            event.caxis.which = which;
+            event.caxis.axis = input.index;
+            event.caxis.value = input.value;
+            break;
+        case Kind::Removed:
+            event.type = SDL_CONTROLLERDEVICEREMOVED;
+            event.cdevice.timestamp = timestamp;
+            event.cdevice.which = which;
+            break;
+        }
+        return true;
+    }
+#else
+    std::vector<std::string> EvdevInput::findGamepads()
+    {
+        return {};
+    }
+
+    bool EvdevInput::start(const std::vector<std::string> &)
+    {
+        LOG_ERROR("The evdev input backend is only available on Linux");
+        return false;
+    }
+
+    void EvdevInput::stop()
+    {
+    }
+
+    bool EvdevInput::pollEvent(SDL_Event &)
+    {
+        return false;
+    }
+#endif
+
+} // namespace TG5040
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ControllerManager.hpp"
+#include "SpscQueue.hpp"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace TG5040
+{
+
+    // Optional input backend reading Linux evdev devices (/dev/input/event*) on its own thread.
+    //
+    // The thread blocks in poll(), timestamps each event on CLOCK_MONOTONIC (the kernel's event
+    // time, or the read time for stand-ins), translates it to a gamepad button or axis and
+    // pushes it onto a lock-free queue. The main loop drains the queue with pollEvent(), which produces the same
+    // SDL controller events SDL would, so ControllerManager and InputActions consume them
+    // unchanged. Any readable file works as a device, e.g. a pipe carrying input_event records.
+    class EvdevInput
+    {
+    public:
+        static constexpr size_t QUEUE_SIZE = 256;
+        static constexpr int MAX_DEVICES = 4;
+
+        static EvdevInput &getInstance();
+
+        EvdevInput(const EvdevInput &) = delete;
+        EvdevInput &operator=(const EvdevInput &) = delete;
+
+        // Open the devices (none = every gamepad under /dev/input) and start the reader thread.
+        // Each device is registered with ControllerManager as a controller.
+        bool start(const std::vector<std::string> &devices = {});
+        void stop();
+        bool isRunning() const { return thread_.joinable(); }
+
+        // Main thread: next event as an SDL controller event, false when the queue is empty
+        bool pollEvent(SDL_Event &event);
+
+        // Events lost because the main loop did not drain the queue in time
+        uint64_t getDroppedEvents() const { return dropped_.load(std::memory_order_relaxed); }
+
+        // Event devices with gamepad buttons
+        static std::vector<std::string> findGamepads();
+
+    private:
+        EvdevInput() = default;
+        ~EvdevInput() { stop(); }
+
+        enum class Kind : uint8_t
+        {
+            Button,
+            Axis,
+            Removed
+        };
+
+        struct Event
+        {
+            Kind kind = Kind::Button;
+            uint8_t device = 0;
+            uint8_t index = 0; // GamepadButton or GamepadAxis
+            int16_t value = 0; // 1/0 for buttons, SDL axis range for axes
+            uint64_t timeNs = 0; // CLOCK_MONOTONIC when read
+        };
+
+        struct AxisRange
+        {
+            int32_t minimum = -32768;
+            int32_t maximum = 32767;
+        };
+
+        // Owned by the reader thread after start()
+        struct Device
+        {
+            int fd = -1;
+            SDL_JoystickID instanceId = -1;
+            bool kernelClock = false; // Event times are CLOCK_MONOTONIC, otherwise the read time is used
+            AxisRange ranges[ControllerState::AXIS_COUNT];
+            int hatX = 0;
+            int hatY = 0;
+            unsigned char partial[32]; // Start of a record a short read ended in
+            size_t partialBytes = 0;
+        };
+
+        Device devices_[MAX_DEVICES];
+        int deviceCount_ = 0;
+        int wakeFds_[2] = {-1, -1}; // Written by stop() to interrupt poll()
+        std::thread thread_;
+        SpscQueue<Event, QUEUE_SIZE> queue_;
+        std::atomic<uint64_t> dropped_{0};
+
+        bool openDevice(const std::string &path);
+        void readerThread();
+        bool readDevice(int index, uint64_t now);
+        void push(const Event &event);
+        void pushHat(int index, int &previous, int value, GamepadButton negative, GamepadButton positive, uint64_t now);
+    };
+
+} // namespace TG5040
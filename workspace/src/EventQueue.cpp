@@ -0,0 +1,148 @@
+#include "EventQueue.hpp"
+#include <algorithm>
+
+namespace TG5040
+{
+
+    EventQueue::EventQueue()
+    {
+        for (auto &word : subscribed_)
+        {
+            word.store(0, std::memory_order_relaxed);
+        }
+        events_.reserve(BATCH_SIZE * 2);
+        axes_.reserve(16);
+    }
+
+    EventQueue::~EventQueue()
+    {
+        removeFilter();
+    }
+
+    void EventQueue::installFilter()
+    {
+        // Also runs the filter over whatever SDL has queued already
+        SDL_SetEventFilter(&EventQueue::filter, this);
+        filterInstalled_ = true;
+    }
+
+    void EventQueue::removeFilter()
+    {
+        if (filterInstalled_)
+        {
+            SDL_SetEventFilter(nullptr, nullptr);
+            filterInstalled_ = false;
+        }
+    }
+
+    void EventQueue::subscribe(Uint32 type, bool subscribed)
+    {
+        subscribeRange(type, type, subscribed);
+    }
+
+    void EventQueue::subscribeRange(Uint32 first, Uint32 last, bool subscribed)
+    {
+        last = std::min(last, TYPE_COUNT - 1);
+        for (Uint32 type = first; type <= last; ++type)
+        {
+            uint32_t bit = 1u << (type % 32);
+            if (subscribed)
+            {
+                subscribed_[type / 32].fetch_or(bit, std::memory_order_relaxed);
+            }
+            else
+            {
+                subscribed_[type / 32].fetch_and(~bit, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool EventQueue::isSubscribed(Uint32 type) const
+    {
+        return type < TYPE_COUNT && (subscribed_[type / 32].load(std::memory_order_relaxed) >> (type % 32)) & 1u;
+    }
+
+    int SDLCALL EventQueue::filter(void *userdata, SDL_Event *event)
+    {
+        EventQueue *queue = static_cast<EventQueue *>(userdata);
+        if (queue->isSubscribed(event->type))
+        {
+            return 1;
+        }
+        queue->filtered_.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    void EventQueue::begin()
+    {
+        events_.clear();
+        axes_.clear();
+        removed_ = 0;
+        frame_ = EventCounts();
+    }
+
+    void EventQueue::push(const SDL_Event &event)
+    {
+        ++frame_.received;
+
+        Uint32 type = event.type;
+        if (type != SDL_CONTROLLERAXISMOTION && type != SDL_JOYAXISMOTION)
+        {
+            events_.push_back(event);
+            return;
+        }
+
+        // Only the newest value of an axis matters, the older event is dropped from its place
+        SDL_JoystickID which = type == SDL_CONTROLLERAXISMOTION ? event.caxis.which : event.jaxis.which;
+        Uint8 axis = type == SDL_CONTROLLERAXISMOTION ? event.caxis.axis : event.jaxis.axis;
+        for (AxisSlot &slot : axes_)
+        {
+            if (slot.type == type && slot.which == which && slot.axis == axis)
+            {
+                events_[slot.index].type = REMOVED;
+                ++removed_;
+                slot.index = events_.size();
+                events_.push_back(event);
+                return;
+            }
+        }
+        axes_.push_back({type, which, axis, events_.size()});
+        events_.push_back(event);
+    }
+
+    void EventQueue::drain()
+    {
+        SDL_PumpEvents();
+
+        SDL_Event batch[BATCH_SIZE];
+        int count;
+        while ((count = SDL_PeepEvents(batch, BATCH_SIZE, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)) > 0)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                push(batch[i]);
+            }
+            if (count < BATCH_SIZE)
+            {
+                break;
+            }
+        }
+
+        if (removed_ > 0)
+        {
+            events_.erase(std::remove_if(events_.begin(), events_.end(),
+                                         [](const SDL_Event &event)
+                                         { return event.type == REMOVED; }),
+                          events_.end());
+        }
+
+        frame_.dispatched = events_.size();
+        frame_.filtered = filtered_.exchange(0, std::memory_order_relaxed);
+        total_.received += frame_.received;
+        total_.dispatched += frame_.dispatched;
+        total_.filtered += frame_.filtered;
+        peakReceived_ = std::max(peakReceived_, frame_.received);
+        ++frames_;
+    }
+
+} // namespace TG5040
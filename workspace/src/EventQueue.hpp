@@ -0,0 +1,87 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace TG5040
+{
+
+    // Event counts for one frame, or summed over all frames
+    struct EventCounts
+    {
+        uint64_t received = 0;   // Taken off the queues
+        uint64_t dispatched = 0; // Left after axis motion was coalesced
+        uint64_t filtered = 0;   // Dropped by the event filter before SDL queued them
+    };
+
+    // Collects a frame's input in one pass.
+    //
+    // SDL's queue is drained in batches with SDL_PeepEvents instead of one SDL_PollEvent call
+    // per event, and axis motion is coalesced so each controller axis dispatches only its latest
+    // value of the frame. An SDL event filter drops types nobody subscribed to before SDL queues
+    // them; it stays out of the way until installFilter() is called.
+    class EventQueue
+    {
+    public:
+        static constexpr int BATCH_SIZE = 64;
+
+        EventQueue();
+        ~EventQueue();
+
+        EventQueue(const EventQueue &) = delete;
+        EventQueue &operator=(const EventQueue &) = delete;
+
+        void installFilter();
+        void removeFilter();
+
+        // Types the filter lets through; ranges are inclusive
+        void subscribe(Uint32 type, bool subscribed = true);
+        void subscribeRange(Uint32 first, Uint32 last, bool subscribed = true);
+        bool isSubscribed(Uint32 type) const;
+
+        // Start a frame, add events from other sources, then drain SDL
+        void begin();
+        void push(const SDL_Event &event);
+        void drain();
+
+        // The frame's events in arrival order, coalesced axis motion in the place of its last value
+        const std::vector<SDL_Event> &events() const { return events_; }
+
+        const EventCounts &getFrameCounts() const { return frame_; }
+        const EventCounts &getTotalCounts() const { return total_; }
+        uint64_t getFrameCount() const { return frames_; }
+        uint64_t getPeakReceived() const { return peakReceived_; }
+
+    private:
+        static constexpr Uint32 TYPE_COUNT = SDL_LASTEVENT + 1;
+        static constexpr Uint32 REMOVED = SDL_FIRSTEVENT; // Marks an axis event replaced by a later one
+
+        // Where the latest motion of one axis sits in events_
+        struct AxisSlot
+        {
+            Uint32 type;
+            SDL_JoystickID which;
+            Uint8 axis;
+            size_t index;
+        };
+
+        // One bit per event type, read by the filter on whichever thread pushes the event
+        std::atomic<uint32_t> subscribed_[TYPE_COUNT / 32];
+        std::atomic<uint32_t> filtered_{0};
+        bool filterInstalled_ = false;
+
+        std::vector<SDL_Event> events_;
+        std::vector<AxisSlot> axes_;
+        size_t removed_ = 0;
+
+        EventCounts frame_;
+        EventCounts total_;
+        uint64_t frames_ = 0;
+        uint64_t peakReceived_ = 0;
+
+        static int SDLCALL filter(void *userdata, SDL_Event *event);
+    };
+
+} // namespace TG5040
@@ -0,0 +1,167 @@
+#include "FlightRecorder.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace TG5040
+{
+
+    using namespace BinaryLogFormat;
+
+    FlightRecorder &FlightRecorder::getInstance()
+    {
+        static FlightRecorder instance;
+        return instance;
+    }
+
+    bool FlightRecorder::open(const std::string &path, size_t sizeBytes)
+    {
+        close();
+
+        size_t slotBytes = sizeBytes > sizeof(FlightHeader) ? sizeBytes - sizeof(FlightHeader) : 0;
+        uint32_t count = static_cast<uint32_t>(std::max<size_t>(16, slotBytes / FLIGHT_SLOT_SIZE));
+        size_t size = sizeof(FlightHeader) + static_cast<size_t>(count) * FLIGHT_SLOT_SIZE;
+
+        // The previous run's records are the ones that explain a crash, keep them
+        std::string previous = path + ".prev";
+        std::rename(path.c_str(), previous.c_str());
+
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            LOG_WARN("Cannot create flight recorder %s", path.c_str());
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+        {
+            LOG_WARN("Cannot size flight recorder %s to %zu bytes", path.c_str(), size);
+            ::close(fd);
+            return false;
+        }
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd); // The mapping keeps the file
+        if (data == MAP_FAILED)
+        {
+            LOG_WARN("Cannot map flight recorder %s", path.c_str());
+            return false;
+        }
+
+        FlightHeader header = {};
+        std::memcpy(header.magic, FLIGHT_MAGIC, sizeof(header.magic));
+        header.version = FLIGHT_VERSION;
+        header.slotSize = FLIGHT_SLOT_SIZE;
+        header.slotCount = count;
+        std::memcpy(data, &header, sizeof(header));
+
+        mapping_ = data;
+        mappingSize_ = size;
+        slotCount_ = count;
+        sequence_.store(0, std::memory_order_relaxed);
+        slots_.store(reinterpret_cast<FlightSlot *>(static_cast<char *>(data) + sizeof(FlightHeader)), std::memory_order_release);
+
+        LOG_INFO("Flight recorder: last %u records in %s", count, path.c_str());
+        return true;
+    }
+
+    void FlightRecorder::close()
+    {
+        if (!mapping_)
+        {
+            return;
+        }
+
+        // Unmapping does not lose anything, the pages are written back like any other file
+        slots_.store(nullptr, std::memory_order_release);
+        munmap(mapping_, mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+    }
+
+    FlightSlot *FlightRecorder::claim(int level, const char *file, int line, std::chrono::system_clock::time_point time,
+                                      uint64_t &sequence)
+    {
+        FlightSlot *slots = slots_.load(std::memory_order_acquire);
+        if (!slots)
+        {
+            return nullptr;
+        }
+
+        sequence = sequence_.fetch_add(1, std::memory_order_relaxed) + 1;
+        FlightSlot *slot = &slots[(sequence - 1) % slotCount_];
+
+        // Marked as unfinished first, a crash halfway through leaves a slot the decoder skips
+        __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+        slot->timeNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+        slot->line = static_cast<uint32_t>(line);
+        slot->level = static_cast<uint8_t>(level);
+        size_t fileLength = std::min(std::strlen(file), sizeof(slot->file) - 1);
+        std::memcpy(slot->file, file, fileLength);
+        slot->file[fileLength] = '\0';
+        return slot;
+    }
+
+    void FlightRecorder::publish(FlightSlot *slot, uint64_t sequence)
+    {
+        __atomic_store_n(&slot->sequence, sequence, __ATOMIC_RELEASE);
+    }
+
+    void FlightRecorder::record(int level, const char *file, int line, std::chrono::system_clock::time_point time,
+                                const char *message)
+    {
+        uint64_t sequence;
+        FlightSlot *slot = claim(level, file, line, time, sequence);
+        if (!slot)
+        {
+            return;
+        }
+
+        size_t length = strnlen(message, FLIGHT_PAYLOAD_SIZE);
+        std::memcpy(slot->payload, message, length);
+        slot->packed = 0;
+        slot->length = static_cast<uint16_t>(length);
+        publish(slot, sequence);
+    }
+
+    void FlightRecorder::record(int level, const char *file, int line, std::chrono::system_clock::time_point time,
+                                const char *format, va_list args)
+    {
+        uint64_t sequence;
+        FlightSlot *slot = claim(level, file, line, time, sequence);
+        if (!slot)
+        {
+            return;
+        }
+
+        int length = vsnprintf(slot->payload, FLIGHT_PAYLOAD_SIZE, format, args);
+        slot->packed = 0;
+        slot->length = static_cast<uint16_t>(std::min(std::max(length, 0), static_cast<int>(FLIGHT_PAYLOAD_SIZE) - 1));
+        publish(slot, sequence);
+    }
+
+    void FlightRecorder::recordPacked(int level, const char *file, int line, std::chrono::system_clock::time_point time,
+                                      const char *format, const char *arguments, size_t length)
+    {
+        uint64_t sequence;
+        FlightSlot *slot = claim(level, file, line, time, sequence);
+        if (!slot)
+        {
+            return;
+        }
+
+        // Arguments that do not fit are cut, the decoder prints them as missing
+        size_t formatLength = strnlen(format, FLIGHT_PAYLOAD_SIZE - 1);
+        std::memcpy(slot->payload, format, formatLength);
+        slot->payload[formatLength] = '\0';
+        length = std::min(length, FLIGHT_PAYLOAD_SIZE - formatLength - 1);
+        std::memcpy(slot->payload + formatLength + 1, arguments, length);
+        slot->packed = 1;
+        slot->length = static_cast<uint16_t>(formatLength + 1 + length);
+        publish(slot, sequence);
+    }
+
+} // namespace TG5040
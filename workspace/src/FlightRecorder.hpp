@@ -0,0 +1,59 @@
+#pragma once
+
+#include "BinaryLogFormat.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace TG5040
+{
+
+    // Keeps the most recent log records in a memory-mapped file, for post-mortem debugging.
+    //
+    // The file is a ring of fixed-size slots (BinaryLogFormat::FlightSlot) shared with the
+    // kernel, so a record costs a few plain stores on the logging thread and no system call.
+    // The pages belong to the kernel's page cache: whatever was stored before a SIGSEGV or
+    // abort() reaches the file even though the process never flushes anything. The file of the
+    // previous run is kept as <path>.prev. `logdecode <file>` prints the ring in order.
+    class FlightRecorder
+    {
+    public:
+        static FlightRecorder &getInstance();
+
+        FlightRecorder(const FlightRecorder &) = delete;
+        FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+        // Size is rounded down to whole slots (at least 16)
+        bool open(const std::string &path, size_t sizeBytes);
+        void close();
+        bool isOpen() const { return slots_.load(std::memory_order_acquire) != nullptr; }
+
+        // A formatted message
+        void record(int level, const char *file, int line, std::chrono::system_clock::time_point time,
+                    const char *message);
+        void record(int level, const char *file, int line, std::chrono::system_clock::time_point time,
+                    const char *format, va_list args);
+
+        // A binary log record: its format string and packed arguments
+        void recordPacked(int level, const char *file, int line, std::chrono::system_clock::time_point time,
+                          const char *format, const char *arguments, size_t length);
+
+    private:
+        FlightRecorder() = default;
+        ~FlightRecorder() { close(); }
+
+        std::atomic<BinaryLogFormat::FlightSlot *> slots_{nullptr};
+        uint32_t slotCount_ = 0;
+        std::atomic<uint64_t> sequence_{0};
+        void *mapping_ = nullptr;
+        size_t mappingSize_ = 0;
+
+        BinaryLogFormat::FlightSlot *claim(int level, const char *file, int line,
+                                           std::chrono::system_clock::time_point time, uint64_t &sequence);
+        static void publish(BinaryLogFormat::FlightSlot *slot, uint64_t sequence);
+    };
+
+} // namespace TG5040
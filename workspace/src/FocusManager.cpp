@@ -0,0 +1,318 @@
+#define TG5040_LOG_CATEGORY Input
+#include "FocusManager.hpp"
+#include "Logger.hpp"
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        void FocusManager::update(Element *root)
+        {
+            uint32_t generation = Element::hierarchyGeneration();
+            if (!dirty_ && generation == generation_)
+            {
+                return;
+            }
+
+            rebuild(root);
+            generation_ = generation;
+            dirty_ = false;
+        }
+
+        void FocusManager::collect(Element *element, Element *scope)
+        {
+            if (element->focusable)
+            {
+                Node node;
+                node.element = element;
+                node.scope = scope;
+                indices_[element] = static_cast<int>(nodes_.size());
+                nodes_.push_back(node);
+            }
+
+            Element *childScope = element->focusScope ? element : scope;
+            for (auto &child : element->children())
+            {
+                collect(child.get(), childScope);
+            }
+        }
+
+        void FocusManager::rebuild(Element *root)
+        {
+            nodes_.clear();
+            indices_.clear();
+            focusedIndex_ = -1;
+
+            if (!root)
+            {
+                return;
+            }
+
+            collect(root, nullptr);
+
+            for (auto it = scopeMemory_.begin(); it != scopeMemory_.end();)
+            {
+                it = it->second.expired() ? scopeMemory_.erase(it) : std::next(it);
+            }
+
+            // Explicit overrides win, otherwise the nearest element in the same scope
+            for (int i = 0; i < static_cast<int>(nodes_.size()); ++i)
+            {
+                for (int d = 0; d < 4; ++d)
+                {
+                    auto direction = static_cast<FocusDirection>(d);
+                    auto target = nodes_[i].element->nextFocus(direction);
+                    nodes_[i].neighbors[d] = target ? resolveTarget(target.get()) : nearest(i, direction);
+                }
+            }
+
+            // Keep the previous focus if it survived, otherwise focus the first element
+            auto focused = focused_.lock();
+            auto it = focused ? indices_.find(focused.get()) : indices_.end();
+            if (it != indices_.end())
+            {
+                focusedIndex_ = it->second;
+            }
+            else
+            {
+                focused_.reset();
+                if (focused)
+                {
+                    focused->setFocused(false);
+                }
+                if (!nodes_.empty())
+                {
+                    focusIndex(0);
+                }
+            }
+
+            LOG_DEBUG("Focus graph rebuilt with %zu node(s)", nodes_.size());
+        }
+
+        int FocusManager::nearest(int from, FocusDirection direction) const
+        {
+            const Node &origin = nodes_[from];
+            const Rect &a = origin.element->frame;
+            float ax = a.x + a.width * 0.5f;
+            float ay = a.y + a.height * 0.5f;
+
+            int best = -1;
+            float bestScore = std::numeric_limits<float>::max();
+
+            for (int i = 0; i < static_cast<int>(nodes_.size()); ++i)
+            {
+                if (i == from || nodes_[i].scope != origin.scope)
+                {
+                    continue;
+                }
+
+                const Rect &b = nodes_[i].element->frame;
+                float bx = b.x + b.width * 0.5f;
+                float by = b.y + b.height * 0.5f;
+
+                // Distance along the movement axis and offset across it
+                float major = 0.0f;
+                float minor = 0.0f;
+                switch (direction)
+                {
+                case FocusDirection::Up:
+                    if (by >= ay)
+                        continue;
+                    major = std::max(a.y - (b.y + b.height), 0.0f);
+                    minor = std::max(std::max(b.x - (a.x + a.width), a.x - (b.x + b.width)), 0.0f);
+                    break;
+                case FocusDirection::Down:
+                    if (by <= ay)
+                        continue;
+                    major = std::max(b.y - (a.y + a.height), 0.0f);
+                    minor = std::max(std::max(b.x - (a.x + a.width), a.x - (b.x + b.width)), 0.0f);
+                    break;
+                case FocusDirection::Left:
+                    if (bx >= ax)
+                        continue;
+                    major = std::max(a.x - (b.x + b.width), 0.0f);
+                    minor = std::max(std::max(b.y - (a.y + a.height), a.y - (b.y + b.height)), 0.0f);
+                    break;
+                case FocusDirection::Right:
+                    if (bx <= ax)
+                        continue;
+                    major = std::max(b.x - (a.x + a.width), 0.0f);
+                    minor = std::max(std::max(b.y - (a.y + a.height), a.y - (b.y + b.height)), 0.0f);
+                    break;
+                }
+
+                // Elements that overlap on the cross axis are strongly preferred
+                float centerOffset = (direction == FocusDirection::Up || direction == FocusDirection::Down)
+                                         ? std::fabs(bx - ax)
+                                         : std::fabs(by - ay);
+                float score = major + minor * 4.0f + centerOffset * 0.1f;
+                if (score < bestScore)
+                {
+                    bestScore = score;
+                    best = i;
+                }
+            }
+
+            return best;
+        }
+
+        int FocusManager::resolveTarget(Element *element) const
+        {
+            auto it = indices_.find(element);
+            if (it != indices_.end())
+            {
+                return it->second;
+            }
+
+            // Overrides may point at a scope: enter it at its last focused element
+            if (element->focusScope)
+            {
+                auto memory = scopeMemory_.find(element);
+                if (memory != scopeMemory_.end())
+                {
+                    auto remembered = memory->second.lock();
+                    auto found = remembered ? indices_.find(remembered.get()) : indices_.end();
+                    if (found != indices_.end())
+                    {
+                        return found->second;
+                    }
+                }
+                for (int i = 0; i < static_cast<int>(nodes_.size()); ++i)
+                {
+                    if (nodes_[i].scope == element)
+                    {
+                        return i;
+                    }
+                }
+            }
+
+            return -1;
+        }
+
+        bool FocusManager::move(FocusDirection direction)
+        {
+            // Nodes may point at removed elements until the next update()
+            if (!isCurrent())
+            {
+                return false;
+            }
+
+            if (focusedIndex_ < 0)
+            {
+                if (nodes_.empty())
+                {
+                    return false;
+                }
+                focusIndex(0);
+                return true;
+            }
+
+            int next = nodes_[focusedIndex_].neighbors[static_cast<int>(direction)];
+            if (next < 0)
+            {
+                return false;
+            }
+
+            focusIndex(next);
+            return true;
+        }
+
+        bool FocusManager::activate()
+        {
+            Element *element = focusedElement();
+            return element ? element->activate() : false;
+        }
+
+        void FocusManager::setFocus(Element *element)
+        {
+            if (!element)
+            {
+                clearFocus();
+                return;
+            }
+
+            int index = resolveTarget(element);
+            if (index >= 0)
+            {
+                focusIndex(index);
+            }
+        }
+
+        Element *FocusManager::focusedElement() const
+        {
+            // Null once the element is gone, whether or not the graph was rebuilt since
+            return focused_.lock().get();
+        }
+
+        void FocusManager::clearFocus()
+        {
+            if (auto focused = focused_.lock())
+            {
+                focused->setFocused(false);
+            }
+            focusedIndex_ = -1;
+            focused_.reset();
+        }
+
+        void FocusManager::reset()
+        {
+            clearFocus();
+            nodes_.clear();
+            indices_.clear();
+            dirty_ = true;
+        }
+
+        void FocusManager::focusIndex(int index)
+        {
+            if (index == focusedIndex_)
+            {
+                return;
+            }
+
+            if (auto focused = focused_.lock())
+            {
+                focused->setFocused(false);
+            }
+
+            focusedIndex_ = index;
+            Node &node = nodes_[index];
+            focused_ = node.element->shared_from_this();
+            if (node.scope)
+            {
+                scopeMemory_[node.scope] = focused_;
+            }
+            node.element->setFocused(true);
+        }
+
+        void FocusManager::render(SDL_Renderer *renderer) const
+        {
+            Element *element = focusedElement();
+            if (!element || highlightWidth <= 0.0f)
+            {
+                return;
+            }
+
+            SDL_SetRenderDrawColor(renderer, highlightColor.r, highlightColor.g, highlightColor.b, highlightColor.a);
+            SDL_Rect rect = element->frame.toSDL();
+            int inset = static_cast<int>(highlightInset);
+            rect.x += inset;
+            rect.y += inset;
+            rect.w -= inset * 2;
+            rect.h -= inset * 2;
+
+            for (int i = 0; i < static_cast<int>(highlightWidth); ++i)
+            {
+                SDL_RenderDrawRect(renderer, &rect);
+                rect.x += 1;
+                rect.y += 1;
+                rect.w -= 2;
+                rect.h -= 2;
+            }
+        }
+
+    } // namespace UI
+} // namespace TG5040
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "ConstraintLayout.hpp"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        // D-pad focus navigation. After layout a directional nearest-neighbor graph is
+        // computed over focusable elements so that each move is a single table lookup.
+        class FocusManager
+        {
+        public:
+            FocusManager() = default;
+
+            // Request a graph rebuild (after layout)
+            void setNeedsRebuild() { dirty_ = true; }
+
+            // Rebuild the graph if needed
+            void update(Element *root);
+
+            // Move focus in a direction, returns false if there is no neighbor
+            bool move(FocusDirection direction);
+
+            // Activate the focused element (e.g. click a button)
+            bool activate();
+
+            void setFocus(Element *element);
+            Element *focusedElement() const;
+            void clearFocus();
+
+            // Clear focus and drop the graph, before the tree it was built from is replaced
+            void reset();
+
+            // Draw the focus highlight around the focused element
+            void render(SDL_Renderer *renderer) const;
+
+            Color highlightColor = Color(255, 200, 0);
+            float highlightWidth = 3.0f;
+            float highlightInset = -4.0f; // Negative grows the highlight outside the frame
+
+            size_t nodeCount() const { return nodes_.size(); }
+
+        private:
+            // Elements are only borrowed from the tree, the graph is stale after hierarchy changes
+            struct Node
+            {
+                Element *element = nullptr;
+                Element *scope = nullptr;
+                int neighbors[4] = {-1, -1, -1, -1};
+            };
+
+            std::vector<Node> nodes_;
+            std::unordered_map<const Element *, int> indices_;
+            std::unordered_map<const Element *, std::weak_ptr<Element>> scopeMemory_;
+            std::weak_ptr<Element> focused_;
+            int focusedIndex_ = -1;
+            bool dirty_ = true;
+            uint32_t generation_ = 0;
+
+            void collect(Element *element, Element *scope);
+            void rebuild(Element *root);
+            int nearest(int from, FocusDirection direction) const;
+            int resolveTarget(Element *element) const;
+            bool isCurrent() const { return !dirty_ && generation_ == Element::hierarchyGeneration(); }
+            void focusIndex(int index);
+        };
+
+    } // namespace UI
+} // namespace TG5040
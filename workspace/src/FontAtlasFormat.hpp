@@ -0,0 +1,65 @@
+#pragma once
+
+// Binary layout of baked font atlas files (.atlas).
+// Shared by the runtime FontCache and the host-side baker (tools/fontbake.cpp),
+// so this header must not depend on SDL.
+
+#include <cstdint>
+
+namespace TG5040
+{
+    namespace FontAtlasFormat
+    {
+
+        constexpr char MAGIC[4] = {'T', 'G', 'F', 'A'};
+        constexpr uint16_t VERSION = 1;
+        constexpr uint32_t PAGE_SHIFT = 7; // 128 codepoints per page, same as FontCache
+        constexpr uint32_t GLYPHS_PER_PAGE = 1u << PAGE_SHIFT;
+        constexpr uint32_t PIXEL_ALIGNMENT = 16;
+
+        struct Header
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t fontCount;
+            uint32_t pageCount;
+            uint32_t stringTableSize;
+        };
+
+        struct FontRecord
+        {
+            uint32_t path; // String table offset, path as used at runtime (e.g. res/aller.ttf)
+            uint16_t size;
+            int16_t height;
+            int16_t ascent;
+            uint16_t reserved;
+        };
+
+        // Pages of one font are stored consecutively
+        struct PageRecord
+        {
+            uint16_t font;
+            uint16_t page; // codepoint >> PAGE_SHIFT
+            uint16_t width;
+            uint16_t height;
+            uint32_t pixelOffset; // From the start of the file, ARGB8888 rows of width * 4 bytes
+        };
+
+        // Zero width glyphs are either missing or only advance the pen
+        struct GlyphRecord
+        {
+            uint16_t x, y, w, h;
+            int16_t offsetX;
+            int16_t advance;
+        };
+
+        static_assert(sizeof(Header) == 16, "Atlas header layout changed");
+        static_assert(sizeof(FontRecord) == 12, "Atlas font record layout changed");
+        static_assert(sizeof(PageRecord) == 12, "Atlas page record layout changed");
+        static_assert(sizeof(GlyphRecord) == 12, "Atlas glyph record layout changed");
+
+        // File layout: Header, FontRecord[fontCount], PageRecord[pageCount],
+        // GlyphRecord[pageCount * GLYPHS_PER_PAGE], string table, then page pixels aligned to PIXEL_ALIGNMENT
+
+    } // namespace FontAtlasFormat
+} // namespace TG5040
@@ -0,0 +1,773 @@
+#define TG5040_LOG_CATEGORY Render
+#include "FontCache.hpp"
+#include "Logger.hpp"
+#include "ResourceManager.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TG5040
+{
+
+    namespace
+    {
+        // FreeType does not report its memory use. Charge the face plus a half-filled
+        // SDL_ttf glyph cache (bitmap + pixmap per glyph) as a rough estimate.
+        size_t estimateFontBytes(int size)
+        {
+            return 64 * 1024 + static_cast<size_t>(128) * size * size;
+        }
+
+        int encodeUtf8(uint32_t cp, char *out)
+        {
+            if (cp < 0x80)
+            {
+                out[0] = static_cast<char>(cp);
+                out[1] = '\0';
+                return 1;
+            }
+            if (cp < 0x800)
+            {
+                out[0] = static_cast<char>(0xC0 | (cp >> 6));
+                out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+                out[2] = '\0';
+                return 2;
+            }
+            out[0] = static_cast<char>(0xE0 | (cp >> 12));
+            out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+            out[3] = '\0';
+            return 3;
+        }
+    } // namespace
+
+    uint32_t FontCache::decodeUtf8(const char *text, size_t length, size_t &i)
+    {
+        unsigned char c = static_cast<unsigned char>(text[i++]);
+        if (c < 0x80)
+        {
+            return c;
+        }
+
+        int extra = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : -1;
+        if (extra < 0)
+        {
+            return 0xFFFD; // Stray continuation byte
+        }
+
+        uint32_t cp = c & (0x3F >> extra);
+        for (int n = 0; n < extra; ++n)
+        {
+            if (i >= length || (static_cast<unsigned char>(text[i]) & 0xC0) != 0x80)
+            {
+                return 0xFFFD;
+            }
+            cp = (cp << 6) | (static_cast<unsigned char>(text[i++]) & 0x3F);
+        }
+        return cp;
+    }
+
+    FontCache::~FontCache()
+    {
+        clear();
+        unloadAtlas();
+    }
+
+    FontId FontCache::registerFont(const std::string &fontPath, int fontSize)
+    {
+        std::string key = fontPath + ":" + std::to_string(fontSize);
+
+        auto it = fontIds_.find(key);
+        if (it != fontIds_.end())
+        {
+            return it->second;
+        }
+
+        if (fonts_.size() >= INVALID_FONT)
+        {
+            LOG_ERROR("Too many fonts registered, ignoring %s at size %d", fontPath.c_str(), fontSize);
+            return INVALID_FONT;
+        }
+
+        FontId id = static_cast<FontId>(fonts_.size());
+        FontEntry entry;
+        entry.path = fontPath;
+        entry.size = fontSize;
+        resolveBaked(entry);
+        fonts_.push_back(entry);
+        fontIds_[key] = id;
+        return id;
+    }
+
+    const std::string &FontCache::getFontPath(FontId id) const
+    {
+        static const std::string empty;
+        if (id >= fonts_.size())
+        {
+            return empty;
+        }
+        return fonts_[id].path.empty() ? defaultFontPath_ : fonts_[id].path;
+    }
+
+    int FontCache::getFontSize(FontId id) const
+    {
+        return id < fonts_.size() ? fonts_[id].size : 0;
+    }
+
+    void FontCache::setDefaultFontPath(const std::string &fontPath)
+    {
+        if (fontPath == defaultFontPath_)
+        {
+            return;
+        }
+
+        // Fonts and pages registered against the default path are rebuilt from the new file
+        defaultFontPath_ = fontPath;
+        for (size_t id = 0; id < fonts_.size(); ++id)
+        {
+            FontEntry &entry = fonts_[id];
+            if (!entry.path.empty())
+            {
+                continue;
+            }
+            closeFont(entry);
+            entry.failed = false;
+            entry.height = 0;
+            resolveBaked(entry);
+
+            for (auto it = pages_.begin(); it != pages_.end();)
+            {
+                if ((it->first >> 16) == id)
+                {
+                    releasePage(it->second);
+                    it = pages_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    TTF_Font *FontCache::getFont(FontId id)
+    {
+        if (id >= fonts_.size())
+        {
+            return nullptr;
+        }
+
+        FontEntry &entry = fonts_[id];
+        entry.lastUse = ++useCounter_;
+        if (entry.font || entry.failed)
+        {
+            ++hits_;
+            return entry.font;
+        }
+
+        ++misses_;
+        if (!openFont(entry))
+        {
+            return nullptr;
+        }
+        enforceBudget(&entry);
+        return entry.font;
+    }
+
+    void FontCache::preloadRegisteredFonts()
+    {
+        for (size_t id = 0; id < fonts_.size(); ++id)
+        {
+            // Baked fonts only need their first page uploaded, the TTF file stays closed
+            if (fonts_[id].baked >= 0)
+            {
+                getPage(static_cast<FontId>(id), 0);
+            }
+            else
+            {
+                getFont(static_cast<FontId>(id));
+            }
+        }
+    }
+
+    bool FontCache::openFont(FontEntry &entry)
+    {
+        // TTF is not available until the renderer is attached, try again later without marking a failure
+        if (!renderer_)
+        {
+            return false;
+        }
+
+        const std::string &path = entry.path.empty() ? defaultFontPath_ : entry.path;
+        SDL_RWops *rw = ResourceManager::getInstance().openFile(path);
+        entry.font = rw ? TTF_OpenFontRW(rw, 1, entry.size) : nullptr;
+        if (!entry.font)
+        {
+            LOG_ERROR("Failed to load font %s at size %d: %s", path.c_str(), entry.size, TTF_GetError());
+            entry.failed = true;
+            return false;
+        }
+
+        entry.height = TTF_FontHeight(entry.font);
+        entry.ascent = TTF_FontAscent(entry.font);
+        entry.bytes = estimateFontBytes(entry.size);
+        fontBytes_ += entry.bytes;
+
+        LOG_INFO("Loaded font: %s at size %d", path.c_str(), entry.size);
+        return true;
+    }
+
+    void FontCache::closeFont(FontEntry &entry)
+    {
+        if (entry.font)
+        {
+            TTF_CloseFont(entry.font);
+            entry.font = nullptr;
+            fontBytes_ -= entry.bytes;
+            entry.bytes = 0;
+        }
+    }
+
+    int FontCache::getLineHeight(FontId id)
+    {
+        if (id >= fonts_.size())
+        {
+            return 0;
+        }
+        if (fonts_[id].height == 0)
+        {
+            getFont(id);
+        }
+        return fonts_[id].height;
+    }
+
+    FontCache::GlyphPage *FontCache::getPage(FontId id, uint32_t page)
+    {
+        uint32_t key = (static_cast<uint32_t>(id) << 16) | (page & 0xFFFF);
+
+        // Consecutive glyphs almost always share a page
+        if (lastPage_ && key == lastPageKey_)
+        {
+            ++hits_;
+            lastPage_->lastUse = ++useCounter_;
+            return lastPage_;
+        }
+
+        auto it = pages_.find(key);
+        if (it != pages_.end())
+        {
+            ++hits_;
+            it->second.lastUse = ++useCounter_;
+            lastPageKey_ = key;
+            lastPage_ = &it->second;
+            return &it->second;
+        }
+
+        ++misses_;
+        GlyphPage built;
+        int baked = id < fonts_.size() ? fonts_[id].baked : -1;
+        auto bakedPage = baked >= 0 ? bakedPages_.find((static_cast<uint32_t>(baked) << 16) | (page & 0xFFFF)) : bakedPages_.end();
+        bool ok = bakedPage != bakedPages_.end() ? uploadBakedPage(bakedPage->second, built) : buildPage(id, page, built);
+        if (!ok)
+        {
+            return nullptr;
+        }
+
+        GlyphPage &stored = pages_.emplace(key, built).first->second;
+        stored.lastUse = ++useCounter_;
+        glyphBytes_ += stored.bytes;
+        enforceBudget(&stored);
+        lastPageKey_ = key;
+        lastPage_ = &stored;
+        return &stored;
+    }
+
+    bool FontCache::buildPage(FontId id, uint32_t page, GlyphPage &result)
+    {
+        TTF_Font *font = getFont(id);
+        if (!font)
+        {
+            return false;
+        }
+
+        constexpr uint32_t count = 1u << PAGE_SHIFT;
+        const SDL_Color white = {255, 255, 255, 255};
+        SDL_Surface *surfaces[count] = {};
+
+        result.height = fonts_[id].height;
+
+        // Render each provided glyph and lay them out in rows
+        int penX = 0, penY = 0, rowHeight = 0, atlasWidth = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t cp = (page << PAGE_SHIFT) | i;
+            if (cp < 32 || cp > 0xFFFF || (cp >= 0xD800 && cp <= 0xDFFF) || !TTF_GlyphIsProvided(font, static_cast<Uint16>(cp)))
+            {
+                continue;
+            }
+
+            int minx, maxx, miny, maxy, advance;
+            if (TTF_GlyphMetrics(font, static_cast<Uint16>(cp), &minx, &maxx, &miny, &maxy, &advance) != 0)
+            {
+                continue;
+            }
+
+            Glyph &glyph = result.glyphs[i];
+            glyph.advance = static_cast<int16_t>(advance);
+            glyph.offsetX = static_cast<int16_t>(std::min(minx, 0));
+
+            char utf8[4];
+            encodeUtf8(cp, utf8);
+            SDL_Surface *surface = TTF_RenderUTF8_Blended(font, utf8, white);
+            if (!surface)
+            {
+                continue; // Zero width glyphs (spaces) only advance
+            }
+
+            if (penX > 0 && penX + surface->w > PAGE_WIDTH)
+            {
+                penX = 0;
+                penY += rowHeight + 1;
+                rowHeight = 0;
+            }
+
+            glyph.x = static_cast<uint16_t>(penX);
+            glyph.y = static_cast<uint16_t>(penY);
+            glyph.w = static_cast<uint16_t>(surface->w);
+            glyph.h = static_cast<uint16_t>(surface->h);
+
+            penX += surface->w + 1;
+            rowHeight = std::max(rowHeight, surface->h);
+            atlasWidth = std::max(atlasWidth, penX);
+            surfaces[i] = surface;
+        }
+
+        int atlasHeight = penY + rowHeight;
+        if (atlasWidth == 0 || atlasHeight == 0)
+        {
+            return true; // Nothing visible in this page, keep metrics only
+        }
+
+        SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (atlas)
+        {
+            SDL_FillRect(atlas, nullptr, 0);
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if (!surfaces[i])
+            {
+                continue;
+            }
+            if (atlas)
+            {
+                SDL_Rect dst = {result.glyphs[i].x, result.glyphs[i].y, surfaces[i]->w, surfaces[i]->h};
+                SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+                SDL_BlitSurface(surfaces[i], nullptr, atlas, &dst);
+            }
+            SDL_FreeSurface(surfaces[i]);
+        }
+
+        if (!atlas)
+        {
+            LOG_ERROR("Failed to create glyph atlas: %s", SDL_GetError());
+            return false;
+        }
+
+        result.texture = SDL_CreateTextureFromSurface(renderer_, atlas);
+        SDL_FreeSurface(atlas);
+        if (!result.texture)
+        {
+            LOG_ERROR("Failed to create glyph texture: %s", SDL_GetError());
+            return false;
+        }
+
+        SDL_SetTextureBlendMode(result.texture, SDL_BLENDMODE_BLEND);
+        result.bytes = static_cast<size_t>(atlasWidth) * atlasHeight * 4;
+        return true;
+    }
+
+    bool FontCache::uploadBakedPage(uint32_t index, GlyphPage &result)
+    {
+        using namespace FontAtlasFormat;
+
+        if (!renderer_)
+        {
+            return false;
+        }
+
+        const PageRecord &record = atlasPages_[index];
+        const GlyphRecord *glyphs = atlasGlyphs_ + static_cast<size_t>(index) * GLYPHS_PER_PAGE;
+        for (uint32_t i = 0; i < GLYPHS_PER_PAGE; ++i)
+        {
+            Glyph &glyph = result.glyphs[i];
+            glyph.x = glyphs[i].x;
+            glyph.y = glyphs[i].y;
+            glyph.w = glyphs[i].w;
+            glyph.h = glyphs[i].h;
+            glyph.offsetX = glyphs[i].offsetX;
+            glyph.advance = glyphs[i].advance;
+        }
+        result.height = atlasFonts_[record.font].height;
+        result.baked = true;
+
+        result.texture = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, record.width, record.height);
+        if (!result.texture || SDL_UpdateTexture(result.texture, nullptr, atlasData_ + record.pixelOffset, record.width * 4) != 0)
+        {
+            LOG_ERROR("Failed to upload baked glyph page: %s", SDL_GetError());
+            if (result.texture)
+            {
+                SDL_DestroyTexture(result.texture);
+                result.texture = nullptr;
+            }
+            return false;
+        }
+
+        SDL_SetTextureBlendMode(result.texture, SDL_BLENDMODE_BLEND);
+        result.bytes = static_cast<size_t>(record.width) * record.height * 4;
+        return true;
+    }
+
+    bool FontCache::loadAtlas(const std::string &path)
+    {
+        using namespace FontAtlasFormat;
+
+        unloadAtlas();
+
+        // Inside the asset archive the atlas is already mapped
+        const uint8_t *packed = nullptr;
+        size_t packedSize = 0;
+        if (ResourceManager::getInstance().findData(path, packed, packedSize))
+        {
+            if (packedSize < sizeof(Header))
+            {
+                LOG_ERROR("Invalid font atlas %s", path.c_str());
+                return false;
+            }
+            atlasData_ = packed;
+            atlasSize_ = packedSize;
+            atlasMapped_ = false;
+        }
+        else
+        {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                LOG_INFO("No baked font atlas at %s, rendering glyphs live", path.c_str());
+                return false;
+            }
+
+            struct stat st;
+            void *data = MAP_FAILED;
+            if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(Header)))
+            {
+                data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            close(fd);
+
+            if (data == MAP_FAILED)
+            {
+                LOG_ERROR("Failed to map font atlas %s", path.c_str());
+                return false;
+            }
+
+            atlasData_ = static_cast<const uint8_t *>(data);
+            atlasSize_ = static_cast<size_t>(st.st_size);
+            atlasMapped_ = true;
+        }
+
+        // Validate everything up front so lookups can trust the tables
+        Header header;
+        std::memcpy(&header, atlasData_, sizeof(header));
+        size_t fontsOffset = sizeof(Header);
+        size_t pagesOffset = fontsOffset + header.fontCount * sizeof(FontRecord);
+        size_t glyphsOffset = pagesOffset + static_cast<size_t>(header.pageCount) * sizeof(PageRecord);
+        size_t stringsOffset = glyphsOffset + static_cast<size_t>(header.pageCount) * GLYPHS_PER_PAGE * sizeof(GlyphRecord);
+
+        bool valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+                     stringsOffset + header.stringTableSize <= atlasSize_;
+        if (valid)
+        {
+            atlasFonts_ = reinterpret_cast<const FontRecord *>(atlasData_ + fontsOffset);
+            atlasPages_ = reinterpret_cast<const PageRecord *>(atlasData_ + pagesOffset);
+            atlasGlyphs_ = reinterpret_cast<const GlyphRecord *>(atlasData_ + glyphsOffset);
+            const char *strings = reinterpret_cast<const char *>(atlasData_ + stringsOffset);
+
+            for (uint16_t i = 0; i < header.fontCount && valid; ++i)
+            {
+                const FontRecord &font = atlasFonts_[i];
+                valid = font.path < header.stringTableSize &&
+                        std::memchr(strings + font.path, '\0', header.stringTableSize - font.path) != nullptr;
+                if (valid)
+                {
+                    bakedFonts_[std::string(strings + font.path) + ":" + std::to_string(font.size)] = i;
+                }
+            }
+
+            for (uint32_t i = 0; i < header.pageCount && valid; ++i)
+            {
+                const PageRecord &page = atlasPages_[i];
+                valid = page.font < header.fontCount && page.pixelOffset % PIXEL_ALIGNMENT == 0 &&
+                        page.pixelOffset + static_cast<size_t>(page.width) * page.height * 4 <= atlasSize_;
+                if (valid)
+                {
+                    bakedPages_[(static_cast<uint32_t>(page.font) << 16) | page.page] = i;
+                }
+            }
+        }
+
+        if (!valid)
+        {
+            LOG_ERROR("Invalid font atlas %s", path.c_str());
+            unloadAtlas();
+            return false;
+        }
+
+        for (auto &entry : fonts_)
+        {
+            resolveBaked(entry);
+        }
+
+        LOG_INFO("Mapped font atlas %s (%u fonts, %u pages, %zu KB)", path.c_str(), header.fontCount, header.pageCount, atlasSize_ / 1024);
+        return true;
+    }
+
+    void FontCache::unloadAtlas()
+    {
+        if (!atlasData_)
+        {
+            return;
+        }
+
+        // Pages uploaded from the atlas stay valid, they are textures
+        if (atlasMapped_)
+        {
+            munmap(const_cast<uint8_t *>(atlasData_), atlasSize_);
+        }
+        atlasData_ = nullptr;
+        atlasSize_ = 0;
+        atlasFonts_ = nullptr;
+        atlasPages_ = nullptr;
+        atlasGlyphs_ = nullptr;
+        bakedFonts_.clear();
+        bakedPages_.clear();
+
+        for (auto &entry : fonts_)
+        {
+            entry.baked = -1;
+        }
+    }
+
+    void FontCache::resolveBaked(FontEntry &entry)
+    {
+        const std::string &path = entry.path.empty() ? defaultFontPath_ : entry.path;
+        auto it = bakedFonts_.find(path + ":" + std::to_string(entry.size));
+        entry.baked = it != bakedFonts_.end() ? it->second : -1;
+        if (entry.baked >= 0 && entry.height == 0)
+        {
+            entry.height = atlasFonts_[entry.baked].height;
+            entry.ascent = atlasFonts_[entry.baked].ascent;
+        }
+    }
+
+    void FontCache::releasePage(GlyphPage &page)
+    {
+        if (&page == lastPage_)
+        {
+            lastPage_ = nullptr;
+        }
+        if (page.texture)
+        {
+            SDL_DestroyTexture(page.texture);
+            page.texture = nullptr;
+        }
+        glyphBytes_ -= page.bytes;
+        page.bytes = 0;
+    }
+
+    int FontCache::getAdvance(FontId id, uint32_t codepoint)
+    {
+        GlyphPage *page = getPage(id, codepoint >> PAGE_SHIFT);
+        return page ? page->glyphs[codepoint & ((1u << PAGE_SHIFT) - 1)].advance : 0;
+    }
+
+    bool FontCache::measureText(FontId id, const char *text, size_t length, int &width, int &height)
+    {
+        width = 0;
+        height = getLineHeight(id);
+        if (height == 0)
+        {
+            return false;
+        }
+
+        GlyphPage *page = nullptr;
+        uint32_t current = UINT32_MAX;
+        int penX = 0;
+
+        for (size_t i = 0; i < length;)
+        {
+            uint32_t cp = decodeUtf8(text, length, i);
+            if ((cp >> PAGE_SHIFT) != current)
+            {
+                current = cp >> PAGE_SHIFT;
+                page = getPage(id, current);
+            }
+            if (!page)
+            {
+                return false;
+            }
+
+            const Glyph &glyph = page->glyphs[cp & ((1u << PAGE_SHIFT) - 1)];
+            width = std::max(width, penX + glyph.offsetX + glyph.w);
+            penX += glyph.advance;
+        }
+
+        width = std::max(width, penX);
+        return true;
+    }
+
+    bool FontCache::drawText(FontId id, const char *text, size_t length, int x, int y, SDL_Color color)
+    {
+        if (!renderer_)
+        {
+            return false;
+        }
+
+        GlyphPage *page = nullptr;
+        uint32_t current = UINT32_MAX;
+        int penX = x;
+
+        for (size_t i = 0; i < length;)
+        {
+            uint32_t cp = decodeUtf8(text, length, i);
+            if ((cp >> PAGE_SHIFT) != current)
+            {
+                current = cp >> PAGE_SHIFT;
+                page = getPage(id, current);
+                if (page && page->texture)
+                {
+                    // Glyphs are white, tint them for this draw
+                    SDL_SetTextureColorMod(page->texture, color.r, color.g, color.b);
+                    SDL_SetTextureAlphaMod(page->texture, color.a);
+                }
+            }
+            if (!page)
+            {
+                return false;
+            }
+
+            const Glyph &glyph = page->glyphs[cp & ((1u << PAGE_SHIFT) - 1)];
+            if (glyph.w > 0 && page->texture)
+            {
+                SDL_Rect src = {glyph.x, glyph.y, glyph.w, glyph.h};
+                SDL_Rect dst = {penX + glyph.offsetX, y, glyph.w, glyph.h};
+                SDL_RenderCopy(renderer_, page->texture, &src, &dst);
+            }
+            penX += glyph.advance;
+        }
+        return true;
+    }
+
+    void FontCache::setBudget(size_t bytes)
+    {
+        budget_ = bytes;
+        enforceBudget(nullptr);
+    }
+
+    void FontCache::enforceBudget(const void *keep)
+    {
+        while (fontBytes_ + glyphBytes_ > budget_)
+        {
+            // Find the least recently used open font or glyph page
+            FontEntry *oldestFont = nullptr;
+            auto oldestPage = pages_.end();
+            uint64_t oldest = UINT64_MAX;
+
+            for (auto &entry : fonts_)
+            {
+                if (entry.font && &entry != keep && entry.lastUse < oldest)
+                {
+                    oldest = entry.lastUse;
+                    oldestFont = &entry;
+                }
+            }
+            for (auto it = pages_.begin(); it != pages_.end(); ++it)
+            {
+                if (&it->second != keep && it->second.lastUse < oldest)
+                {
+                    oldest = it->second.lastUse;
+                    oldestPage = it;
+                    oldestFont = nullptr;
+                }
+            }
+
+            if (oldestPage != pages_.end())
+            {
+                releasePage(oldestPage->second);
+                pages_.erase(oldestPage);
+            }
+            else if (oldestFont)
+            {
+                closeFont(*oldestFont);
+            }
+            else
+            {
+                break; // Only the entry in use is left
+            }
+            ++evictions_;
+        }
+    }
+
+    FontCacheStats FontCache::getStats() const
+    {
+        FontCacheStats stats;
+        stats.budgetBytes = budget_;
+        stats.fontBytes = fontBytes_;
+        stats.glyphBytes = glyphBytes_;
+        stats.residentBytes = fontBytes_ + glyphBytes_;
+        stats.openFonts = static_cast<size_t>(std::count_if(fonts_.begin(), fonts_.end(), [](const FontEntry &e)
+                                                            { return e.font != nullptr; }));
+        stats.glyphPages = pages_.size();
+        stats.bakedPages = static_cast<size_t>(std::count_if(pages_.begin(), pages_.end(), [](const std::pair<const uint32_t, GlyphPage> &p)
+                                                             { return p.second.baked; }));
+        stats.hits = hits_;
+        stats.misses = misses_;
+        stats.evictions = evictions_;
+        return stats;
+    }
+
+    void FontCache::resetStats()
+    {
+        hits_ = misses_ = evictions_ = 0;
+    }
+
+    void FontCache::logStats() const
+    {
+        FontCacheStats stats = getStats();
+        LOG_INFO("Font cache: %zu/%zu KB resident (fonts %zu KB x%zu, glyphs %zu KB x%zu), %llu hits, %llu misses, %llu evictions",
+                 stats.residentBytes / 1024, stats.budgetBytes / 1024,
+                 stats.fontBytes / 1024, stats.openFonts, stats.glyphBytes / 1024, stats.glyphPages,
+                 static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+                 static_cast<unsigned long long>(stats.evictions));
+    }
+
+    void FontCache::clear()
+    {
+        for (auto &entry : pages_)
+        {
+            releasePage(entry.second);
+        }
+        pages_.clear();
+
+        for (auto &entry : fonts_)
+        {
+            closeFont(entry);
+            entry.failed = false;
+        }
+    }
+
+} // namespace TG5040
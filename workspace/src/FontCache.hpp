@@ -0,0 +1,169 @@
+#pragma once
+
+#include "FontAtlasFormat.hpp"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TG5040
+{
+
+    // Handle to a registered font (path + size). Stable for the lifetime of the process.
+    using FontId = uint16_t;
+    constexpr FontId INVALID_FONT = 0xFFFF;
+
+    struct FontCacheStats
+    {
+        size_t budgetBytes = 0;
+        size_t residentBytes = 0; // Open fonts + glyph page textures
+        size_t fontBytes = 0;
+        size_t glyphBytes = 0;
+        size_t openFonts = 0;
+        size_t glyphPages = 0;
+        size_t bakedPages = 0; // Resident pages uploaded from the baked atlas
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    // Open TTF fonts and pre-rendered glyph pages, kept under a memory budget.
+    //
+    // Text is drawn from glyph pages: textures holding 128 consecutive codepoints rendered
+    // once in white and tinted per draw. When the resident size exceeds the budget the least
+    // recently used fonts and pages are released; they are recreated on their next use.
+    // Pages stay usable after their font was closed.
+    //
+    // Pages baked offline by tools/fontbake are uploaded straight from the mapped atlas file,
+    // so fonts fully covered by the bake never open a TTF file.
+    class FontCache
+    {
+    public:
+        static constexpr size_t DEFAULT_BUDGET = 8 * 1024 * 1024;
+
+        FontCache() = default;
+        ~FontCache();
+
+        FontCache(const FontCache &) = delete;
+        FontCache &operator=(const FontCache &) = delete;
+
+        // Fonts can be registered at any time, they are opened once a renderer is attached
+        void setRenderer(SDL_Renderer *renderer) { renderer_ = renderer; }
+
+        // Registration - an empty path refers to the default font
+        FontId registerFont(const std::string &fontPath, int fontSize);
+        const std::string &getFontPath(FontId id) const;
+        int getFontSize(FontId id) const;
+        void setDefaultFontPath(const std::string &fontPath);
+        const std::string &getDefaultFontPath() const { return defaultFontPath_; }
+
+        // Map a baked atlas, pages missing from it are rendered live
+        bool loadAtlas(const std::string &path);
+        void unloadAtlas();
+        bool hasAtlas() const { return atlasData_ != nullptr; }
+
+        // Open font, reopened transparently after eviction
+        TTF_Font *getFont(FontId id);
+        void preloadRegisteredFonts();
+
+        // Line height in pixels, 0 if the font is neither baked nor could be opened
+        int getLineHeight(FontId id);
+
+        // Single line text through the glyph pages
+        bool measureText(FontId id, const char *text, size_t length, int &width, int &height);
+        bool measureText(FontId id, const std::string &text, int &width, int &height) { return measureText(id, text.data(), text.size(), width, height); }
+        bool drawText(FontId id, const char *text, size_t length, int x, int y, SDL_Color color);
+        bool drawText(FontId id, const std::string &text, int x, int y, SDL_Color color) { return drawText(id, text.data(), text.size(), x, y, color); }
+
+        // Horizontal advance of one codepoint, 0 if the glyph is unavailable
+        int getAdvance(FontId id, uint32_t codepoint);
+
+        // Memory budget
+        void setBudget(size_t bytes);
+        size_t getBudget() const { return budget_; }
+        FontCacheStats getStats() const;
+        void resetStats();
+        void logStats() const;
+
+        // Close all fonts and release all pages, registrations are kept
+        void clear();
+
+        // Decode one UTF-8 sequence starting at text[i], advances i
+        static uint32_t decodeUtf8(const char *text, size_t length, size_t &i);
+        static uint32_t decodeUtf8(const std::string &text, size_t &i) { return decodeUtf8(text.data(), text.size(), i); }
+
+    private:
+        static constexpr uint32_t PAGE_SHIFT = FontAtlasFormat::PAGE_SHIFT; // 128 codepoints per page
+        static constexpr int PAGE_WIDTH = 512;
+
+        struct FontEntry
+        {
+            std::string path; // Empty = default font
+            int size = 0;
+            TTF_Font *font = nullptr;
+            bool failed = false; // Don't retry a font that failed to open every frame
+            int height = 0;      // Remembered after the first open, or taken from the atlas
+            int ascent = 0;
+            int baked = -1; // Atlas font index
+            size_t bytes = 0;
+            uint64_t lastUse = 0;
+        };
+
+        struct Glyph
+        {
+            uint16_t x = 0, y = 0, w = 0, h = 0;
+            int16_t offsetX = 0; // Horizontal bearing when the glyph overhangs to the left
+            int16_t advance = 0;
+        };
+
+        struct GlyphPage
+        {
+            SDL_Texture *texture = nullptr;
+            Glyph glyphs[1 << PAGE_SHIFT];
+            int height = 0;
+            size_t bytes = 0;
+            uint64_t lastUse = 0;
+            bool baked = false;
+        };
+
+        SDL_Renderer *renderer_ = nullptr;
+        std::string defaultFontPath_ = "res/aller.ttf";
+
+        std::vector<FontEntry> fonts_;
+        std::unordered_map<std::string, FontId> fontIds_; // Key is "fontpath:size", only used when registering
+        std::unordered_map<uint32_t, GlyphPage> pages_;   // Key is fontId << 16 | page
+        uint32_t lastPageKey_ = UINT32_MAX;
+        GlyphPage *lastPage_ = nullptr;
+
+        // Baked atlas, mapped read-only - by us, or as part of the asset archive
+        const uint8_t *atlasData_ = nullptr;
+        size_t atlasSize_ = 0;
+        bool atlasMapped_ = false;
+        const FontAtlasFormat::FontRecord *atlasFonts_ = nullptr;
+        const FontAtlasFormat::PageRecord *atlasPages_ = nullptr;
+        const FontAtlasFormat::GlyphRecord *atlasGlyphs_ = nullptr;
+        std::unordered_map<std::string, uint16_t> bakedFonts_; // "fontpath:size" -> atlas font
+        std::unordered_map<uint32_t, uint32_t> bakedPages_;    // atlas font << 16 | page -> atlas page
+
+        size_t budget_ = DEFAULT_BUDGET;
+        size_t fontBytes_ = 0;
+        size_t glyphBytes_ = 0;
+        uint64_t useCounter_ = 0;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+        uint64_t evictions_ = 0;
+
+        bool openFont(FontEntry &entry);
+        void closeFont(FontEntry &entry);
+        GlyphPage *getPage(FontId id, uint32_t page);
+        bool buildPage(FontId id, uint32_t page, GlyphPage &result);
+        bool uploadBakedPage(uint32_t index, GlyphPage &result);
+        void resolveBaked(FontEntry &entry);
+        void releasePage(GlyphPage &page);
+        void enforceBudget(const void *keep);
+    };
+
+} // namespace TG5040
@@ -0,0 +1,220 @@
+#include "HitTestIndex.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        HitTestIndex::HitTestIndex(int cellSize) : cellSize_(std::max(cellSize, 8))
+        {
+        }
+
+        void HitTestIndex::update(Element *root)
+        {
+            if (!root)
+            {
+                entries_.clear();
+                cells_.clear();
+                columns_ = rows_ = 0;
+                return;
+            }
+
+            uint32_t generation = Element::hierarchyGeneration();
+            if (!dirty_ && generation == generation_)
+            {
+                return;
+            }
+
+            scratch_.clear();
+            collect(root, true);
+
+            const Rect &bounds = root->frame;
+            bool sameBounds = bounds.x == bounds_.x && bounds.y == bounds_.y &&
+                              bounds.width == bounds_.width && bounds.height == bounds_.height;
+
+            bool sameElements = generation == generation_ && sameBounds && scratch_.size() == entries_.size();
+            for (size_t i = 0; sameElements && i < entries_.size(); ++i)
+            {
+                sameElements = entries_[i].element == scratch_[i].element;
+            }
+
+            if (!sameElements)
+            {
+                entries_.swap(scratch_);
+                rebuild(bounds);
+            }
+            else
+            {
+                // Same hierarchy - only re-bin elements that moved
+                for (uint32_t i = 0; i < entries_.size(); ++i)
+                {
+                    Entry &entry = entries_[i];
+                    const Entry &current = scratch_[i];
+                    if (entry.frame.x == current.frame.x && entry.frame.y == current.frame.y &&
+                        entry.frame.width == current.frame.width && entry.frame.height == current.frame.height &&
+                        entry.interactive == current.interactive)
+                    {
+                        continue;
+                    }
+
+                    remove(i);
+                    entry.frame = current.frame;
+                    entry.interactive = current.interactive;
+                    insert(i);
+                }
+            }
+
+            generation_ = generation;
+            dirty_ = false;
+        }
+
+        Element *HitTestIndex::hitTest(float x, float y) const
+        {
+            if (columns_ == 0 || rows_ == 0)
+            {
+                return nullptr;
+            }
+
+            int cx = static_cast<int>(std::floor((x - bounds_.x) / cellSize_));
+            int cy = static_cast<int>(std::floor((y - bounds_.y) / cellSize_));
+            if (cx < 0 || cy < 0 || cx >= columns_ || cy >= rows_)
+            {
+                return nullptr;
+            }
+
+            const auto &cell = cells_[cy * columns_ + cx];
+            for (auto it = cell.rbegin(); it != cell.rend(); ++it)
+            {
+                const Entry &entry = entries_[*it];
+                if (entry.frame.contains(x, y))
+                {
+                    return entry.element;
+                }
+            }
+            return nullptr;
+        }
+
+        void HitTestIndex::collect(Element *element, bool interactive)
+        {
+            interactive = interactive && element->userInteractionEnabled;
+
+            Entry entry;
+            entry.element = element;
+            entry.frame = element->frame;
+            entry.interactive = interactive;
+            scratch_.push_back(entry);
+
+            for (auto &child : element->children())
+            {
+                collect(child.get(), interactive);
+            }
+        }
+
+        void HitTestIndex::rebuild(const Rect &bounds)
+        {
+            bounds_ = bounds;
+            columns_ = std::max(1, static_cast<int>(std::ceil(bounds.width / cellSize_)));
+            rows_ = std::max(1, static_cast<int>(std::ceil(bounds.height / cellSize_)));
+
+            cells_.resize(static_cast<size_t>(columns_) * rows_);
+            for (auto &cell : cells_)
+            {
+                cell.clear();
+            }
+
+            for (uint32_t i = 0; i < entries_.size(); ++i)
+            {
+                entries_[i].cellX1 = entries_[i].cellY1 = -1;
+                insert(i);
+            }
+        }
+
+        void HitTestIndex::insert(uint32_t index)
+        {
+            Entry &entry = entries_[index];
+            entry.cellX0 = entry.cellY0 = 0;
+            entry.cellX1 = entry.cellY1 = -1;
+
+            if (!entry.interactive || entry.frame.width <= 0 || entry.frame.height <= 0)
+            {
+                return;
+            }
+
+            int x0 = static_cast<int>(std::floor((entry.frame.x - bounds_.x) / cellSize_));
+            int y0 = static_cast<int>(std::floor((entry.frame.y - bounds_.y) / cellSize_));
+            int x1 = static_cast<int>(std::floor((entry.frame.x + entry.frame.width - bounds_.x) / cellSize_));
+            int y1 = static_cast<int>(std::floor((entry.frame.y + entry.frame.height - bounds_.y) / cellSize_));
+
+            entry.cellX0 = std::max(x0, 0);
+            entry.cellY0 = std::max(y0, 0);
+            entry.cellX1 = std::min(x1, columns_ - 1);
+            entry.cellY1 = std::min(y1, rows_ - 1);
+
+            for (int cy = entry.cellY0; cy <= entry.cellY1; ++cy)
+            {
+                for (int cx = entry.cellX0; cx <= entry.cellX1; ++cx)
+                {
+                    // Keep each cell sorted by paint order
+                    auto &cell = cells_[cy * columns_ + cx];
+                    cell.insert(std::lower_bound(cell.begin(), cell.end(), index), index);
+                }
+            }
+        }
+
+        void HitTestIndex::remove(uint32_t index)
+        {
+            const Entry &entry = entries_[index];
+            for (int cy = entry.cellY0; cy <= entry.cellY1; ++cy)
+            {
+                for (int cx = entry.cellX0; cx <= entry.cellX1; ++cx)
+                {
+                    auto &cell = cells_[cy * columns_ + cx];
+                    auto it = std::lower_bound(cell.begin(), cell.end(), index);
+                    if (it != cell.end() && *it == index)
+                    {
+                        cell.erase(it);
+                    }
+                }
+            }
+        }
+
+        Element *dispatchPointerEvent(Element *target, const SDL_Event &event)
+        {
+            if (!target)
+            {
+                return nullptr;
+            }
+
+            // Path from the target up to the root
+            Element *path[64];
+            int depth = 0;
+            for (Element *e = target; e && depth < 64; e = e->parent())
+            {
+                path[depth++] = e;
+            }
+
+            // Capture phase: root first, stopping before the target
+            for (int i = depth - 1; i > 0; --i)
+            {
+                if (path[i]->handleCaptureEvent(event))
+                {
+                    return path[i];
+                }
+            }
+
+            // Bubble phase: target first
+            for (int i = 0; i < depth; ++i)
+            {
+                if (path[i]->handleEvent(event))
+                {
+                    return path[i];
+                }
+            }
+
+            return nullptr;
+        }
+
+    } // namespace UI
+} // namespace TG5040
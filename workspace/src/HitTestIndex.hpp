@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ConstraintLayout.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        // Uniform grid over element frames for pointer hit-testing.
+        // Elements are kept in paint order so the last hit in a cell is the topmost one.
+        class HitTestIndex
+        {
+        public:
+            explicit HitTestIndex(int cellSize = 64);
+
+            // Mark frames as possibly changed (after layout or animation)
+            void setNeedsUpdate() { dirty_ = true; }
+
+            // Refresh the index if needed. Only elements whose frame changed are
+            // re-binned unless the hierarchy itself changed.
+            void update(Element *root);
+
+            // Topmost interactive element containing the point, or nullptr
+            Element *hitTest(float x, float y) const;
+
+            size_t elementCount() const { return entries_.size(); }
+
+        private:
+            struct Entry
+            {
+                Element *element = nullptr;
+                Rect frame;
+                bool interactive = false;
+                int cellX0 = 0, cellY0 = 0, cellX1 = -1, cellY1 = -1;
+            };
+
+            int cellSize_;
+            int columns_ = 0;
+            int rows_ = 0;
+            Rect bounds_;
+            bool dirty_ = true;
+            uint32_t generation_ = 0;
+
+            std::vector<Entry> entries_;
+            std::vector<Entry> scratch_;
+            std::vector<std::vector<uint32_t>> cells_;
+
+            void collect(Element *element, bool interactive);
+            void rebuild(const Rect &bounds);
+            void insert(uint32_t index);
+            void remove(uint32_t index);
+        };
+
+        // Deliver a pointer event to a target: capture phase from the root down to the
+        // target's parent, then bubble from the target up. Returns the element that handled it.
+        Element *dispatchPointerEvent(Element *target, const SDL_Event &event);
+
+    } // namespace UI
+} // namespace TG5040
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace TG5040
+{
+
+    // Move-only std::function replacement that stores the callable inside the object.
+    // Callables larger than Size bytes do not compile, so calling one never allocates.
+    template <typename Signature, size_t Size = 32>
+    class InlineFunction;
+
+    template <typename R, typename... Args, size_t Size>
+    class InlineFunction<R(Args...), Size>
+    {
+    public:
+        InlineFunction() = default;
+
+        template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InlineFunction>::value>>
+        InlineFunction(F &&function)
+        {
+            using T = std::decay_t<F>;
+            static_assert(sizeof(T) <= Size, "Callable too large for InlineFunction: capture less (e.g. a pointer) or raise Size");
+            static_assert(alignof(T) <= alignof(std::max_align_t), "Callable over-aligned for InlineFunction");
+
+            new (storage_) T(std::forward<F>(function));
+            invoke_ = [](void *callable, Args... args) -> R
+            { return (*static_cast<T *>(callable))(std::forward<Args>(args)...); };
+            move_ = [](void *to, void *from)
+            {
+                if (to)
+                {
+                    new (to) T(std::move(*static_cast<T *>(from)));
+                }
+                static_cast<T *>(from)->~T();
+            };
+        }
+
+        InlineFunction(InlineFunction &&other) noexcept { moveFrom(other); }
+
+        InlineFunction &operator=(InlineFunction &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        InlineFunction(const InlineFunction &) = delete;
+        InlineFunction &operator=(const InlineFunction &) = delete;
+
+        ~InlineFunction() { reset(); }
+
+        R operator()(Args... args) const { return invoke_(storage_, std::forward<Args>(args)...); }
+        explicit operator bool() const { return invoke_ != nullptr; }
+
+        void reset()
+        {
+            if (move_)
+            {
+                move_(nullptr, storage_); // Destroy only
+            }
+            invoke_ = nullptr;
+            move_ = nullptr;
+        }
+
+    private:
+        alignas(std::max_align_t) mutable unsigned char storage_[Size];
+        R (*invoke_)(void *, Args...) = nullptr;
+        void (*move_)(void *to, void *from) = nullptr;
+
+        void moveFrom(InlineFunction &other)
+        {
+            if (other.move_)
+            {
+                other.move_(storage_, other.storage_);
+            }
+            invoke_ = other.invoke_;
+            move_ = other.move_;
+            other.invoke_ = nullptr;
+            other.move_ = nullptr;
+        }
+    };
+
+    // Token returned when subscribing, 0 = none
+    using CallbackId = uint32_t;
+
+    // Handlers registered for one event. Subscribing may allocate, calling does not; handlers
+    // may subscribe or unsubscribe (also themselves) while being called.
+    template <typename Signature, size_t Size = 32>
+    class CallbackList
+    {
+    public:
+        using Function = InlineFunction<Signature, Size>;
+
+        void add(CallbackId id, Function function)
+        {
+            // Appending while iterating could move the handler that is running
+            (dispatching_ > 0 ? pending_ : entries_).push_back(Entry{id, std::move(function)});
+        }
+
+        bool remove(CallbackId id)
+        {
+            for (auto *list : {&entries_, &pending_})
+            {
+                for (size_t i = 0; i < list->size(); ++i)
+                {
+                    if ((*list)[i].id == id)
+                    {
+                        if (dispatching_ > 0)
+                        {
+                            (*list)[i].id = 0; // Compacted once the dispatch finished
+                            removed_ = true;
+                        }
+                        else
+                        {
+                            list->erase(list->begin() + static_cast<std::ptrdiff_t>(i));
+                        }
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        template <typename... Args>
+        void operator()(Args &&...args)
+        {
+            ++dispatching_;
+            for (size_t i = 0; i < entries_.size(); ++i)
+            {
+                if (entries_[i].id != 0)
+                {
+                    entries_[i].function(args...);
+                }
+            }
+            if (--dispatching_ == 0 && (!pending_.empty() || removed_))
+            {
+                compact();
+            }
+        }
+
+        bool empty() const { return entries_.empty() && pending_.empty(); }
+
+        void clear()
+        {
+            entries_.clear();
+            pending_.clear();
+        }
+
+    private:
+        struct Entry
+        {
+            CallbackId id = 0;
+            Function function;
+        };
+
+        std::vector<Entry> entries_;
+        std::vector<Entry> pending_; // Added during a dispatch
+        int dispatching_ = 0;
+        bool removed_ = false;
+
+        void compact()
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < entries_.size(); ++i)
+            {
+                if (entries_[i].id != 0)
+                {
+                    if (kept != i)
+                    {
+                        entries_[kept] = std::move(entries_[i]);
+                    }
+                    ++kept;
+                }
+            }
+            entries_.resize(kept);
+            for (auto &entry : pending_)
+            {
+                if (entry.id != 0)
+                {
+                    entries_.push_back(std::move(entry));
+                }
+            }
+            pending_.clear();
+            removed_ = false;
+        }
+    };
+
+} // namespace TG5040
@@ -0,0 +1,326 @@
+#define TG5040_LOG_CATEGORY Input
+#include "InputActions.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace TG5040
+{
+
+    InputActions &InputActions::getInstance()
+    {
+        static InputActions instance;
+        return instance;
+    }
+
+    InputActions::InputActions()
+    {
+        std::fill(std::begin(buttonHeld_), std::end(buttonHeld_), INVALID_ACTION);
+        std::fill(std::begin(keyHeld_), std::end(keyHeld_), INVALID_ACTION);
+        clearBindings();
+    }
+
+    ActionId InputActions::registerAction(const std::string &name)
+    {
+        ActionId existing = findAction(name);
+        if (existing != INVALID_ACTION)
+        {
+            return existing;
+        }
+        if (names_.size() >= MAX_ACTIONS)
+        {
+            LOG_ERROR("Cannot register action '%s': limit of %d actions reached", name.c_str(), MAX_ACTIONS);
+            return INVALID_ACTION;
+        }
+
+        names_.push_back(name);
+        return static_cast<ActionId>(names_.size() - 1);
+    }
+
+    ActionId InputActions::findAction(const std::string &name) const
+    {
+        auto it = std::find(names_.begin(), names_.end(), name);
+        return it != names_.end() ? static_cast<ActionId>(it - names_.begin()) : INVALID_ACTION;
+    }
+
+    const std::string &InputActions::getActionName(ActionId action) const
+    {
+        static const std::string none;
+        return action < names_.size() ? names_[action] : none;
+    }
+
+    void InputActions::bindButton(GamepadButton button, ActionId action)
+    {
+        int index = static_cast<int>(button);
+        if (index >= 0 && index < BUTTON_COUNT)
+        {
+            releaseInput(buttonHeld_[index]);
+            buttonActions_[index] = action;
+        }
+    }
+
+    void InputActions::bindKey(SDL_Scancode key, ActionId action)
+    {
+        if (key > SDL_SCANCODE_UNKNOWN && key < SDL_NUM_SCANCODES)
+        {
+            releaseInput(keyHeld_[key]);
+            keyActions_[key] = action;
+        }
+    }
+
+    void InputActions::bindAxis(GamepadAxis axis, int direction, ActionId action, float threshold)
+    {
+        int index = static_cast<int>(axis);
+        if (index < 0 || index >= AXIS_COUNT)
+        {
+            return;
+        }
+
+        AxisBinding &binding = axisActions_[index][direction > 0 ? 1 : 0];
+        releaseAxis(binding);
+        binding.action = action;
+        binding.threshold = threshold;
+        binding.active = false;
+    }
+
+    void InputActions::unbindAction(ActionId action)
+    {
+        for (ActionId &held : buttonHeld_)
+        {
+            if (held == action)
+            {
+                releaseInput(held);
+            }
+        }
+        for (ActionId &held : keyHeld_)
+        {
+            if (held == action)
+            {
+                releaseInput(held);
+            }
+        }
+        std::replace(std::begin(buttonActions_), std::end(buttonActions_), action, INVALID_ACTION);
+        std::replace(std::begin(keyActions_), std::end(keyActions_), action, INVALID_ACTION);
+        for (auto &directions : axisActions_)
+        {
+            for (auto &binding : directions)
+            {
+                if (binding.action == action)
+                {
+                    releaseAxis(binding);
+                    binding = AxisBinding();
+                }
+            }
+        }
+    }
+
+    void InputActions::clearBindings()
+    {
+        // Held actions get their Released before the bindings go
+        releaseAll();
+
+        std::fill(std::begin(buttonActions_), std::end(buttonActions_), INVALID_ACTION);
+        std::fill(std::begin(keyActions_), std::end(keyActions_), INVALID_ACTION);
+        for (auto &directions : axisActions_)
+        {
+            for (auto &binding : directions)
+            {
+                binding = AxisBinding();
+            }
+        }
+    }
+
+    CallbackId InputActions::subscribe(ActionId action, ActionHandler handler)
+    {
+        if (action >= MAX_ACTIONS || !handler)
+        {
+            return 0;
+        }
+
+        if (++nextCallback_ == 0)
+        {
+            ++nextCallback_; // 0 means no subscription
+        }
+        handlers_[action].add(nextCallback_, std::move(handler));
+        return nextCallback_;
+    }
+
+    void InputActions::unsubscribe(CallbackId id)
+    {
+        for (auto &handlers : handlers_)
+        {
+            if (handlers.remove(id))
+            {
+                return;
+            }
+        }
+    }
+
+    bool InputActions::handleEvent(const SDL_Event &event)
+    {
+        switch (event.type)
+        {
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            if (event.cbutton.button >= BUTTON_COUNT)
+            {
+                return false;
+            }
+            return updateInput(buttonHeld_[event.cbutton.button], buttonActions_[event.cbutton.button],
+                               event.type == SDL_CONTROLLERBUTTONDOWN);
+
+        // Devices without a game controller mapping report raw joystick buttons; a mapped one
+        // reports them too, next to its controller buttons and with unrelated indices
+        case SDL_JOYBUTTONDOWN:
+        case SDL_JOYBUTTONUP:
+            if (event.jbutton.button >= BUTTON_COUNT || ControllerManager::getInstance().isGameController(event.jbutton.which))
+            {
+                return false;
+            }
+            return updateInput(buttonHeld_[event.jbutton.button], buttonActions_[event.jbutton.button],
+                               event.type == SDL_JOYBUTTONDOWN);
+
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            if (event.key.keysym.scancode >= SDL_NUM_SCANCODES)
+            {
+                return false;
+            }
+            if (event.key.repeat)
+            {
+                return keyActions_[event.key.keysym.scancode] != INVALID_ACTION;
+            }
+            return updateInput(keyHeld_[event.key.keysym.scancode], keyActions_[event.key.keysym.scancode],
+                               event.type == SDL_KEYDOWN);
+
+        case SDL_CONTROLLERAXISMOTION:
+            if (event.caxis.axis < AXIS_COUNT)
+            {
+                updateAxis(static_cast<GamepadAxis>(event.caxis.axis), event.caxis.value / 32768.0f);
+            }
+            return false;
+
+        // The button up events of a removed controller never arrive
+        case SDL_CONTROLLERDEVICEREMOVED:
+        case SDL_JOYDEVICEREMOVED:
+            releaseController();
+            return false;
+
+        default:
+            return false;
+        }
+    }
+
+    bool InputActions::updateInput(ActionId &held, ActionId bound, bool pressed)
+    {
+        if (pressed)
+        {
+            // A second down without an up is ignored
+            if (held == INVALID_ACTION && bound != INVALID_ACTION)
+            {
+                held = bound;
+                press(bound);
+            }
+            return bound != INVALID_ACTION;
+        }
+
+        bool handled = held != INVALID_ACTION || bound != INVALID_ACTION;
+        releaseInput(held);
+        return handled;
+    }
+
+    void InputActions::releaseInput(ActionId &held)
+    {
+        if (held != INVALID_ACTION)
+        {
+            ActionId action = held;
+            held = INVALID_ACTION;
+            release(action);
+        }
+    }
+
+    void InputActions::releaseAxis(AxisBinding &binding)
+    {
+        if (binding.active)
+        {
+            binding.active = false;
+            release(binding.action);
+        }
+    }
+
+    void InputActions::releaseAll()
+    {
+        for (ActionId &held : keyHeld_)
+        {
+            releaseInput(held);
+        }
+        releaseController();
+    }
+
+    void InputActions::releaseController()
+    {
+        for (ActionId &held : buttonHeld_)
+        {
+            releaseInput(held);
+        }
+        for (auto &directions : axisActions_)
+        {
+            for (auto &binding : directions)
+            {
+                releaseAxis(binding);
+            }
+        }
+    }
+
+    void InputActions::updateAxis(GamepadAxis axis, float value)
+    {
+        for (int direction = 0; direction < 2; ++direction)
+        {
+            AxisBinding &binding = axisActions_[static_cast<int>(axis)][direction];
+            if (binding.action == INVALID_ACTION)
+            {
+                continue;
+            }
+
+            float amount = direction ? value : -value;
+            if (!binding.active && amount >= binding.threshold)
+            {
+                binding.active = true;
+                press(binding.action);
+            }
+            else if (binding.active && amount < binding.threshold * 0.5f)
+            {
+                binding.active = false;
+                release(binding.action);
+            }
+        }
+    }
+
+    void InputActions::press(ActionId action)
+    {
+        if (action >= MAX_ACTIONS)
+        {
+            return;
+        }
+
+        // Several inputs can drive one action, only the first one down counts
+        if (held_[action]++ == 0)
+        {
+            handlers_[action](ButtonState::Pressed);
+        }
+    }
+
+    void InputActions::release(ActionId action)
+    {
+        if (action >= MAX_ACTIONS || held_[action] == 0)
+        {
+            return;
+        }
+
+        if (--held_[action] == 0)
+        {
+            handlers_[action](ButtonState::Released);
+        }
+    }
+
+} // namespace TG5040
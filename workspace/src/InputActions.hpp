@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ControllerManager.hpp"
+#include "InlineFunction.hpp"
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TG5040
+{
+
+    // Index of a registered action
+    using ActionId = uint8_t;
+    constexpr ActionId INVALID_ACTION = 0xFF;
+
+    // Called with Pressed when the first bound input goes down and Released when the last one is let go
+    using ActionHandler = InlineFunction<void(ButtonState state)>;
+
+    // Rebindable mapping from physical inputs to named actions ("jump", "ui_up", ...).
+    //
+    // Buttons, keys and axis directions index flat tables holding an ActionId, and each action
+    // keeps its handlers in a list of inline callables, so dispatching an input is two array
+    // lookups and a loop: no hashing and no allocation. Names are only used when registering.
+    class InputActions
+    {
+    public:
+        static constexpr int MAX_ACTIONS = 64;
+        static constexpr int BUTTON_COUNT = 32;
+        static constexpr int AXIS_COUNT = ControllerState::AXIS_COUNT;
+
+        static InputActions &getInstance();
+
+        InputActions(const InputActions &) = delete;
+        InputActions &operator=(const InputActions &) = delete;
+
+        // Returns the existing action if the name is already registered
+        ActionId registerAction(const std::string &name);
+        ActionId findAction(const std::string &name) const;
+        const std::string &getActionName(ActionId action) const;
+
+        // Each input drives at most one action; binding it again replaces the old binding
+        void bindButton(GamepadButton button, ActionId action);
+        void bindKey(SDL_Scancode key, ActionId action);
+        // direction -1 or 1; pressed beyond threshold, released below half of it
+        void bindAxis(GamepadAxis axis, int direction, ActionId action, float threshold = 0.5f);
+
+        // Remove every input bound to the action, or every binding. An input that is down
+        // releases its action first, in bindButton/bindKey/bindAxis too.
+        void unbindAction(ActionId action);
+        void clearBindings();
+
+        CallbackId subscribe(ActionId action, ActionHandler handler);
+        void unsubscribe(CallbackId id);
+
+        // Controller and unhandled keyboard events from the Application loop. Removing a
+        // controller releases every action its buttons and axes were holding.
+        bool handleEvent(const SDL_Event &event);
+
+        // Release every held action, e.g. when input stops reaching the UI. Their up events are ignored.
+        void releaseAll();
+
+        // Any bound input currently held
+        bool isActionDown(ActionId action) const { return action < MAX_ACTIONS && held_[action] > 0; }
+
+    private:
+        InputActions();
+        ~InputActions() = default;
+
+        struct AxisBinding
+        {
+            ActionId action = INVALID_ACTION;
+            float threshold = 0.5f;
+            bool active = false;
+        };
+
+        std::vector<std::string> names_;
+
+        // Lookup tables: input -> action
+        ActionId buttonActions_[BUTTON_COUNT];
+        ActionId keyActions_[SDL_NUM_SCANCODES];
+        AxisBinding axisActions_[AXIS_COUNT][2]; // Negative, positive direction
+
+        // The action each input pressed while it is down, so it releases that one even if rebound
+        ActionId buttonHeld_[BUTTON_COUNT];
+        ActionId keyHeld_[SDL_NUM_SCANCODES];
+
+        uint8_t held_[MAX_ACTIONS] = {}; // Bound inputs down per action
+        CallbackList<void(ButtonState)> handlers_[MAX_ACTIONS];
+        CallbackId nextCallback_ = 0;
+
+        void press(ActionId action);
+        void release(ActionId action);
+        void updateAxis(GamepadAxis axis, float value);
+        bool updateInput(ActionId &held, ActionId bound, bool pressed);
+        void releaseInput(ActionId &held);
+        void releaseAxis(AxisBinding &binding);
+        void releaseController();
+    };
+
+} // namespace TG5040
@@ -0,0 +1,185 @@
+#define TG5040_LOG_CATEGORY Input
+#include "InputLatency.hpp"
+#include "ControllerManager.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace TG5040
+{
+
+    InputLatency &InputLatency::getInstance()
+    {
+        static InputLatency instance;
+        return instance;
+    }
+
+    InputLatency::InputLatency()
+    {
+        usPerTick_ = 1000000.0 / static_cast<double>(std::max<Uint64>(SDL_GetPerformanceFrequency(), 1));
+    }
+
+    bool InputLatency::isPress(const SDL_Event &event)
+    {
+        switch (event.type)
+        {
+        case SDL_JOYBUTTONDOWN:
+            // A mapped controller reports the same press as SDL_CONTROLLERBUTTONDOWN
+            return !ControllerManager::getInstance().isGameController(event.jbutton.which);
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_FINGERDOWN:
+            return true;
+        case SDL_KEYDOWN:
+            return !event.key.repeat;
+        default:
+            return false;
+        }
+    }
+
+    InputStamp InputLatency::onEvent(const SDL_Event &event)
+    {
+        if (!isPress(event))
+        {
+            current_ = InputStamp();
+            return current_;
+        }
+
+        current_.timestamp = event.common.timestamp;
+        current_.arrival = SDL_GetPerformanceCounter();
+
+        if (pendingCount_ == MAX_PENDING)
+        {
+            ++dropped_;
+            return current_;
+        }
+
+        // Event timestamps and SDL_GetTicks() share a clock
+        Uint32 queuedMs = SDL_GetTicks() - current_.timestamp;
+        pending_[pendingCount_] = current_;
+        pendingQueueUs_[pendingCount_] = queuedMs < 60000 ? queuedMs * 1000 : 0;
+        ++pendingCount_;
+        return current_;
+    }
+
+    void InputLatency::onPresent()
+    {
+        if (pendingCount_ == 0)
+        {
+            return;
+        }
+
+        Uint64 now = SDL_GetPerformanceCounter();
+        for (int i = 0; i < pendingCount_; ++i)
+        {
+            Sample sample;
+            sample.queueUs = pendingQueueUs_[i];
+            sample.latencyUs = sample.queueUs + static_cast<uint32_t>((now - pending_[i].arrival) * usPerTick_);
+            addSample(sample);
+        }
+        pendingCount_ = 0;
+    }
+
+    int InputLatency::bucketFor(uint32_t latencyUs)
+    {
+        return static_cast<int>(std::min<uint32_t>(latencyUs / 1000, BUCKETS - 1));
+    }
+
+    void InputLatency::addSample(const Sample &sample)
+    {
+        // Rolling window: the sample being overwritten leaves the histogram
+        Sample &slot = window_[total_ % WINDOW];
+        if (total_ >= WINDOW)
+        {
+            --histogram_[bucketFor(slot.latencyUs)];
+        }
+        slot = sample;
+        ++histogram_[bucketFor(sample.latencyUs)];
+        ++total_;
+    }
+
+    LatencyStats InputLatency::getStats() const
+    {
+        LatencyStats stats;
+        stats.total = total_;
+        stats.dropped = dropped_;
+        stats.samples = static_cast<uint32_t>(std::min<uint64_t>(total_, WINDOW));
+        if (stats.samples == 0)
+        {
+            return stats;
+        }
+
+        uint64_t sum = 0;
+        uint64_t queueSum = 0;
+        uint32_t minUs = UINT32_MAX;
+        uint32_t maxUs = 0;
+        for (uint32_t i = 0; i < stats.samples; ++i)
+        {
+            sum += window_[i].latencyUs;
+            queueSum += window_[i].queueUs;
+            minUs = std::min(minUs, window_[i].latencyUs);
+            maxUs = std::max(maxUs, window_[i].latencyUs);
+        }
+        stats.minMs = minUs / 1000.0f;
+        stats.maxMs = maxUs / 1000.0f;
+        stats.meanMs = sum / 1000.0f / stats.samples;
+        stats.meanQueueMs = queueSum / 1000.0f / stats.samples;
+
+        // Upper edge of the bucket holding the percentile
+        auto percentile = [&](float fraction)
+        {
+            uint32_t target = static_cast<uint32_t>(fraction * (stats.samples - 1)) + 1;
+            uint32_t seen = 0;
+            for (int bucket = 0; bucket < BUCKETS; ++bucket)
+            {
+                seen += histogram_[bucket];
+                if (seen >= target)
+                {
+                    return std::min(static_cast<float>(bucket + 1), stats.maxMs);
+                }
+            }
+            return stats.maxMs;
+        };
+        stats.p50Ms = percentile(0.5f);
+        stats.p90Ms = percentile(0.9f);
+        stats.p99Ms = percentile(0.99f);
+        return stats;
+    }
+
+    void InputLatency::reset()
+    {
+        std::memset(histogram_, 0, sizeof(histogram_));
+        total_ = 0;
+        dropped_ = 0;
+        pendingCount_ = 0;
+    }
+
+    void InputLatency::dump(const char *label) const
+    {
+        LatencyStats stats = getStats();
+        LOG_INFO("Input-to-present latency%s%s: %u samples, min %.1f / mean %.1f / p50 %.0f / p90 %.0f / p99 %.0f / max %.1f ms "
+                 "(%.1f ms queued in SDL), %llu dropped",
+                 label ? " " : "", label ? label : "", stats.samples, stats.minMs, stats.meanMs, stats.p50Ms, stats.p90Ms,
+                 stats.p99Ms, stats.maxMs, stats.meanQueueMs, static_cast<unsigned long long>(stats.dropped));
+        if (stats.samples == 0)
+        {
+            return;
+        }
+
+        uint32_t peak = *std::max_element(histogram_, histogram_ + BUCKETS);
+        int last = BUCKETS - 1;
+        while (last > 0 && histogram_[last] == 0)
+        {
+            --last;
+        }
+        for (int bucket = 0; bucket <= last; ++bucket)
+        {
+            char bar[41];
+            int length = static_cast<int>(histogram_[bucket] * 40 / peak);
+            std::memset(bar, '#', length);
+            bar[length] = '\0';
+            LOG_INFO("  %2d%s ms %5u %s", bucket, bucket == BUCKETS - 1 ? "+" : " ", histogram_[bucket], bar);
+        }
+    }
+
+} // namespace TG5040
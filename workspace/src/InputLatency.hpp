@@ -0,0 +1,93 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+
+namespace TG5040
+{
+
+    // When an input event happened (SDL's millisecond timestamp) and when the main loop
+    // dequeued it (performance counter)
+    struct InputStamp
+    {
+        Uint32 timestamp = 0;
+        Uint64 arrival = 0;
+    };
+
+    struct LatencyStats
+    {
+        uint32_t samples = 0; // In the rolling window
+        float minMs = 0.0f;
+        float meanMs = 0.0f;
+        float p50Ms = 0.0f; // Percentiles at histogram bucket resolution
+        float p90Ms = 0.0f;
+        float p99Ms = 0.0f;
+        float maxMs = 0.0f;
+        float meanQueueMs = 0.0f; // Part spent in SDL's queue before the loop saw the event
+        uint64_t total = 0;       // Since the last reset
+        uint64_t dropped = 0;     // More inputs in one frame than could be tracked
+    };
+
+    // Measures input-to-present latency: how long from a press until SDL_RenderPresent
+    // returned for the first frame that could reflect it.
+    //
+    // Application stamps every press as it is dequeued and SDLManager::present() closes all
+    // stamps pending for the frame. Each latency is the SDL event age at dequeue (ms
+    // resolution, queueing before the loop polled) plus the high-resolution time from
+    // dequeue to present. The last WINDOW samples feed a histogram of 1 ms buckets.
+    class InputLatency
+    {
+    public:
+        static constexpr int WINDOW = 256;
+        static constexpr int BUCKETS = 64; // 1 ms each, the last one collects everything slower
+        static constexpr int MAX_PENDING = 32;
+
+        static InputLatency &getInstance();
+
+        InputLatency(const InputLatency &) = delete;
+        InputLatency &operator=(const InputLatency &) = delete;
+
+        // Called for every dequeued event; returns the stamp (zero for events that are not presses)
+        InputStamp onEvent(const SDL_Event &event);
+
+        // Stamp of the event being dispatched, for handlers that want it
+        const InputStamp &current() const { return current_; }
+
+        // Called right after SDL_RenderPresent returned
+        void onPresent();
+
+        LatencyStats getStats() const;
+        const uint32_t *getHistogram() const { return histogram_; }
+        void reset();
+
+        // Log the stats and an ASCII histogram, label names the pacing mode being measured
+        void dump(const char *label = nullptr) const;
+
+        static bool isPress(const SDL_Event &event);
+
+    private:
+        InputLatency();
+        ~InputLatency() = default;
+
+        struct Sample
+        {
+            uint32_t latencyUs = 0;
+            uint32_t queueUs = 0;
+        };
+
+        InputStamp current_;
+        InputStamp pending_[MAX_PENDING];
+        uint32_t pendingQueueUs_[MAX_PENDING] = {};
+        int pendingCount_ = 0;
+
+        Sample window_[WINDOW];
+        uint32_t histogram_[BUCKETS] = {};
+        uint64_t total_ = 0;
+        uint64_t dropped_ = 0;
+        double usPerTick_ = 1.0;
+
+        void addSample(const Sample &sample);
+        static int bucketFor(uint32_t latencyUs);
+    };
+
+} // namespace TG5040
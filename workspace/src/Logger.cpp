@@ -1,10 +1,8 @@
 #include "Logger.hpp"
+#include <algorithm>
+#include <cctype>
 #include <iostream>
-#include <cstdarg>
-#include <ctime>
-#include <iomanip>
-#include <sstream>
-#include <cstring>
+#include <cstdio>
 
 namespace TG5040
 {
@@ -14,80 +12,415 @@ namespace TG5040
         return instance;
     }
 
-    void Logger::init(LogLevel level, const std::string &filename)
+    void Logger::init(LogLevel level, const std::string &filename, LogOutput output)
     {
-        currentLevel_ = level;
+        // Records already queued go to the output they were made for
+        if (initialized_.load(std::memory_order_acquire))
+        {
+            flush();
+        }
 
+        bool binary = output == LogOutput::Binary && !filename.empty();
         if (!filename.empty())
         {
-            logFile_ = std::make_unique<std::ofstream>(filename, std::ios::app);
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto mode = binary ? std::ios::app | std::ios::binary : std::ios::app;
+            logFile_ = std::make_unique<std::ofstream>(filename, mode);
+            binaryFile_ = false;
             if (!logFile_->is_open())
             {
                 std::cerr << "Warning: Could not open log file: " << filename << std::endl;
                 logFile_.reset();
+                binary = false;
             }
+            else if (binary)
+            {
+                BinaryLogFormat::Header header = {};
+                std::memcpy(header.magic, BinaryLogFormat::MAGIC, sizeof(header.magic));
+                header.version = BinaryLogFormat::VERSION;
+                logFile_->write(reinterpret_cast<const char *>(&header), sizeof(header));
+                binaryFile_ = true;
+                generation_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        else if (output == LogOutput::Binary)
+        {
+            std::cerr << "Warning: Binary logging needs a log file, logging text" << std::endl;
+        }
+        if (!filename.empty() || output == LogOutput::Text)
+        {
+            binary_.store(binary, std::memory_order_relaxed);
+        }
+
+        // init() may be called again to change the level or add a file, one writer serves both
+        if (!writer_.joinable())
+        {
+            stopping_ = false;
+            writerDone_ = false;
+            writer_ = std::thread(&Logger::writerThread, this);
         }
 
-        initialized_ = true;
-        log(LogLevel::INFO, __FILE__, __LINE__, "Logger initialized with level: %s", levelToString(level));
+        initialized_.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(levelMutex_);
+            defaultLevel_ = static_cast<int>(level);
+            applyLevels();
+        }
+        log(LogLevel::INFO, logBasename(__FILE__), __LINE__, "Logger initialized with level: %s%s", levelToString(level),
+            binary_.load(std::memory_order_relaxed) ? " (binary records)" : "");
     }
 
     void Logger::close()
     {
-        if (initialized_)
+        if (!initialized_.load(std::memory_order_acquire))
         {
-            log(LogLevel::INFO, __FILE__, __LINE__, "Logger shutting down");
-            if (logFile_)
-            {
-                logFile_->close();
-                logFile_.reset();
-            }
-            initialized_ = false;
+            return;
         }
+
+        log(LogLevel::INFO, logBasename(__FILE__), __LINE__, "Logger shutting down");
+        {
+            std::lock_guard<std::mutex> lock(levelMutex_);
+            initialized_.store(false, std::memory_order_release);
+            applyLevels();
+        }
+
+        // The writer drains the queue once more after it sees the stop flag
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        writer_.join();
+
+        if (logFile_)
+        {
+            logFile_->close();
+            logFile_.reset();
+        }
+        binaryFile_ = false;
+        binary_.store(false, std::memory_order_relaxed);
     }
 
     void Logger::log(LogLevel level, const char *file, int line, const char *format, ...)
     {
-        if (!initialized_ || level < currentLevel_)
+        if (!isEnabled(LogCategory::App, level))
+        {
+            return;
+        }
+
+        va_list args;
+        va_start(args, format);
+        logv(level, file, line, format, args);
+        va_end(args);
+    }
+
+    void Logger::log(LogCategory category, LogLevel level, const char *file, int line, const char *format, ...)
+    {
+        if (!isEnabled(category, level))
         {
             return;
         }
 
-        // Format the message
-        char buffer[1024];
         va_list args;
         va_start(args, format);
-        vsnprintf(buffer, sizeof(buffer), format, args);
+        logv(level, file, line, format, args);
         va_end(args);
+    }
 
-        // Get timestamp
-        std::string timestamp = getCurrentTime();
+    void Logger::logv(LogLevel level, const char *file, int line, const char *format, va_list args)
+    {
+        enqueue(level, file, line, format, args);
 
-        // Extract filename from path
-        const char *filename = strrchr(file, '/');
-        if (!filename)
-            filename = strrchr(file, '\\');
-        if (!filename)
-            filename = file;
-        else
-            filename++;
+        // The process may be about to die, get the record out first
+        if (level == LogLevel::FATAL)
+        {
+            flush();
+        }
+    }
+
+    void Logger::enqueue(LogLevel level, const char *file, int line, const char *format, va_list args)
+    {
+        FlightRecorder &flight = FlightRecorder::getInstance();
+        va_list flightArgs;
+        va_copy(flightArgs, args);
 
-        // Format the complete log line
-        std::ostringstream logLine;
-        logLine << "[" << timestamp << "] [" << levelToString(level) << "] "
-                << filename << ":" << line << " - " << buffer;
+        // Arguments may point at the caller's stack, so the message is formatted here
+        bool queued = push(level, [&](Record &record)
+                           {
+                               record.level = level;
+                               record.file = file;
+                               record.line = line;
+                               record.site = nullptr;
+                               record.time = std::chrono::system_clock::now();
+                               vsnprintf(record.message, MESSAGE_SIZE, format, args);
+                               if (flight.isOpen())
+                               {
+                                   flight.record(static_cast<int>(level), file, line, record.time, record.message);
+                               } });
 
-        // Output to console
-        std::cout << logLine.str() << std::endl;
+        // The flight recorder gets a copy even when the record is dropped
+        if (!queued && flight.isOpen())
+        {
+            flight.record(static_cast<int>(level), file, line, std::chrono::system_clock::now(), format, flightArgs);
+        }
+        va_end(flightArgs);
+    }
 
-        // Output to file if available
-        if (logFile_ && logFile_->is_open())
+    void Logger::wakeWriter(LogLevel level)
+    {
+        // Otherwise the writer picks the record up on its next interval
+        if (level >= LogLevel::ERROR || queue_.size() >= QUEUE_SIZE / 2)
         {
-            *logFile_ << logLine.str() << std::endl;
-            logFile_->flush();
+            wake_.notify_one();
+        }
+    }
+
+    void Logger::setLevel(LogLevel level)
+    {
+        std::lock_guard<std::mutex> lock(levelMutex_);
+        defaultLevel_ = static_cast<int>(level);
+        applyLevels();
+    }
+
+    void Logger::setLevel(LogCategory category, LogLevel level)
+    {
+        std::lock_guard<std::mutex> lock(levelMutex_);
+        levels_[static_cast<size_t>(category)] = static_cast<int>(level);
+        applyLevels();
+    }
+
+    void Logger::resetLevel(LogCategory category)
+    {
+        std::lock_guard<std::mutex> lock(levelMutex_);
+        levels_[static_cast<size_t>(category)] = DEFAULT;
+        applyLevels();
+    }
+
+    LogLevel Logger::getLevel(LogCategory category) const
+    {
+        std::lock_guard<std::mutex> lock(levelMutex_);
+        int level = levels_[static_cast<size_t>(category)];
+        return static_cast<LogLevel>(level == DEFAULT ? defaultLevel_ : level);
+    }
+
+    void Logger::applyLevels()
+    {
+        bool enabled = initialized_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < LOG_CATEGORY_COUNT; ++i)
+        {
+            int level = levels_[i] == DEFAULT ? defaultLevel_ : levels_[i];
+            thresholds_[i].store(enabled ? level : DISABLED, std::memory_order_relaxed);
+        }
+    }
+
+    const char *Logger::categoryName(LogCategory category)
+    {
+        switch (category)
+        {
+        case LogCategory::App:
+            return "app";
+        case LogCategory::Sdl:
+            return "sdl";
+        case LogCategory::Layout:
+            return "layout";
+        case LogCategory::Input:
+            return "input";
+        case LogCategory::Render:
+            return "render";
+        default:
+            return "unknown";
         }
     }
 
+    bool Logger::parseLevel(const std::string &name, LogLevel &level)
+    {
+        static const char *NAMES[] = {"debug", "info", "warn", "error", "fatal"};
+
+        std::string lower = name;
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        for (size_t i = 0; i < sizeof(NAMES) / sizeof(NAMES[0]); ++i)
+        {
+            if (lower == NAMES[i])
+            {
+                level = static_cast<LogLevel>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void LogArgPacker::addString(const char *value)
+    {
+        if (!value)
+        {
+            value = "(null)";
+        }
+        if (size_ + 3 > capacity_)
+        {
+            return;
+        }
+
+        uint16_t length = static_cast<uint16_t>(std::min(std::strlen(value), capacity_ - size_ - 3));
+        data_[size_] = static_cast<char>(BinaryLogFormat::ARG_STRING);
+        std::memcpy(data_ + size_ + 1, &length, sizeof(length));
+        std::memcpy(data_ + size_ + 3, value, length);
+        size_ += 3 + length;
+    }
+
+    void Logger::flush()
+    {
+        size_t target = queue_.pushed();
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!writer_.joinable() || writerDone_)
+        {
+            return;
+        }
+
+        ++flushWaiters_;
+        wake_.notify_one();
+        written_.wait(lock, [&]
+                      { return writtenCount_ >= target || writerDone_; });
+        --flushWaiters_;
+    }
+
+    void Logger::writerThread()
+    {
+        std::string batch;
+        std::string binary;
+        batch.reserve(QUEUE_SIZE * 128);
+        binary.reserve(QUEUE_SIZE * 64);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            bool stopping = stopping_;
+
+            lock.unlock();
+            formatPending(batch, binary);
+            lock.lock();
+
+            // One write and one flush per batch instead of per line; text stays out of a binary file
+            if (!batch.empty())
+            {
+                std::cout.write(batch.data(), batch.size());
+                std::cout.flush();
+                if (logFile_ && !binaryFile_)
+                {
+                    logFile_->write(batch.data(), batch.size());
+                    logFile_->flush();
+                }
+                batch.clear();
+            }
+            if (!binary.empty())
+            {
+                if (logFile_ && binaryFile_)
+                {
+                    logFile_->write(binary.data(), binary.size());
+                    logFile_->flush();
+                }
+                binary.clear();
+            }
+            writtenCount_ = queue_.popped();
+            written_.notify_all();
+
+            if (stopping)
+            {
+                break;
+            }
+
+            wake_.wait_for(lock, WRITE_INTERVAL, [&]
+                           { return stopping_ || flushWaiters_ > 0 || queue_.size() >= QUEUE_SIZE / 2; });
+        }
+
+        writerDone_ = true;
+        written_.notify_all();
+    }
+
+    void Logger::formatPending(std::string &batch, std::string &binary)
+    {
+        uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0)
+        {
+            char message[96];
+            snprintf(message, sizeof(message), "%llu records dropped, the log queue was full",
+                     static_cast<unsigned long long>(dropped));
+            appendLine(batch, LogLevel::WARN, logBasename(__FILE__), __LINE__, std::chrono::system_clock::now(), message);
+        }
+
+        while (queue_.consume([&](const Record &record)
+                              {
+                                  if (record.site)
+                                  {
+                                      appendBinary(binary, record);
+                                  }
+                                  else
+                                  {
+                                      appendLine(batch, record.level, record.file, record.line, record.time, record.message);
+                                  } }))
+        {
+        }
+    }
+
+    void Logger::appendBinary(std::string &binary, const Record &record)
+    {
+        using namespace BinaryLogFormat;
+
+        // A site is described once per file, before its first record
+        LogSite &site = *record.site;
+        uint32_t generation = generation_.load(std::memory_order_relaxed);
+        if (generation != siteGeneration_)
+        {
+            siteGeneration_ = generation;
+            siteCount_ = 0;
+        }
+        if (site.generation != generation)
+        {
+            site.id = ++siteCount_;
+            site.generation = generation;
+
+            SiteEntry entry = {};
+            entry.type = ENTRY_SITE;
+            entry.level = static_cast<uint8_t>(site.level);
+            entry.fileLength = static_cast<uint16_t>(std::strlen(site.file));
+            entry.id = site.id;
+            entry.line = static_cast<uint32_t>(site.line);
+            entry.formatLength = static_cast<uint32_t>(std::strlen(record.format));
+            binary.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+            binary.append(site.file, entry.fileLength);
+            binary.append(record.format, entry.formatLength);
+        }
+
+        RecordEntry entry = {};
+        entry.type = ENTRY_RECORD;
+        entry.payloadLength = record.length;
+        entry.site = site.id;
+        entry.timeNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(record.time.time_since_epoch()).count());
+        binary.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+        binary.append(record.message, record.length);
+    }
+
+    void Logger::appendLine(std::string &batch, LogLevel level, const char *file, int line,
+                            std::chrono::system_clock::time_point time, const char *message)
+    {
+        // localtime runs once per second of log output
+        std::time_t second = std::chrono::system_clock::to_time_t(time);
+        if (second != lastSecond_ || timeText_[0] == '\0')
+        {
+            std::tm tm;
+            localtime_r(&second, &tm);
+            strftime(timeText_, sizeof(timeText_), "%H:%M:%S", &tm);
+            lastSecond_ = second;
+        }
+
+        char prefix[128];
+        int length = snprintf(prefix, sizeof(prefix), "[%s] [%s] %s:%d - ", timeText_, levelToString(level), file, line);
+        batch.append(prefix, std::min<size_t>(std::max(length, 0), sizeof(prefix) - 1));
+        batch.append(message);
+        batch.push_back('\n');
+    }
+
     const char *Logger::levelToString(LogLevel level) const
     {
         switch (level)
@@ -107,14 +440,4 @@ namespace TG5040
         }
     }
 
-    std::string Logger::getCurrentTime() const
-    {
-        auto now = std::time(nullptr);
-        auto tm = *std::localtime(&now);
-
-        std::ostringstream oss;
-        oss << std::put_time(&tm, "%H:%M:%S");
-        return oss.str();
-    }
-
 } // namespace TG5040
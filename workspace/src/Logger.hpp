@@ -1,8 +1,37 @@
 #pragma once
 
-#include <string>
+// Log sites below TG5040_LOG_LEVEL are compiled out, arguments included (make LOG_LEVEL=...)
+#define TG5040_LOG_DEBUG 0
+#define TG5040_LOG_INFO 1
+#define TG5040_LOG_WARN 2
+#define TG5040_LOG_ERROR 3
+#define TG5040_LOG_FATAL 4
+
+#ifndef TG5040_LOG_LEVEL
+#define TG5040_LOG_LEVEL TG5040_LOG_DEBUG
+#endif
+
+// Category of the LOG_* sites in a file, defined before its first #include, e.g.
+// #define TG5040_LOG_CATEGORY Input
+#ifndef TG5040_LOG_CATEGORY
+#define TG5040_LOG_CATEGORY App
+#endif
+
+#include "BinaryLogFormat.hpp"
+#include "FlightRecorder.hpp"
+#include "MpscQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstring>
+#include <ctime>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
 
 namespace TG5040
 {
@@ -16,15 +45,206 @@ namespace TG5040
         FATAL
     };
 
+    // Modules with their own runtime level, named in config.ini [log] by categoryName()
+    enum class LogCategory
+    {
+        App = 0,
+        Sdl,
+        Layout,
+        Input,
+        Render
+    };
+
+    constexpr size_t LOG_CATEGORY_COUNT = 5;
+
+    // What log() does when the writer thread has fallen behind and the queue is full
+    enum class LogOverflow
+    {
+        Drop,  // Discard DEBUG and INFO records and count them; WARN and above still wait
+        Block  // Wait for the writer to make room
+    };
+
+    // Text lines, or binary records (BinaryLogFormat) for tools/logdecode to format on the host
+    enum class LogOutput
+    {
+        Text,
+        Binary
+    };
+
+    // One per log statement, created by the LOG_* macros
+    struct LogSite
+    {
+        LogLevel level;
+        LogCategory category;
+        const char *file;
+        int line;
+        uint32_t id = 0;         // Binary log site entry, assigned by the writer thread
+        uint32_t generation = 0; // Binary file the id belongs to
+    };
+
+    // Appends printf arguments in their binary log encoding, truncating what does not fit
+    class LogArgPacker
+    {
+    public:
+        LogArgPacker(char *data, size_t capacity) : data_(data), capacity_(capacity) {}
+
+        template <typename T>
+        void add(T value)
+        {
+            using namespace BinaryLogFormat;
+            if constexpr (std::is_integral_v<T> && std::is_signed_v<T> && sizeof(T) <= 4)
+            {
+                put(ARG_INT, static_cast<int32_t>(value));
+            }
+            else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+            {
+                put(ARG_INT64, static_cast<int64_t>(value));
+            }
+            else if constexpr (std::is_integral_v<T> && sizeof(T) <= 4)
+            {
+                put(ARG_UINT, static_cast<uint32_t>(value));
+            }
+            else if constexpr (std::is_integral_v<T>)
+            {
+                put(ARG_UINT64, static_cast<uint64_t>(value));
+            }
+            else if constexpr (std::is_enum_v<T>)
+            {
+                put(ARG_INT, static_cast<int32_t>(value));
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                put(ARG_DOUBLE, static_cast<double>(value));
+            }
+            else if constexpr (std::is_same_v<T, const char *> || std::is_same_v<T, char *>)
+            {
+                addString(value);
+            }
+            else
+            {
+                static_assert(std::is_pointer_v<T>, "Log arguments must be printf arguments");
+                put(ARG_POINTER, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+            }
+        }
+
+        size_t size() const { return size_; }
+
+    private:
+        char *data_;
+        size_t capacity_;
+        size_t size_ = 0;
+
+        template <typename V>
+        void put(uint8_t tag, V value)
+        {
+            if (size_ + 1 + sizeof(V) <= capacity_)
+            {
+                data_[size_] = static_cast<char>(tag);
+                std::memcpy(data_ + size_ + 1, &value, sizeof(V));
+                size_ += 1 + sizeof(V);
+            }
+        }
+
+        void addString(const char *value);
+    };
+
+    // Path without directories, evaluated by the compiler for __FILE__
+    constexpr const char *logBasename(const char *path)
+    {
+        const char *name = path;
+        for (const char *c = path; *c; ++c)
+        {
+            if (*c == '/' || *c == '\\')
+            {
+                name = c + 1;
+            }
+        }
+        return name;
+    }
+
+    // Messages are formatted into a lock-free queue on the calling thread; a writer thread
+    // adds the timestamp and source location and writes them to stdout and the log file in
+    // batches, so logging never waits for the SD card. close() and FATAL records wait until
+    // everything queued before them is written.
     class Logger
     {
     public:
+        static constexpr size_t QUEUE_SIZE = 512;
+        static constexpr size_t MESSAGE_SIZE = 480; // Longer messages are truncated
+        static constexpr std::chrono::milliseconds WRITE_INTERVAL{10};
+
         static Logger &getInstance();
 
-        void init(LogLevel level = LogLevel::DEBUG, const std::string &filename = "");
+        // Binary output needs a file; messages logged with log() then go to stdout only
+        void init(LogLevel level = LogLevel::DEBUG, const std::string &filename = "", LogOutput output = LogOutput::Text);
         void close();
 
+        // file is a basename, as the LOG_* macros pass it. Without a category the record is App's.
         void log(LogLevel level, const char *file, int line, const char *format, ...);
+        void log(LogCategory category, LogLevel level, const char *file, int line, const char *format, ...);
+
+        // Used by the LOG_* macros. In binary mode the arguments are stored raw, which needs a
+        // string literal format; otherwise this is log().
+        template <typename... Args>
+        void write(LogSite &site, const char *format, Args... args)
+        {
+            if (!binary_.load(std::memory_order_relaxed))
+            {
+                log(site.category, site.level, site.file, site.line, format, args...);
+                return;
+            }
+
+            // The flight recorder gets a copy even when the record is dropped
+            FlightRecorder &flight = FlightRecorder::getInstance();
+            bool queued = push(site.level, [&](Record &record)
+                               {
+                                   record.site = &site;
+                                   record.format = format;
+                                   record.time = std::chrono::system_clock::now();
+                                   LogArgPacker packer(record.message, MESSAGE_SIZE);
+                                   (packer.add(args), ...);
+                                   record.length = static_cast<uint16_t>(packer.size());
+                                   if (flight.isOpen())
+                                   {
+                                       flight.recordPacked(static_cast<int>(site.level), site.file, site.line, record.time,
+                                                           format, record.message, record.length);
+                                   } });
+            if (!queued && flight.isOpen())
+            {
+                char arguments[BinaryLogFormat::FLIGHT_PAYLOAD_SIZE];
+                LogArgPacker packer(arguments, sizeof(arguments));
+                (packer.add(args), ...);
+                flight.recordPacked(static_cast<int>(site.level), site.file, site.line, std::chrono::system_clock::now(),
+                                    format, arguments, packer.size());
+            }
+            if (site.level == LogLevel::FATAL)
+            {
+                flush();
+            }
+        }
+
+        // The runtime level check, one load and compare; false before init() and after close()
+        static bool isEnabled(LogCategory category, LogLevel level)
+        {
+            return static_cast<int>(level) >= thresholds_[static_cast<size_t>(category)].load(std::memory_order_relaxed);
+        }
+
+        // Levels may change at any time. A category without a level of its own follows the
+        // default level, which init() sets.
+        void setLevel(LogLevel level);
+        void setLevel(LogCategory category, LogLevel level);
+        void resetLevel(LogCategory category);
+        LogLevel getLevel(LogCategory category) const;
+
+        static const char *categoryName(LogCategory category);
+        // Level names as in config.ini: debug, info, warn, error, fatal (any case)
+        static bool parseLevel(const std::string &name, LogLevel &level);
+
+        // Wait until every record queued so far has been written
+        void flush();
+
+        void setOverflowPolicy(LogOverflow policy) { overflow_.store(policy, std::memory_order_relaxed); }
+        uint64_t getDroppedCount() const { return droppedTotal_.load(std::memory_order_relaxed); }
 
         // Prevent copying
         Logger(const Logger &) = delete;
@@ -32,21 +252,120 @@ namespace TG5040
 
     private:
         Logger() = default;
-        ~Logger() = default;
+        ~Logger() { close(); }
+
+        struct Record
+        {
+            LogLevel level = LogLevel::INFO;
+            const char *file = nullptr;
+            int line = 0;
+            LogSite *site = nullptr; // Set for binary records, message then holds packed arguments
+            const char *format = nullptr;
+            uint16_t length = 0;
+            std::chrono::system_clock::time_point time;
+            char message[MESSAGE_SIZE];
+        };
+
+        static constexpr int DISABLED = static_cast<int>(LogLevel::FATAL) + 1;
+        static constexpr int DEFAULT = -1;
+        // What isEnabled() reads: each category's level while initialized, DISABLED otherwise
+        static inline std::atomic<int> thresholds_[LOG_CATEGORY_COUNT] = {DISABLED, DISABLED, DISABLED, DISABLED, DISABLED};
+
+        mutable std::mutex levelMutex_; // Serializes level changes, the thresholds are written under it
+        int defaultLevel_ = static_cast<int>(LogLevel::DEBUG);
+        int levels_[LOG_CATEGORY_COUNT] = {DEFAULT, DEFAULT, DEFAULT, DEFAULT, DEFAULT};
+
+        std::atomic<bool> initialized_{false};
+        std::atomic<LogOverflow> overflow_{LogOverflow::Drop};
+        std::atomic<bool> binary_{false};
+
+        MpscQueue<Record, QUEUE_SIZE> queue_;
+        std::atomic<uint64_t> dropped_{0};      // Since the writer last reported them
+        std::atomic<uint64_t> droppedTotal_{0};
+
+        std::thread writer_;
+        std::mutex mutex_; // Guards the file and the wait below
+        std::condition_variable wake_;
+        std::condition_variable written_;
+        bool stopping_ = false;
+        bool writerDone_ = false;
+        int flushWaiters_ = 0;
+        size_t writtenCount_ = 0; // Records consumed and written, read by flush()
+
+        // Writer thread only: the formatted time of the last second seen
+        std::time_t lastSecond_ = 0;
+        char timeText_[16] = {};
 
-        LogLevel currentLevel_ = LogLevel::DEBUG;
         std::unique_ptr<std::ofstream> logFile_;
-        bool initialized_ = false;
+        bool binaryFile_ = false;
+        std::atomic<uint32_t> generation_{0}; // Incremented per binary file, sites are described again
+        uint32_t siteGeneration_ = 0;         // Writer thread only: file the sites are numbered for
+        uint32_t siteCount_ = 0;
+
+        void logv(LogLevel level, const char *file, int line, const char *format, va_list args);
+        void enqueue(LogLevel level, const char *file, int line, const char *format, va_list args);
+        void applyLevels(); // Call with levelMutex_ held
+        // False when the record was dropped
+        template <typename Fill>
+        bool push(LogLevel level, Fill &&fill);
+        void wakeWriter(LogLevel level);
+
+        void writerThread();
+        void formatPending(std::string &text, std::string &binary);
+        void appendBinary(std::string &binary, const Record &record);
+        void appendLine(std::string &batch, LogLevel level, const char *file, int line,
+                        std::chrono::system_clock::time_point time, const char *message);
 
         const char *levelToString(LogLevel level) const;
-        std::string getCurrentTime() const;
     };
 
+    template <typename Fill>
+    bool Logger::push(LogLevel level, Fill &&fill)
+    {
+        bool wait = level >= LogLevel::WARN || overflow_.load(std::memory_order_relaxed) == LogOverflow::Block;
+        while (!queue_.emplace(fill))
+        {
+            if (!wait || !initialized_.load(std::memory_order_acquire))
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                droppedTotal_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            wake_.notify_one();
+            std::this_thread::yield();
+        }
+        wakeWriter(level);
+        return true;
+    }
+
 } // namespace TG5040
 
-// Convenience macros
-#define LOG_DEBUG(...) TG5040::Logger::getInstance().log(TG5040::LogLevel::DEBUG, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_INFO(...) TG5040::Logger::getInstance().log(TG5040::LogLevel::INFO, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_WARN(...) TG5040::Logger::getInstance().log(TG5040::LogLevel::WARN, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_ERROR(...) TG5040::Logger::getInstance().log(TG5040::LogLevel::ERROR, __FILE__, __LINE__, __VA_ARGS__)
-#define LOG_FATAL(...) TG5040::Logger::getInstance().log(TG5040::LogLevel::FATAL, __FILE__, __LINE__, __VA_ARGS__)
+// Convenience macros. The level test comes first: a site below the compile-time level is dead
+// code, and a disabled one costs a single branch without evaluating its arguments. The runtime
+// check is one load of the category's threshold, whose address is a constant.
+#define TG5040_LOG(category, level, ...)                                                                  \
+    do                                                                                                     \
+    {                                                                                                      \
+        if (TG5040_LOG_##level >= TG5040_LOG_LEVEL &&                                                      \
+            TG5040::Logger::isEnabled(TG5040::LogCategory::category, TG5040::LogLevel::level))             \
+        {                                                                                                  \
+            static constexpr const char *logFile_ = TG5040::logBasename(__FILE__);                         \
+            static TG5040::LogSite logSite_{TG5040::LogLevel::level, TG5040::LogCategory::category,        \
+                                            logFile_, __LINE__};                                           \
+            TG5040::Logger::getInstance().write(logSite_, __VA_ARGS__);                                    \
+        }                                                                                                  \
+    } while (0)
+
+// In the file's category
+#define LOG_DEBUG(...) TG5040_LOG(TG5040_LOG_CATEGORY, DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) TG5040_LOG(TG5040_LOG_CATEGORY, INFO, __VA_ARGS__)
+#define LOG_WARN(...) TG5040_LOG(TG5040_LOG_CATEGORY, WARN, __VA_ARGS__)
+#define LOG_ERROR(...) TG5040_LOG(TG5040_LOG_CATEGORY, ERROR, __VA_ARGS__)
+#define LOG_FATAL(...) TG5040_LOG(TG5040_LOG_CATEGORY, FATAL, __VA_ARGS__)
+
+// In another category: LOGC_DEBUG(Input, "...")
+#define LOGC_DEBUG(category, ...) TG5040_LOG(category, DEBUG, __VA_ARGS__)
+#define LOGC_INFO(category, ...) TG5040_LOG(category, INFO, __VA_ARGS__)
+#define LOGC_WARN(category, ...) TG5040_LOG(category, WARN, __VA_ARGS__)
+#define LOGC_ERROR(category, ...) TG5040_LOG(category, ERROR, __VA_ARGS__)
+#define LOGC_FATAL(category, ...) TG5040_LOG(category, FATAL, __VA_ARGS__)
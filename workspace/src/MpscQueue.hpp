@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace TG5040
+{
+
+    // Bounded lock-free queue for any number of producer threads and one consumer thread.
+    // A producer claims a slot with a compare-and-swap and fills it in place; the consumer
+    // sees the slot once the producer has published it. Nothing blocks or allocates, emplace()
+    // fails when the queue is full.
+    template <typename T, size_t Capacity>
+    class MpscQueue
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        MpscQueue()
+        {
+            for (size_t i = 0; i < Capacity; ++i)
+            {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Producer side: fill(T &) writes the item into its slot
+        template <typename Fill>
+        bool emplace(Fill &&fill)
+        {
+            size_t position = head_.load(std::memory_order_relaxed);
+            Slot *slot;
+            for (;;)
+            {
+                slot = &slots_[position & (Capacity - 1)];
+                size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0)
+                {
+                    if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    return false; // The consumer has not freed this slot yet
+                }
+                else
+                {
+                    position = head_.load(std::memory_order_relaxed);
+                }
+            }
+
+            fill(slot->item);
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool push(const T &item)
+        {
+            return emplace([&](T &target)
+                           { target = item; });
+        }
+
+        // Consumer side: consume(const T &) reads the item in place. Stops at a slot that was
+        // claimed but not published yet, even if later ones are ready.
+        template <typename Consume>
+        bool consume(Consume &&consume)
+        {
+            size_t position = tail_.load(std::memory_order_relaxed);
+            Slot &slot = slots_[position & (Capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            {
+                return false;
+            }
+
+            consume(static_cast<const T &>(slot.item));
+            slot.sequence.store(position + Capacity, std::memory_order_release);
+            tail_.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T &item)
+        {
+            return consume([&](const T &source)
+                           { item = source; });
+        }
+
+        // Items ever claimed and ever consumed; their difference is the approximate size
+        size_t pushed() const { return head_.load(std::memory_order_acquire); }
+        size_t popped() const { return tail_.load(std::memory_order_acquire); }
+        size_t size() const
+        {
+            size_t tail = popped();
+            return pushed() - tail;
+        }
+        static constexpr size_t capacity() { return Capacity; }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            T item;
+        };
+
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+        alignas(64) Slot slots_[Capacity];
+    };
+
+} // namespace TG5040
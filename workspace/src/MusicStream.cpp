@@ -0,0 +1,357 @@
+#include "MusicStream.hpp"
+#include "ResourceManager.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#ifdef TG5040_HAVE_VORBIS
+#include <vorbis/vorbisfile.h>
+#endif
+
+namespace TG5040
+{
+    namespace
+    {
+        constexpr size_t DECODE_CHUNK = 4096; // Bytes decoded per step
+
+        uint16_t readLE16(const uint8_t *p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+        uint32_t readLE32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24); }
+
+        bool endsWith(const std::string &text, const char *suffix)
+        {
+            size_t length = std::strlen(suffix);
+            if (text.size() < length)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < length; ++i)
+            {
+                if (std::tolower(static_cast<unsigned char>(text[text.size() - length + i])) != suffix[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // RIFF WAVE with 8/16-bit PCM or 32-bit float samples, read straight from the file
+        class WavDecoder : public MusicDecoder
+        {
+        public:
+            ~WavDecoder() override
+            {
+                if (rw_)
+                {
+                    SDL_RWclose(rw_);
+                }
+            }
+
+            bool open(SDL_RWops *rw, std::string &error)
+            {
+                rw_ = rw;
+
+                uint8_t riff[12];
+                if (SDL_RWread(rw_, riff, 1, sizeof(riff)) != sizeof(riff) ||
+                    std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0)
+                {
+                    error = "not a WAVE file";
+                    return false;
+                }
+
+                bool haveFormat = false;
+                uint8_t chunk[8];
+                while (SDL_RWread(rw_, chunk, 1, sizeof(chunk)) == sizeof(chunk))
+                {
+                    uint32_t size = readLE32(chunk + 4);
+                    if (std::memcmp(chunk, "fmt ", 4) == 0)
+                    {
+                        uint8_t fmt[40] = {};
+                        size_t count = std::min<size_t>(size, sizeof(fmt));
+                        if (size < 16 || SDL_RWread(rw_, fmt, 1, count) != count)
+                        {
+                            error = "truncated format chunk";
+                            return false;
+                        }
+                        uint16_t tag = readLE16(fmt);
+                        if (tag == 0xFFFE && count >= 26)
+                        {
+                            tag = readLE16(fmt + 24); // WAVE_FORMAT_EXTENSIBLE sub-format
+                        }
+                        channels_ = readLE16(fmt + 2);
+                        frequency_ = static_cast<int>(readLE32(fmt + 4));
+                        uint16_t bits = readLE16(fmt + 14);
+
+                        if (tag == 1 && bits == 8)
+                        {
+                            format_ = AUDIO_U8;
+                        }
+                        else if (tag == 1 && bits == 16)
+                        {
+                            format_ = AUDIO_S16LSB;
+                        }
+                        else if (tag == 3 && bits == 32)
+                        {
+                            format_ = AUDIO_F32LSB;
+                        }
+                        else
+                        {
+                            error = "unsupported sample format " + std::to_string(tag) + "/" + std::to_string(bits) + " bit";
+                            return false;
+                        }
+                        if (channels_ < 1 || channels_ > 2 || frequency_ <= 0)
+                        {
+                            error = "unsupported channel layout";
+                            return false;
+                        }
+                        frameSize_ = static_cast<size_t>(channels_) * (bits / 8);
+                        haveFormat = true;
+                        SDL_RWseek(rw_, (size - count) + (size & 1), RW_SEEK_CUR);
+                    }
+                    else if (std::memcmp(chunk, "data", 4) == 0)
+                    {
+                        if (!haveFormat)
+                        {
+                            error = "data before format chunk";
+                            return false;
+                        }
+                        dataStart_ = SDL_RWtell(rw_);
+                        dataSize_ = size - size % frameSize_;
+                        remaining_ = dataSize_;
+                        return true;
+                    }
+                    else
+                    {
+                        SDL_RWseek(rw_, size + (size & 1), RW_SEEK_CUR); // Chunks are word aligned
+                    }
+                }
+
+                error = "no data chunk";
+                return false;
+            }
+
+            size_t read(uint8_t *buffer, size_t size) override
+            {
+                size = std::min<size_t>(size - size % frameSize_, remaining_);
+                size_t count = size > 0 ? SDL_RWread(rw_, buffer, 1, size) : 0;
+                count -= count % frameSize_;
+                remaining_ = count > 0 ? remaining_ - count : 0;
+                return count;
+            }
+
+            bool rewind() override
+            {
+                remaining_ = dataSize_;
+                return SDL_RWseek(rw_, dataStart_, RW_SEEK_SET) == dataStart_;
+            }
+
+        private:
+            SDL_RWops *rw_ = nullptr;
+            size_t frameSize_ = 4;
+            Sint64 dataStart_ = 0;
+            size_t dataSize_ = 0;
+            size_t remaining_ = 0;
+        };
+
+#ifdef TG5040_HAVE_VORBIS
+        // Ogg Vorbis through libvorbisfile, reading from the archive or a loose file
+        class VorbisDecoder : public MusicDecoder
+        {
+        public:
+            ~VorbisDecoder() override
+            {
+                if (opened_)
+                {
+                    ov_clear(&file_); // Closes rw_ through the close callback
+                }
+                else if (rw_)
+                {
+                    SDL_RWclose(rw_);
+                }
+            }
+
+            bool open(SDL_RWops *rw, std::string &error)
+            {
+                rw_ = rw;
+                ov_callbacks callbacks;
+                callbacks.read_func = [](void *ptr, size_t size, size_t count, void *source) -> size_t
+                {
+                    return SDL_RWread(static_cast<SDL_RWops *>(source), ptr, size, count);
+                };
+                callbacks.seek_func = [](void *source, ogg_int64_t offset, int whence) -> int
+                {
+                    return SDL_RWseek(static_cast<SDL_RWops *>(source), offset, whence) < 0 ? -1 : 0;
+                };
+                callbacks.close_func = [](void *source) -> int
+                {
+                    return SDL_RWclose(static_cast<SDL_RWops *>(source));
+                };
+                callbacks.tell_func = [](void *source) -> long
+                {
+                    return static_cast<long>(SDL_RWtell(static_cast<SDL_RWops *>(source)));
+                };
+
+                if (ov_open_callbacks(rw_, &file_, nullptr, 0, callbacks) != 0)
+                {
+                    error = "not an Ogg Vorbis file";
+                    return false;
+                }
+                opened_ = true;
+
+                vorbis_info *info = ov_info(&file_, -1);
+                if (!info || info->channels < 1 || info->channels > 2)
+                {
+                    error = "unsupported channel layout";
+                    return false;
+                }
+                format_ = AUDIO_S16LSB;
+                channels_ = info->channels;
+                frequency_ = static_cast<int>(info->rate);
+                return true;
+            }
+
+            size_t read(uint8_t *buffer, size_t size) override
+            {
+                size_t total = 0;
+                while (total < size)
+                {
+                    int section = 0;
+                    long count = ov_read(&file_, reinterpret_cast<char *>(buffer + total), static_cast<int>(size - total),
+                                         0, 2, 1, &section);
+                    if (count == OV_HOLE)
+                    {
+                        continue; // Recoverable gap in the stream
+                    }
+                    if (count <= 0)
+                    {
+                        break;
+                    }
+                    total += static_cast<size_t>(count);
+                }
+                return total;
+            }
+
+            bool rewind() override { return ov_raw_seek(&file_, 0) == 0; }
+
+        private:
+            SDL_RWops *rw_ = nullptr;
+            OggVorbis_File file_ = {};
+            bool opened_ = false;
+        };
+#endif
+    } // namespace
+
+    std::unique_ptr<MusicDecoder> MusicDecoder::open(const std::string &path, std::string &error)
+    {
+        SDL_RWops *rw = ResourceManager::getInstance().openFile(path);
+        if (!rw)
+        {
+            error = SDL_GetError();
+            return nullptr;
+        }
+
+        if (endsWith(path, ".ogg"))
+        {
+#ifdef TG5040_HAVE_VORBIS
+            auto decoder = std::make_unique<VorbisDecoder>();
+            if (!decoder->open(rw, error))
+            {
+                return nullptr;
+            }
+            return decoder;
+#else
+            SDL_RWclose(rw);
+            error = "built without Ogg Vorbis support (make VORBIS=1)";
+            return nullptr;
+#endif
+        }
+
+        auto decoder = std::make_unique<WavDecoder>();
+        if (!decoder->open(rw, error))
+        {
+            return nullptr;
+        }
+        return decoder;
+    }
+
+    MusicStream::MusicStream(std::unique_ptr<MusicDecoder> decoder, bool loop, int deviceFrequency, size_t bufferFrames)
+        : decoder_(std::move(decoder)), ring_(bufferFrames * 2), loop_(loop), decodeBuffer_(DECODE_CHUNK),
+          convertBuffer_(DECODE_CHUNK / sizeof(int16_t))
+    {
+        converter_ = SDL_NewAudioStream(decoder_->format(), static_cast<Uint8>(decoder_->channels()), decoder_->frequency(),
+                                        AUDIO_S16SYS, 2, deviceFrequency);
+    }
+
+    MusicStream::~MusicStream()
+    {
+        if (converter_)
+        {
+            SDL_FreeAudioStream(converter_);
+        }
+    }
+
+    void MusicStream::fill()
+    {
+        if (!converter_ || decodeDone_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        while (ring_.space() >= 2)
+        {
+            // Hand converted frames over first, only decode more once the converter is drained
+            int available = SDL_AudioStreamAvailable(converter_);
+            if (available > 0)
+            {
+                size_t bytes = std::min({static_cast<size_t>(available), ring_.space() * sizeof(int16_t),
+                                         convertBuffer_.size() * sizeof(int16_t)});
+                bytes -= bytes % (2 * sizeof(int16_t)); // Whole frames only
+                if (bytes == 0)
+                {
+                    return;
+                }
+                int got = SDL_AudioStreamGet(converter_, convertBuffer_.data(), static_cast<int>(bytes));
+                if (got <= 0)
+                {
+                    break;
+                }
+                ring_.write(convertBuffer_.data(), static_cast<size_t>(got) / sizeof(int16_t));
+                continue;
+            }
+            if (flushed_)
+            {
+                break;
+            }
+
+            size_t count = decoder_->read(decodeBuffer_.data(), decodeBuffer_.size());
+            if (count > 0)
+            {
+                bytesSinceRewind_ += count;
+                if (SDL_AudioStreamPut(converter_, decodeBuffer_.data(), static_cast<int>(count)) < 0)
+                {
+                    break;
+                }
+                continue;
+            }
+
+            // End of file: looping keeps feeding the same converter, so the seam has no gap or click
+            if (loop_ && bytesSinceRewind_ > 0 && decoder_->rewind())
+            {
+                bytesSinceRewind_ = 0;
+                continue;
+            }
+            SDL_AudioStreamFlush(converter_);
+            flushed_ = true;
+        }
+
+        if (flushed_ && SDL_AudioStreamAvailable(converter_) == 0)
+        {
+            decodeDone_.store(true, std::memory_order_release);
+        }
+    }
+
+    size_t MusicStream::read(int16_t *frames, size_t count)
+    {
+        return ring_.read(frames, count * 2) / 2;
+    }
+
+} // namespace TG5040
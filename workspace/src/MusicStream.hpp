@@ -0,0 +1,77 @@
+#pragma once
+
+#include "SpscQueue.hpp"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TG5040
+{
+
+    // Incremental decoder for one music file, produces PCM in the file's own format
+    class MusicDecoder
+    {
+    public:
+        virtual ~MusicDecoder() = default;
+
+        // Returns bytes decoded, 0 at the end of the file or on error
+        virtual size_t read(uint8_t *buffer, size_t size) = 0;
+        virtual bool rewind() = 0;
+
+        SDL_AudioFormat format() const { return format_; }
+        int channels() const { return channels_; }
+        int frequency() const { return frequency_; }
+
+        // WAV always, OGG when built with VORBIS=1; picked by file extension
+        static std::unique_ptr<MusicDecoder> open(const std::string &path, std::string &error);
+
+    protected:
+        SDL_AudioFormat format_ = AUDIO_S16SYS;
+        int channels_ = 2;
+        int frequency_ = 44100;
+    };
+
+    // A music track being streamed: the decoder thread converts it to the device format
+    // (16-bit stereo) into a lock-free ring buffer that the audio callback drains.
+    // Looping rewinds the decoder without flushing the converter, so there is no gap.
+    class MusicStream
+    {
+    public:
+        MusicStream(std::unique_ptr<MusicDecoder> decoder, bool loop, int deviceFrequency, size_t bufferFrames);
+        ~MusicStream();
+
+        MusicStream(const MusicStream &) = delete;
+        MusicStream &operator=(const MusicStream &) = delete;
+
+        bool isValid() const { return converter_ != nullptr; }
+
+        // Decoder thread: decode until the ring buffer is full or the track ended
+        void fill();
+
+        // Audio callback: interleaved stereo frames, returns frames read
+        size_t read(int16_t *frames, size_t count);
+
+        // Nothing more will be written; a short read() before this is an underrun
+        bool isDecodeDone() const { return decodeDone_.load(std::memory_order_acquire); }
+
+        // Everything decoded and played
+        bool isFinished() const { return isDecodeDone() && ring_.available() == 0; }
+
+        size_t bufferedFrames() const { return ring_.available() / 2; }
+
+    private:
+        std::unique_ptr<MusicDecoder> decoder_;
+        SDL_AudioStream *converter_ = nullptr;
+        SpscRingBuffer<int16_t> ring_;
+        bool loop_ = false;
+        bool flushed_ = false;
+        size_t bytesSinceRewind_ = 0;
+        std::atomic<bool> decodeDone_{false};
+        std::vector<uint8_t> decodeBuffer_;
+        std::vector<int16_t> convertBuffer_;
+    };
+
+} // namespace TG5040
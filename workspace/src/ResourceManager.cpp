@@ -0,0 +1,675 @@
+#define TG5040_LOG_CATEGORY Sdl
+#include "ResourceManager.hpp"
+#include "SDLManager.hpp"
+#include "Logger.hpp"
+#include <SDL2/SDL_image.h>
+
+namespace TG5040
+{
+    namespace
+    {
+        const char *typeName(ResourceType type)
+        {
+            switch (type)
+            {
+            case ResourceType::Font:
+                return "fonts";
+            case ResourceType::Texture:
+                return "textures";
+            case ResourceType::Surface:
+                return "surfaces";
+            case ResourceType::Sound:
+                return "sounds";
+            case ResourceType::Blob:
+                return "blobs";
+            default:
+                return "unknown";
+            }
+        }
+    } // namespace
+
+    // ResourceRef
+
+    ResourceRef::ResourceRef(const ResourceRef &other) : index_(other.index_)
+    {
+        ResourceManager::getInstance().addRef(index_);
+    }
+
+    ResourceRef::ResourceRef(ResourceRef &&other) noexcept : index_(other.index_)
+    {
+        other.index_ = INVALID;
+    }
+
+    ResourceRef &ResourceRef::operator=(const ResourceRef &other)
+    {
+        if (this != &other)
+        {
+            ResourceManager::getInstance().addRef(other.index_);
+            reset();
+            index_ = other.index_;
+        }
+        return *this;
+    }
+
+    ResourceRef &ResourceRef::operator=(ResourceRef &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            index_ = other.index_;
+            other.index_ = INVALID;
+        }
+        return *this;
+    }
+
+    ResourceRef::~ResourceRef()
+    {
+        reset();
+    }
+
+    void ResourceRef::reset()
+    {
+        if (index_ != INVALID)
+        {
+            ResourceManager::getInstance().release(index_);
+            index_ = INVALID;
+        }
+    }
+
+    bool ResourceRef::isReady() const
+    {
+        return ResourceManager::getInstance().isReady(index_);
+    }
+
+    FontId FontHandle::id() const
+    {
+        return ResourceManager::getInstance().fontId(index_);
+    }
+
+    // PreloadGroup
+
+    bool PreloadGroup::isReady() const
+    {
+        return progress() >= 1.0f;
+    }
+
+    float PreloadGroup::progress() const
+    {
+        if (refs_.empty())
+        {
+            return 1.0f;
+        }
+
+        const auto &entries = ResourceManager::getInstance().entries_;
+        size_t done = 0;
+        for (const auto &ref : refs_)
+        {
+            auto state = entries[ref.index_]->state.load();
+            if (state == ResourceManager::State::Ready || state == ResourceManager::State::Failed)
+            {
+                ++done;
+            }
+        }
+        return static_cast<float>(done) / refs_.size();
+    }
+
+    size_t PreloadGroup::failedCount() const
+    {
+        const auto &entries = ResourceManager::getInstance().entries_;
+        size_t failed = 0;
+        for (const auto &ref : refs_)
+        {
+            if (entries[ref.index_]->state == ResourceManager::State::Failed)
+            {
+                ++failed;
+            }
+        }
+        return failed;
+    }
+
+    // ResourceManager
+
+    ResourceManager &ResourceManager::getInstance()
+    {
+        static ResourceManager instance;
+        return instance;
+    }
+
+    ResourceManager::~ResourceManager()
+    {
+        if (worker_.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            queueChanged_.notify_all();
+            worker_.join();
+        }
+    }
+
+    TextureHandle ResourceManager::loadTexture(const std::string &path)
+    {
+        return TextureHandle(acquire(ResourceType::Texture, path, 0, true));
+    }
+
+    SurfaceHandle ResourceManager::loadSurface(const std::string &path)
+    {
+        return SurfaceHandle(acquire(ResourceType::Surface, path, 0, true));
+    }
+
+    SoundHandle ResourceManager::loadSound(const std::string &path)
+    {
+        return SoundHandle(acquire(ResourceType::Sound, path, 0, true));
+    }
+
+    BlobHandle ResourceManager::loadBlob(const std::string &path)
+    {
+        return BlobHandle(acquire(ResourceType::Blob, path, 0, true));
+    }
+
+    FontHandle ResourceManager::loadFont(const std::string &path, int size)
+    {
+        return FontHandle(acquire(ResourceType::Font, path, size, true));
+    }
+
+    PreloadGroupPtr ResourceManager::preload(const std::string &name, const std::vector<ResourceRequest> &requests)
+    {
+        auto group = std::make_shared<PreloadGroup>();
+        group->name_ = name;
+        group->refs_.reserve(requests.size());
+        for (const auto &request : requests)
+        {
+            group->refs_.push_back(ResourceRef(acquire(request.type, request.path, request.fontSize, false)));
+        }
+        LOG_DEBUG("Preloading %s: %zu resources", name.c_str(), requests.size());
+        return group;
+    }
+
+    uint32_t ResourceManager::acquire(ResourceType type, const std::string &path, int fontSize, bool wait)
+    {
+        std::string key = std::to_string(static_cast<int>(type)) + ":" + path;
+        if (type == ResourceType::Font)
+        {
+            key += ":" + std::to_string(fontSize);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        uint32_t index;
+        auto it = lookup_.find(key);
+        if (it != lookup_.end())
+        {
+            index = it->second;
+        }
+        else
+        {
+            index = static_cast<uint32_t>(entries_.size());
+            auto entry = std::make_unique<Entry>();
+            entry->type = type;
+            entry->path = path;
+            entry->fontSize = fontSize;
+            entries_.push_back(std::move(entry));
+            lookup_.emplace(std::move(key), index);
+        }
+
+        Entry &entry = *entries_[index];
+        ++entry.refs;
+        entry.lastUse = ++useCounter_;
+
+        State state = entry.state;
+        if (state == State::Ready)
+        {
+            ++counters_[static_cast<size_t>(type)].hits;
+            return index;
+        }
+        if (state == State::Failed)
+        {
+            return index;
+        }
+
+        if (!wait)
+        {
+            if (state == State::Unloaded)
+            {
+                entry.state = State::Queued;
+                queue_.push_back(index);
+                if (!worker_.joinable())
+                {
+                    worker_ = std::thread(&ResourceManager::workerLoop, this);
+                }
+                queueChanged_.notify_one();
+            }
+            return index;
+        }
+
+        if (state == State::Unloaded || state == State::Queued)
+        {
+            // Decode here; a queued entry is skipped by the worker once it is no longer Queued
+            entry.state = State::Loading;
+            lock.unlock();
+            bool ok = decode(entry);
+            lock.lock();
+            entry.decodeOk = ok;
+            entry.state = State::Decoded;
+        }
+        else
+        {
+            entryDecoded_.wait(lock, [&entry]
+                               { return entry.state != State::Loading; });
+        }
+        lock.unlock();
+
+        if (entry.state == State::Decoded)
+        {
+            finish(entry);
+            enforceBudget();
+        }
+        return index;
+    }
+
+    void ResourceManager::addRef(uint32_t index)
+    {
+        if (index < entries_.size())
+        {
+            ++entries_[index]->refs;
+        }
+    }
+
+    void ResourceManager::release(uint32_t index)
+    {
+        if (index < entries_.size())
+        {
+            Entry &entry = *entries_[index];
+            if (entry.refs > 0 && --entry.refs == 0)
+            {
+                entry.lastUse = ++useCounter_;
+            }
+        }
+    }
+
+    bool ResourceManager::mountArchive(const std::string &path)
+    {
+        if (!archive_.open(path))
+        {
+            LOG_INFO("No asset archive at %s, using loose files", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    SDL_RWops *ResourceManager::openFile(const std::string &path) const
+    {
+        if (SDL_RWops *rw = archive_.openFile(path))
+        {
+            return rw;
+        }
+        return SDL_RWFromFile(path.c_str(), "rb");
+    }
+
+    bool ResourceManager::decode(Entry &entry) const
+    {
+        // Runs on the worker thread: no logging, no renderer, errors are kept in the entry
+        if (entry.type == ResourceType::Font)
+        {
+            return true;
+        }
+
+        if (entry.type == ResourceType::Blob && archive_.find(entry.path, entry.blob.data, entry.blob.size))
+        {
+            return true;
+        }
+
+        SDL_RWops *rw = openFile(entry.path);
+        if (!rw)
+        {
+            entry.error = SDL_GetError();
+            return false;
+        }
+
+        switch (entry.type)
+        {
+        case ResourceType::Texture:
+        case ResourceType::Surface:
+            entry.surface = IMG_Load_RW(rw, 1);
+            if (!entry.surface)
+            {
+                entry.error = IMG_GetError();
+                return false;
+            }
+            return true;
+
+        case ResourceType::Sound:
+            if (!SDL_LoadWAV_RW(rw, 1, &entry.sound.spec, &entry.sound.buffer, &entry.sound.length))
+            {
+                entry.error = SDL_GetError();
+                return false;
+            }
+            return true;
+
+        case ResourceType::Blob:
+        {
+            Sint64 size = SDL_RWsize(rw);
+            if (size < 0)
+            {
+                entry.error = SDL_GetError();
+                SDL_RWclose(rw);
+                return false;
+            }
+            entry.blob.storage.resize(static_cast<size_t>(size));
+            size_t read = size > 0 ? SDL_RWread(rw, entry.blob.storage.data(), 1, static_cast<size_t>(size)) : 0;
+            SDL_RWclose(rw);
+            if (read != static_cast<size_t>(size))
+            {
+                entry.error = "short read";
+                entry.blob.storage.clear();
+                return false;
+            }
+            entry.blob.data = entry.blob.storage.data();
+            entry.blob.size = entry.blob.storage.size();
+            return true;
+        }
+
+        default:
+            SDL_RWclose(rw);
+            return false;
+        }
+    }
+
+    void ResourceManager::finish(Entry &entry)
+    {
+        ResourceTypeStats &counters = counters_[static_cast<size_t>(entry.type)];
+        bool ok = entry.decodeOk;
+
+        if (ok && entry.type == ResourceType::Texture)
+        {
+            SDL_Renderer *renderer = SDLManager::getInstance().getRenderer();
+            entry.texture = renderer ? SDL_CreateTextureFromSurface(renderer, entry.surface) : nullptr;
+            if (entry.texture)
+            {
+                entry.bytes = static_cast<size_t>(entry.surface->w) * entry.surface->h * 4;
+            }
+            else
+            {
+                entry.error = renderer ? SDL_GetError() : "no renderer";
+                ok = false;
+            }
+            SDL_FreeSurface(entry.surface);
+            entry.surface = nullptr;
+        }
+        else if (ok && entry.type == ResourceType::Font)
+        {
+            // Baked fonts report a line height without opening the TTF file
+            SDLManager &sdl = SDLManager::getInstance();
+            entry.font = sdl.registerFont(entry.path, entry.fontSize);
+            ok = sdl.getFontCache().getLineHeight(entry.font) > 0;
+            if (!ok)
+            {
+                entry.error = TTF_GetError();
+            }
+        }
+        else if (ok && entry.type == ResourceType::Surface)
+        {
+            entry.bytes = static_cast<size_t>(entry.surface->pitch) * entry.surface->h;
+        }
+        else if (ok && entry.type == ResourceType::Sound)
+        {
+            entry.bytes = entry.sound.length;
+        }
+        else if (ok && entry.type == ResourceType::Blob)
+        {
+            entry.bytes = entry.blob.storage.size(); // Packed blobs live in the archive mapping
+        }
+
+        if (ok)
+        {
+            residentBytes_ += entry.bytes;
+            ++counters.loads;
+            entry.state = State::Ready;
+        }
+        else
+        {
+            ++counters.failures;
+            LOG_WARN("Failed to load %s: %s", entry.path.c_str(), entry.error.c_str());
+            entry.error.clear();
+            entry.state = State::Failed;
+        }
+    }
+
+    void ResourceManager::unload(Entry &entry)
+    {
+        if (entry.texture)
+        {
+            SDL_DestroyTexture(entry.texture);
+            entry.texture = nullptr;
+        }
+        if (entry.surface)
+        {
+            SDL_FreeSurface(entry.surface);
+            entry.surface = nullptr;
+        }
+        if (entry.sound.buffer)
+        {
+            SDL_FreeWAV(entry.sound.buffer);
+            entry.sound = SoundData();
+        }
+        entry.blob = BlobData();
+
+        if (entry.state == State::Ready)
+        {
+            residentBytes_ -= entry.bytes;
+        }
+        entry.bytes = 0;
+        entry.state = State::Unloaded;
+    }
+
+    void ResourceManager::update()
+    {
+        std::vector<uint32_t> decoded;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (decoded_.empty())
+            {
+                return;
+            }
+            decoded.swap(decoded_);
+        }
+
+        // Entries already finished by a synchronous load are no longer Decoded
+        for (uint32_t index : decoded)
+        {
+            Entry &entry = *entries_[index];
+            if (entry.state == State::Decoded)
+            {
+                finish(entry);
+            }
+        }
+        enforceBudget();
+    }
+
+    void ResourceManager::enforceBudget()
+    {
+        size_t fontBytes = SDLManager::getInstance().getFontCacheStats().residentBytes;
+
+        while (residentBytes_ + fontBytes > budget_)
+        {
+            // Least recently released entry without handles; fonts are managed by the font cache
+            Entry *victim = nullptr;
+            for (const auto &entry : entries_)
+            {
+                if (entry->state == State::Ready && entry->refs == 0 && entry->type != ResourceType::Font &&
+                    (!victim || entry->lastUse < victim->lastUse))
+                {
+                    victim = entry.get();
+                }
+            }
+
+            if (!victim)
+            {
+                break;
+            }
+
+            LOG_DEBUG("Evicting %s (%zu KB)", victim->path.c_str(), victim->bytes / 1024);
+            ++counters_[static_cast<size_t>(victim->type)].evictions;
+            unload(*victim);
+        }
+    }
+
+    void ResourceManager::setBudget(size_t bytes)
+    {
+        budget_ = bytes;
+        enforceBudget();
+    }
+
+    void *ResourceManager::data(uint32_t index) const
+    {
+        if (index >= entries_.size())
+        {
+            return nullptr;
+        }
+
+        Entry &entry = *entries_[index];
+        if (entry.state != State::Ready)
+        {
+            return nullptr;
+        }
+
+        switch (entry.type)
+        {
+        case ResourceType::Font:
+            return SDLManager::getInstance().getFont(entry.font);
+        case ResourceType::Texture:
+            return entry.texture;
+        case ResourceType::Surface:
+            return entry.surface;
+        case ResourceType::Sound:
+            return &entry.sound;
+        case ResourceType::Blob:
+            return &entry.blob;
+        default:
+            return nullptr;
+        }
+    }
+
+    FontId ResourceManager::fontId(uint32_t index) const
+    {
+        return isReady(index) ? entries_[index]->font : INVALID_FONT;
+    }
+
+    bool ResourceManager::isReady(uint32_t index) const
+    {
+        return index < entries_.size() && entries_[index]->state == State::Ready;
+    }
+
+    void ResourceManager::workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            queueChanged_.wait(lock, [this]
+                               { return stopping_ || !queue_.empty(); });
+            if (stopping_)
+            {
+                return;
+            }
+
+            uint32_t index = queue_.front();
+            queue_.pop_front();
+
+            Entry &entry = *entries_[index];
+            if (entry.state != State::Queued)
+            {
+                continue; // Taken by a synchronous load
+            }
+
+            entry.state = State::Loading;
+            lock.unlock();
+            bool ok = decode(entry);
+            lock.lock();
+
+            entry.decodeOk = ok;
+            entry.state = State::Decoded;
+            decoded_.push_back(index);
+            entryDecoded_.notify_all();
+        }
+    }
+
+    ResourceStats ResourceManager::getStats() const
+    {
+        ResourceStats stats;
+        stats.budgetBytes = budget_;
+
+        for (size_t i = 0; i < RESOURCE_TYPE_COUNT; ++i)
+        {
+            stats.types[i].loads = counters_[i].loads;
+            stats.types[i].hits = counters_[i].hits;
+            stats.types[i].evictions = counters_[i].evictions;
+            stats.types[i].failures = counters_[i].failures;
+        }
+
+        for (const auto &entry : entries_)
+        {
+            if (entry->state != State::Ready)
+            {
+                continue;
+            }
+            ResourceTypeStats &type = stats.types[static_cast<size_t>(entry->type)];
+            ++type.resident;
+            type.referenced += entry->refs > 0 ? 1 : 0;
+            type.bytes += entry->bytes;
+        }
+
+        stats.types[static_cast<size_t>(ResourceType::Font)].bytes = SDLManager::getInstance().getFontCacheStats().residentBytes;
+        for (const auto &type : stats.types)
+        {
+            stats.residentBytes += type.bytes;
+        }
+        return stats;
+    }
+
+    void ResourceManager::logStats() const
+    {
+        ResourceStats stats = getStats();
+        LOG_INFO("Resources: %zu/%zu KB resident", stats.residentBytes / 1024, stats.budgetBytes / 1024);
+        for (size_t i = 0; i < RESOURCE_TYPE_COUNT; ++i)
+        {
+            const ResourceTypeStats &type = stats.types[i];
+            if (type.resident == 0 && type.loads == 0 && type.failures == 0)
+            {
+                continue;
+            }
+            LOG_INFO("  %-8s %zu KB, %zu resident (%zu referenced), %llu loads, %llu hits, %llu evictions, %llu failures",
+                     typeName(static_cast<ResourceType>(i)), type.bytes / 1024, type.resident, type.referenced,
+                     static_cast<unsigned long long>(type.loads), static_cast<unsigned long long>(type.hits),
+                     static_cast<unsigned long long>(type.evictions), static_cast<unsigned long long>(type.failures));
+        }
+    }
+
+    void ResourceManager::shutdown()
+    {
+        if (worker_.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+                queue_.clear();
+            }
+            queueChanged_.notify_all();
+            worker_.join();
+            stopping_ = false;
+        }
+
+        logStats();
+
+        // Textures must go before the renderer; entries stay so outstanding handles remain valid
+        decoded_.clear();
+        for (auto &entry : entries_)
+        {
+            unload(*entry);
+            entry->font = INVALID_FONT;
+        }
+        residentBytes_ = 0;
+        LOG_INFO("Resource manager shut down");
+    }
+
+} // namespace TG5040
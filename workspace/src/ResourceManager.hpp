@@ -0,0 +1,279 @@
+#pragma once
+
+#include "AssetArchive.hpp"
+#include "FontCache.hpp"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace TG5040
+{
+
+    enum class ResourceType : uint8_t
+    {
+        Font,
+        Texture,
+        Surface,
+        Sound,
+        Blob
+    };
+    constexpr size_t RESOURCE_TYPE_COUNT = 5;
+
+    // PCM decoded from a WAV file, in the file's own format
+    struct SoundData
+    {
+        SDL_AudioSpec spec = {};
+        Uint8 *buffer = nullptr;
+        Uint32 length = 0;
+    };
+
+    // Raw file contents, pointing into the asset archive when the file is packed
+    struct BlobData
+    {
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        std::vector<uint8_t> storage;
+    };
+
+    struct ResourceTypeStats
+    {
+        size_t resident = 0;   // Loaded entries
+        size_t referenced = 0; // Loaded entries with live handles, never evicted
+        size_t bytes = 0;
+        uint64_t loads = 0;
+        uint64_t hits = 0;
+        uint64_t evictions = 0;
+        uint64_t failures = 0;
+    };
+
+    struct ResourceStats
+    {
+        size_t budgetBytes = 0;
+        size_t residentBytes = 0; // All types, fonts as reported by the font cache
+        ResourceTypeStats types[RESOURCE_TYPE_COUNT];
+
+        const ResourceTypeStats &operator[](ResourceType type) const { return types[static_cast<size_t>(type)]; }
+    };
+
+    // Untyped reference to a resource entry. The entry stays resident while any reference exists.
+    class ResourceRef
+    {
+    public:
+        static constexpr uint32_t INVALID = UINT32_MAX;
+
+        ResourceRef() = default;
+        ResourceRef(const ResourceRef &other);
+        ResourceRef(ResourceRef &&other) noexcept;
+        ResourceRef &operator=(const ResourceRef &other);
+        ResourceRef &operator=(ResourceRef &&other) noexcept;
+        ~ResourceRef();
+
+        void reset();
+        bool isNull() const { return index_ == INVALID; }
+
+        // Loaded and usable (a handle can refer to a resource that is still loading or failed)
+        bool isReady() const;
+
+    protected:
+        explicit ResourceRef(uint32_t index) : index_(index) {} // Adopts a reference already taken
+        uint32_t index_ = INVALID;
+
+        friend class ResourceManager;
+        friend class PreloadGroup;
+    };
+
+    template <typename T, ResourceType Type>
+    class ResourceHandle : public ResourceRef
+    {
+    public:
+        ResourceHandle() = default;
+
+        // Null until the resource is loaded
+        T *get() const;
+        explicit operator bool() const { return isReady(); }
+
+    protected:
+        explicit ResourceHandle(uint32_t index) : ResourceRef(index) {}
+        friend class ResourceManager;
+    };
+
+    using TextureHandle = ResourceHandle<SDL_Texture, ResourceType::Texture>;
+    using SurfaceHandle = ResourceHandle<SDL_Surface, ResourceType::Surface>;
+    using SoundHandle = ResourceHandle<SoundData, ResourceType::Sound>;
+    using BlobHandle = ResourceHandle<BlobData, ResourceType::Blob>;
+
+    // Fonts stay in the FontCache, which keeps its own glyph pages; the handle keeps the id
+    class FontHandle : public ResourceHandle<TTF_Font, ResourceType::Font>
+    {
+    public:
+        FontHandle() = default;
+        FontId id() const;
+
+    private:
+        explicit FontHandle(uint32_t index) : ResourceHandle(index) {}
+        friend class ResourceManager;
+    };
+
+    struct ResourceRequest
+    {
+        ResourceType type;
+        std::string path;
+        int fontSize = 0; // Fonts only
+    };
+
+    // Resources requested together, e.g. everything the next screen needs. Holding the group
+    // keeps them resident; once released they stay cached until the budget needs the space.
+    class PreloadGroup
+    {
+    public:
+        const std::string &name() const { return name_; }
+        bool isReady() const;    // Every resource loaded or failed
+        float progress() const;  // 0..1
+        size_t failedCount() const;
+
+    private:
+        std::string name_;
+        std::vector<ResourceRef> refs_;
+        friend class ResourceManager;
+    };
+
+    using PreloadGroupPtr = std::shared_ptr<PreloadGroup>;
+
+    // One owner for fonts, textures, surfaces, sounds and data files.
+    //
+    // Resources are shared by path and reference counted through typed handles. Entries
+    // without handles stay cached; when the total resident size exceeds the budget the least
+    // recently released ones are unloaded. Preload groups decode files on a worker thread;
+    // textures and fonts are finished on the main thread in update().
+    class ResourceManager
+    {
+    public:
+        static constexpr size_t DEFAULT_BUDGET = 32 * 1024 * 1024;
+
+        static ResourceManager &getInstance();
+
+        // Synchronous loads, a resource that is already loaded is returned without touching the file
+        TextureHandle loadTexture(const std::string &path);
+        SurfaceHandle loadSurface(const std::string &path);
+        SoundHandle loadSound(const std::string &path);
+        BlobHandle loadBlob(const std::string &path);
+        FontHandle loadFont(const std::string &path, int size);
+
+        // Queue resources for the worker thread
+        PreloadGroupPtr preload(const std::string &name, const std::vector<ResourceRequest> &requests);
+
+        // Called once per frame by Application: finishes preloaded resources, enforces the budget
+        void update();
+
+        // Serve files from a packed archive (make pak) before falling back to loose files.
+        // Mount it before anything is loaded; it stays mapped until exit.
+        bool mountArchive(const std::string &path);
+        bool hasArchive() const { return archive_.isOpen(); }
+        const AssetArchive &getArchive() const { return archive_; }
+
+        // Opens a file for reading, from the archive without copying if it is there
+        SDL_RWops *openFile(const std::string &path) const;
+
+        // Direct access to a file inside the archive, false if it is not packed
+        bool findData(const std::string &path, const uint8_t *&data, size_t &size) const { return archive_.find(path, data, size); }
+
+        // Memory budget shared by all types, including the font cache
+        void setBudget(size_t bytes);
+        size_t getBudget() const { return budget_; }
+        ResourceStats getStats() const;
+        void logStats() const;
+
+        // Stops the worker and unloads everything, handles stay valid but empty
+        void shutdown();
+
+        // Payload of a ready entry, used by the handles
+        void *data(uint32_t index) const;
+        FontId fontId(uint32_t index) const;
+        bool isReady(uint32_t index) const;
+
+        // Prevent copying
+        ResourceManager(const ResourceManager &) = delete;
+        ResourceManager &operator=(const ResourceManager &) = delete;
+
+    private:
+        ResourceManager() = default;
+        ~ResourceManager();
+
+        enum class State : uint8_t
+        {
+            Unloaded,
+            Queued,
+            Loading, // Owned by the thread decoding it
+            Decoded, // Waiting for the main thread
+            Ready,
+            Failed
+        };
+
+        struct Entry
+        {
+            ResourceType type;
+            std::string path;
+            int fontSize = 0;
+            std::atomic<State> state{State::Unloaded}; // Written under mutex_, read by handles without it
+            bool decodeOk = false;
+            std::string error;
+            uint32_t refs = 0; // Handles live on the main thread only
+            uint64_t lastUse = 0;
+            size_t bytes = 0;
+
+            SDL_Texture *texture = nullptr;
+            SDL_Surface *surface = nullptr; // Surfaces, and textures until uploaded
+            SoundData sound;
+            BlobData blob;
+            FontId font = INVALID_FONT;
+        };
+
+        AssetArchive archive_;
+
+        // Entries are only added, so indices and pointers stay valid
+        std::vector<std::unique_ptr<Entry>> entries_;
+        std::unordered_map<std::string, uint32_t> lookup_; // Key is "type:path[:size]"
+
+        // Shared with the worker, guarded by mutex_
+        mutable std::mutex mutex_;
+        std::condition_variable queueChanged_;
+        std::condition_variable entryDecoded_;
+        std::deque<uint32_t> queue_;
+        std::vector<uint32_t> decoded_;
+        std::thread worker_;
+        bool stopping_ = false;
+
+        size_t budget_ = DEFAULT_BUDGET;
+        size_t residentBytes_ = 0;
+        uint64_t useCounter_ = 0;
+        ResourceTypeStats counters_[RESOURCE_TYPE_COUNT];
+
+        uint32_t acquire(ResourceType type, const std::string &path, int fontSize, bool wait);
+        void addRef(uint32_t index);
+        void release(uint32_t index);
+        bool decode(Entry &entry) const;
+        void finish(Entry &entry);
+        void unload(Entry &entry);
+        void enforceBudget();
+        void workerLoop();
+
+        friend class ResourceRef;
+        friend class PreloadGroup;
+    };
+
+    template <typename T, ResourceType Type>
+    T *ResourceHandle<T, Type>::get() const
+    {
+        return static_cast<T *>(ResourceManager::getInstance().data(index_));
+    }
+
+} // namespace TG5040
@@ -1,15 +1,44 @@
+#define TG5040_LOG_CATEGORY Sdl
 #include "SDLManager.hpp"
+#include "InputLatency.hpp"
 #include "Logger.hpp"
+#include <algorithm>
+#include <cstdlib>
 
 namespace TG5040
 {
+    RenderConfig RenderConfig::fromConfig(const Config &config, const RenderConfig &defaults)
+    {
+        RenderConfig result = defaults;
+        result.backend = config.getString("render", "backend", defaults.backend);
+        result.logicalWidth = config.getInt("render", "logical_width", defaults.logicalWidth);
+        result.logicalHeight = config.getInt("render", "logical_height", defaults.logicalHeight);
+        result.vsync = config.getBool("render", "vsync", defaults.vsync);
+        result.headless = config.getBool("render", "headless", defaults.headless);
+
+        std::string scale = config.getString("render", "scale");
+        if (scale == "integer")
+        {
+            result.scale = RenderScale::Integer;
+        }
+        else if (scale == "linear")
+        {
+            result.scale = RenderScale::Linear;
+        }
+        else if (!scale.empty())
+        {
+            LOG_WARN("Unknown render scale '%s', expected integer or linear", scale.c_str());
+        }
+        return result;
+    }
+
     SDLManager &SDLManager::getInstance()
     {
         static SDLManager instance;
         return instance;
     }
 
-    bool SDLManager::initialize(int screenWidth, int screenHeight, const std::string &title)
+    bool SDLManager::initialize(int screenWidth, int screenHeight, const std::string &title, const RenderConfig &config)
     {
         if (initialized_)
         {
@@ -19,6 +48,17 @@ namespace TG5040
 
         screenWidth_ = screenWidth;
         screenHeight_ = screenHeight;
+        renderWidth_ = screenWidth;
+        renderHeight_ = screenHeight;
+
+        RenderConfig renderConfig = config;
+        if (renderConfig.headless)
+        {
+            // No display or audio device needed, frames are rasterized in memory
+            setenv("SDL_VIDEODRIVER", "dummy", 1);
+            setenv("SDL_AUDIODRIVER", "dummy", 1);
+            renderConfig.backend = "software";
+        }
 
         LOG_INFO("Initializing SDL...");
 
@@ -49,7 +89,7 @@ namespace TG5040
             title.c_str(),
             SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
             screenWidth_, screenHeight_,
-            SDL_WINDOW_SHOWN);
+            renderConfig.headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
 
         if (!window_)
         {
@@ -59,7 +99,7 @@ namespace TG5040
         }
 
         // Create renderer
-        renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+        renderer_ = createRenderer(renderConfig);
         if (!renderer_)
         {
             LOG_FATAL("Renderer creation failed: %s", SDL_GetError());
@@ -67,17 +107,225 @@ namespace TG5040
             return false;
         }
 
+        probeCapabilities();
+
         // Set renderer blend mode for alpha blending
         SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
 
+        setLogicalSize(renderConfig.logicalWidth, renderConfig.logicalHeight, renderConfig.scale);
+
+        // Fonts and glyph pages can be created from now on
+        fontCache_.setRenderer(renderer_);
+
         initialized_ = true;
         LOG_INFO("SDL initialized successfully [%dx%d]", screenWidth_, screenHeight_);
         return true;
     }
 
+    SDL_Renderer *SDLManager::createRenderer(const RenderConfig &config)
+    {
+        capabilities_.availableDrivers.clear();
+
+        int index = -1;
+        Uint32 driverFlags = 0;
+        int count = SDL_GetNumRenderDrivers();
+        for (int i = 0; i < count; ++i)
+        {
+            SDL_RendererInfo info;
+            if (SDL_GetRenderDriverInfo(i, &info) != 0)
+            {
+                continue;
+            }
+            capabilities_.availableDrivers.push_back(info.name);
+            if (index < 0 && config.backend == info.name)
+            {
+                index = i;
+                driverFlags = info.flags;
+            }
+        }
+
+        if (!config.backend.empty() && index < 0)
+        {
+            LOG_WARN("Render backend '%s' not available, using the default", config.backend.c_str());
+        }
+
+        SDL_Renderer *renderer = nullptr;
+        if (index >= 0)
+        {
+            // An explicit driver only accepts flags it advertises
+            Uint32 flags = config.vsync ? (driverFlags & SDL_RENDERER_PRESENTVSYNC) : 0;
+            renderer = SDL_CreateRenderer(window_, index, flags);
+        }
+        else
+        {
+            Uint32 flags = SDL_RENDERER_ACCELERATED | (config.vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
+            renderer = SDL_CreateRenderer(window_, -1, flags);
+        }
+
+        if (!renderer && !(driverFlags & SDL_RENDERER_SOFTWARE))
+        {
+            LOG_WARN("Renderer creation failed (%s), falling back to software", SDL_GetError());
+            renderer = SDL_CreateRenderer(window_, -1, SDL_RENDERER_SOFTWARE);
+        }
+        return renderer;
+    }
+
+    void SDLManager::probeCapabilities()
+    {
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer_, &info) != 0)
+        {
+            LOG_WARN("Could not query renderer: %s", SDL_GetError());
+            return;
+        }
+
+        capabilities_.driver = info.name;
+        capabilities_.accelerated = (info.flags & SDL_RENDERER_ACCELERATED) != 0;
+        capabilities_.vsync = (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+        capabilities_.targetTexture = (info.flags & SDL_RENDERER_TARGETTEXTURE) != 0;
+        capabilities_.maxTextureWidth = info.max_texture_width;
+        capabilities_.maxTextureHeight = info.max_texture_height;
+        if (SDL_GetRendererOutputSize(renderer_, &capabilities_.outputWidth, &capabilities_.outputHeight) != 0)
+        {
+            capabilities_.outputWidth = screenWidth_;
+            capabilities_.outputHeight = screenHeight_;
+        }
+
+        std::string drivers;
+        for (const auto &driver : capabilities_.availableDrivers)
+        {
+            drivers += drivers.empty() ? driver : ", " + driver;
+        }
+
+        LOG_INFO("Renderer: %s (%s, vsync %s, target textures %s, max texture %dx%d, output %dx%d)",
+                 info.name, capabilities_.accelerated ? "accelerated" : "software",
+                 capabilities_.vsync ? "on" : "off", capabilities_.targetTexture ? "yes" : "no",
+                 info.max_texture_width, info.max_texture_height,
+                 capabilities_.outputWidth, capabilities_.outputHeight);
+        LOG_INFO("Available render drivers: %s", drivers.c_str());
+    }
+
+    bool SDLManager::setLogicalSize(int width, int height, RenderScale scale)
+    {
+        if (!renderer_)
+        {
+            return false;
+        }
+
+        releaseFrameTarget();
+        SDL_RenderSetLogicalSize(renderer_, 0, 0);
+        renderWidth_ = screenWidth_;
+        renderHeight_ = screenHeight_;
+
+        if (width <= 0 || height <= 0 || (width == screenWidth_ && height == screenHeight_))
+        {
+            return true;
+        }
+
+        if (width > screenWidth_ || height > screenHeight_)
+        {
+            LOG_WARN("Logical size %dx%d exceeds the window, rendering at %dx%d", width, height, screenWidth_, screenHeight_);
+            return false;
+        }
+
+        // The filter is picked when a texture is created; don't leak it to later textures
+        const char *previous = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+        std::string previousQuality = previous ? previous : "nearest";
+        SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, scale == RenderScale::Integer ? "nearest" : "linear");
+
+        if (capabilities_.targetTexture)
+        {
+            frameTarget_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+            if (!frameTarget_)
+            {
+                LOG_WARN("Could not create %dx%d frame target: %s", width, height, SDL_GetError());
+            }
+        }
+
+        if (frameTarget_)
+        {
+            int outputWidth = capabilities_.outputWidth;
+            int outputHeight = capabilities_.outputHeight;
+            int w, h;
+            if (scale == RenderScale::Integer)
+            {
+                int factor = std::max(1, std::min(outputWidth / width, outputHeight / height));
+                w = width * factor;
+                h = height * factor;
+            }
+            else
+            {
+                float factor = std::min(outputWidth / static_cast<float>(width), outputHeight / static_cast<float>(height));
+                w = static_cast<int>(width * factor + 0.5f);
+                h = static_cast<int>(height * factor + 0.5f);
+            }
+            presentRect_ = {(outputWidth - w) / 2, (outputHeight - h) / 2, w, h};
+            SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, previousQuality.c_str());
+        }
+        else
+        {
+            // Without render targets SDL scales every draw call instead - same picture,
+            // but no fill rate is saved. Textures created from now on use the chosen filter.
+            SDL_RenderSetLogicalSize(renderer_, width, height);
+            SDL_RenderSetIntegerScale(renderer_, scale == RenderScale::Integer ? SDL_TRUE : SDL_FALSE);
+        }
+
+        renderWidth_ = width;
+        renderHeight_ = height;
+        LOG_INFO("Rendering at %dx%d, %s upscale%s", width, height, scale == RenderScale::Integer ? "integer" : "linear",
+                 frameTarget_ ? "" : " (per draw call)");
+        return true;
+    }
+
+    void SDLManager::beginFrame()
+    {
+        if (frameTarget_)
+        {
+            SDL_SetRenderTarget(renderer_, frameTarget_);
+        }
+    }
+
+    void SDLManager::present()
+    {
+        if (frameTarget_)
+        {
+            SDL_SetRenderTarget(renderer_, nullptr);
+            SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 255);
+            SDL_RenderClear(renderer_);
+            SDL_RenderCopy(renderer_, frameTarget_, nullptr, &presentRect_);
+        }
+        SDL_RenderPresent(renderer_);
+        InputLatency::getInstance().onPresent();
+    }
+
+    void SDLManager::windowToRender(int &x, int &y) const
+    {
+        // SDL_RenderSetLogicalSize already maps events itself
+        if (!frameTarget_ || presentRect_.w <= 0 || presentRect_.h <= 0)
+        {
+            return;
+        }
+
+        int outputX = x * capabilities_.outputWidth / std::max(1, screenWidth_);
+        int outputY = y * capabilities_.outputHeight / std::max(1, screenHeight_);
+        x = (outputX - presentRect_.x) * renderWidth_ / presentRect_.w;
+        y = (outputY - presentRect_.y) * renderHeight_ / presentRect_.h;
+    }
+
+    void SDLManager::releaseFrameTarget()
+    {
+        if (frameTarget_)
+        {
+            SDL_DestroyTexture(frameTarget_);
+            frameTarget_ = nullptr;
+        }
+        presentRect_ = {0, 0, 0, 0};
+    }
+
     void SDLManager::shutdown()
     {
         clearFontCache();
+        releaseFrameTarget();
 
         if (renderer_)
         {
@@ -99,30 +347,31 @@ namespace TG5040
         LOG_INFO("SDL shutdown complete");
     }
 
-    TTF_Font *SDLManager::loadFont(const std::string &fontPath, int fontSize)
+    FontId SDLManager::preloadFont(const std::string &fontPath, int fontSize)
     {
-        std::string key = fontPath + ":" + std::to_string(fontSize);
-
-        // Check if already cached
-        auto it = fontCache_.find(key);
-        if (it != fontCache_.end())
-        {
-            return it->second;
-        }
+        FontId id = fontCache_.registerFont(fontPath, fontSize);
+        fontCache_.getFont(id);
+        return id;
+    }
 
-        // Load new font
-        TTF_Font *font = TTF_OpenFont(fontPath.c_str(), fontSize);
-        if (!font)
+    bool SDLManager::preloadFonts(const std::vector<std::pair<std::string, int>> &fonts)
+    {
+        bool ok = true;
+        for (const auto &font : fonts)
         {
-            LOG_ERROR("Failed to load font %s at size %d: %s", fontPath.c_str(), fontSize, TTF_GetError());
-            return nullptr;
+            ok = fontCache_.getFont(fontCache_.registerFont(font.first, font.second)) != nullptr && ok;
         }
+        return ok;
+    }
 
-        // Cache the font
-        fontCache_[key] = font;
-        LOG_INFO("Loaded font: %s at size %d", fontPath.c_str(), fontSize);
+    void SDLManager::preloadRegisteredFonts()
+    {
+        fontCache_.preloadRegisteredFonts();
+    }
 
-        return font;
+    TTF_Font *SDLManager::loadFont(const std::string &fontPath, int fontSize)
+    {
+        return fontCache_.getFont(fontCache_.registerFont(fontPath, fontSize));
     }
 
     TTF_Font *SDLManager::getFont(const std::string &fontPath, int fontSize)
@@ -132,19 +381,15 @@ namespace TG5040
 
     TTF_Font *SDLManager::getDefaultFont(int fontSize)
     {
-        return loadFont(defaultFontPath_, fontSize);
+        return loadFont("", fontSize);
     }
 
     void SDLManager::clearFontCache()
     {
-        for (auto &pair : fontCache_)
-        {
-            if (pair.second)
-            {
-                TTF_CloseFont(pair.second);
-            }
-        }
+        // Handles stay registered so existing FontIds remain valid
+        fontCache_.logStats();
         fontCache_.clear();
+        fontCache_.setRenderer(nullptr);
         LOG_INFO("Font cache cleared");
     }
 
@@ -1,36 +1,113 @@
 #pragma once
 
+#include "Config.hpp"
+#include "FontCache.hpp"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_image.h>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace TG5040
 {
 
+    // How the logical frame is scaled up to the window
+    enum class RenderScale
+    {
+        Linear,  // Fit the window keeping the aspect ratio, filtered
+        Integer  // Largest whole multiple that fits, nearest neighbour, letterboxed
+    };
+
+    struct RenderConfig
+    {
+        std::string backend;   // SDL render driver ("opengles2", "software", ...), empty = SDL's choice
+        int logicalWidth = 0;  // Size the UI is rendered at, 0 = window size
+        int logicalHeight = 0;
+        RenderScale scale = RenderScale::Linear;
+        bool vsync = true;
+        bool headless = false; // Dummy video/audio drivers and the software renderer, for CI
+
+        // [render] section of the config; keys missing from it keep the values of defaults
+        static RenderConfig fromConfig(const Config &config, const RenderConfig &defaults);
+    };
+
+    // What the renderer that was actually created can do, probed once at startup
+    struct RenderCapabilities
+    {
+        std::string driver;
+        bool accelerated = false;
+        bool vsync = false;
+        bool targetTexture = false;
+        int maxTextureWidth = 0; // 0 = unlimited
+        int maxTextureHeight = 0;
+        int outputWidth = 0;
+        int outputHeight = 0;
+        std::vector<std::string> availableDrivers;
+    };
+
     class SDLManager
     {
     public:
         static SDLManager &getInstance();
 
-        bool initialize(int screenWidth = 1280, int screenHeight = 720, const std::string &title = "TG5040 App");
+        bool initialize(int screenWidth = 1280, int screenHeight = 720, const std::string &title = "TG5040 App",
+                        const RenderConfig &config = RenderConfig());
         void shutdown();
 
         SDL_Renderer *getRenderer() const { return renderer_; }
         SDL_Window *getWindow() const { return window_; }
 
+        // Window size
         int getScreenWidth() const { return screenWidth_; }
         int getScreenHeight() const { return screenHeight_; }
 
+        // Logical size the UI renders at, equal to the window size unless a smaller one is set
+        int getRenderWidth() const { return renderWidth_; }
+        int getRenderHeight() const { return renderHeight_; }
+
+        // Render into an offscreen frame of this size and upscale it on present, trading
+        // resolution for fill rate. 0 or the window size renders directly to the window.
+        bool setLogicalSize(int width, int height, RenderScale scale);
+
+        // Frame boundaries - beginFrame() selects the logical frame, present() scales it to the window
+        void beginFrame();
+        void present();
+
+        // Map window coordinates (mouse events) to logical coordinates
+        void windowToRender(int &x, int &y) const;
+
+        const RenderCapabilities &getRenderCapabilities() const { return capabilities_; }
+
         bool isInitialized() const { return initialized_; }
 
-        // Font management
+        // Font management - register once, then look fonts up by handle.
+        // An empty path refers to the default font.
+        FontId registerFont(const std::string &fontPath, int fontSize) { return fontCache_.registerFont(fontPath, fontSize); }
+        TTF_Font *getFont(FontId id) { return fontCache_.getFont(id); }
+        const std::string &getFontPath(FontId id) const { return fontCache_.getFontPath(id); }
+        int getFontSize(FontId id) const { return fontCache_.getFontSize(id); }
+
+        // Map glyph pages baked by tools/fontbake, fonts missing from it render live
+        bool loadFontAtlas(const std::string &path) { return fontCache_.loadAtlas(path); }
+
+        // Fonts and glyph pages share one memory budget with LRU eviction
+        FontCache &getFontCache() { return fontCache_; }
+        void setFontCacheBudget(size_t bytes) { fontCache_.setBudget(bytes); }
+        FontCacheStats getFontCacheStats() const { return fontCache_.getStats(); }
+
+        // Open fonts ahead of the first frame. preloadRegisteredFonts() opens every font
+        // registered so far, e.g. by the Text elements created in onCreate().
+        FontId preloadFont(const std::string &fontPath, int fontSize);
+        bool preloadFonts(const std::vector<std::pair<std::string, int>> &fonts);
+        void preloadRegisteredFonts();
+
+        // String based lookups, kept for compatibility - these hash the path on every call
         TTF_Font *loadFont(const std::string &fontPath, int fontSize);
         TTF_Font *getFont(const std::string &fontPath, int fontSize);
         TTF_Font *getDefaultFont(int fontSize);
-        void setDefaultFontPath(const std::string &fontPath) { defaultFontPath_ = fontPath; }
+        void setDefaultFontPath(const std::string &fontPath) { fontCache_.setDefaultFontPath(fontPath); }
 
         // Prevent copying
         SDLManager(const SDLManager &) = delete;
@@ -44,12 +121,20 @@ namespace TG5040
         SDL_Renderer *renderer_ = nullptr;
         int screenWidth_ = 1280;
         int screenHeight_ = 720;
+        int renderWidth_ = 1280;
+        int renderHeight_ = 720;
         bool initialized_ = false;
 
-        // Font cache - key is "fontpath:size"
-        std::unordered_map<std::string, TTF_Font *> fontCache_;
-        std::string defaultFontPath_ = "res/aller.ttf";
+        // Offscreen logical frame, null when rendering straight to the window
+        SDL_Texture *frameTarget_ = nullptr;
+        SDL_Rect presentRect_ = {0, 0, 0, 0};
+        RenderCapabilities capabilities_;
+
+        FontCache fontCache_;
 
+        SDL_Renderer *createRenderer(const RenderConfig &config);
+        void probeCapabilities();
+        void releaseFrameTarget();
         void clearFontCache();
     };
 
@@ -0,0 +1,320 @@
+#include "SceneStack.hpp"
+#include "Animator.hpp"
+#include "Logger.hpp"
+#include "SDLManager.hpp"
+#include <algorithm>
+
+namespace TG5040
+{
+
+    void SceneStack::push(ScenePtr scene, SceneTransition transition, float duration)
+    {
+        request(Operation::Push, std::move(scene), transition, duration);
+    }
+
+    void SceneStack::replace(ScenePtr scene, SceneTransition transition, float duration)
+    {
+        request(Operation::Replace, std::move(scene), transition, duration);
+    }
+
+    void SceneStack::pop(SceneTransition transition, float duration)
+    {
+        request(Operation::Pop, nullptr, transition, duration);
+    }
+
+    void SceneStack::request(Operation operation, ScenePtr scene, SceneTransition transition, float duration)
+    {
+        if (scene)
+        {
+            if (scene->root_ || scene->resources_)
+            {
+                LOG_WARN("Scene %s is already on the stack", scene->getName().c_str());
+                return;
+            }
+
+            // Decoding starts now, even when earlier requests are still waiting
+            scene->resources_ = ResourceManager::getInstance().preload(scene->getName(), scene->resources());
+        }
+        requests_.push_back({operation, std::move(scene), transition, duration});
+    }
+
+    bool SceneStack::update(float deltaTime, UI::StyleSheet *styleSheet, const UI::Color &background)
+    {
+        if (requests_.empty())
+        {
+            return false;
+        }
+
+        if (!transitioning_)
+        {
+            return begin(requests_.front(), styleSheet, background);
+        }
+
+        elapsed_ += deltaTime;
+        if (elapsed_ < requests_.front().duration)
+        {
+            return false;
+        }
+        finish(requests_.front());
+        return true;
+    }
+
+    bool SceneStack::begin(Request &request, UI::StyleSheet *styleSheet, const UI::Color &background)
+    {
+        ScenePtr incoming;
+        if (request.operation == Operation::Pop)
+        {
+            if (stack_.size() < 2)
+            {
+                LOG_WARN("Cannot pop the last scene");
+                requests_.pop_front();
+                return false;
+            }
+            incoming = stack_[stack_.size() - 2];
+        }
+        else
+        {
+            incoming = request.scene;
+            if (!incoming->resources_->isReady())
+            {
+                return false; // The current scene stays live meanwhile
+            }
+            if (incoming->resources_->failedCount() > 0)
+            {
+                LOG_WARN("Scene %s: %zu resource(s) failed to load", incoming->getName().c_str(),
+                         incoming->resources_->failedCount());
+            }
+
+            incoming->root_ = incoming->onCreate();
+            if (!incoming->root_)
+            {
+                LOG_ERROR("Scene %s created no elements, not shown", incoming->getName().c_str());
+                incoming->resources_.reset();
+                requests_.pop_front();
+                return false;
+            }
+        }
+        layout(incoming->root_.get(), styleSheet);
+
+        ScenePtr outgoing = top();
+        if (outgoing)
+        {
+            outgoing->onExit();
+        }
+
+        if (request.transition != SceneTransition::None && request.duration > 0.0f &&
+            takeSnapshots(outgoing ? outgoing->root_.get() : nullptr, incoming->root_.get(), background))
+        {
+            transitioning_ = true;
+            elapsed_ = 0.0f;
+            return false;
+        }
+
+        finish(request);
+        return true;
+    }
+
+    void SceneStack::finish(Request &request)
+    {
+        switch (request.operation)
+        {
+        case Operation::Push:
+            stack_.push_back(request.scene);
+            break;
+        case Operation::Replace:
+            if (!stack_.empty())
+            {
+                ScenePtr replaced = stack_.back();
+                stack_.pop_back();
+                destroy(*replaced);
+            }
+            stack_.push_back(request.scene);
+            break;
+        case Operation::Pop:
+        {
+            ScenePtr popped = stack_.back();
+            stack_.pop_back();
+            destroy(*popped);
+            break;
+        }
+        }
+
+        transitioning_ = false;
+        requests_.pop_front();
+
+        stack_.back()->onEnter();
+        LOG_DEBUG("Scene %s entered, %zu on the stack", stack_.back()->getName().c_str(), stack_.size());
+    }
+
+    void SceneStack::destroy(Scene &scene)
+    {
+        scene.onDestroy();
+        scene.root_.reset();
+        // Released resources stay cached until the budget needs the space
+        scene.resources_.reset();
+    }
+
+    void SceneStack::layout(UI::Element *root, UI::StyleSheet *styleSheet)
+    {
+        if (styleSheet && styleSheet->apply(root))
+        {
+            root->setNeedsLayout();
+        }
+
+        SDLManager &sdl = SDLManager::getInstance();
+        float width = static_cast<float>(sdl.getRenderWidth());
+        float height = static_cast<float>(sdl.getRenderHeight());
+        if (root->needsLayout() || root->frame.width != width || root->frame.height != height)
+        {
+            root->frame = UI::Rect(0, 0, width, height);
+            root->layoutSubviews();
+        }
+    }
+
+    bool SceneStack::takeSnapshots(UI::Element *outgoing, UI::Element *incoming, const UI::Color &background)
+    {
+        SDLManager &sdl = SDLManager::getInstance();
+        SDL_Renderer *renderer = sdl.getRenderer();
+        if (snapshotsUnsupported_ || !sdl.getRenderCapabilities().targetTexture)
+        {
+            return false;
+        }
+
+        int width = sdl.getRenderWidth();
+        int height = sdl.getRenderHeight();
+        if (width != snapshotWidth_ || height != snapshotHeight_)
+        {
+            releaseSnapshots();
+        }
+        if (!outgoing_)
+        {
+            outgoing_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+            incoming_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+            if (!outgoing_ || !incoming_)
+            {
+                LOG_WARN("Could not create %dx%d scene snapshots, transitions are cuts: %s", width, height, SDL_GetError());
+                releaseSnapshots();
+                snapshotsUnsupported_ = true;
+                return false;
+            }
+            snapshotWidth_ = width;
+            snapshotHeight_ = height;
+        }
+
+        // Rendered once here, the transition only copies the two textures
+        SDL_Texture *previous = SDL_GetRenderTarget(renderer);
+        SDL_Texture *targets[] = {outgoing_, incoming_};
+        UI::Element *roots[] = {outgoing, incoming};
+        for (int i = 0; i < 2; ++i)
+        {
+            SDL_SetRenderTarget(renderer, targets[i]);
+            SDL_SetRenderDrawColor(renderer, background.r, background.g, background.b, 255);
+            SDL_RenderClear(renderer);
+            if (roots[i])
+            {
+                roots[i]->render(renderer);
+            }
+        }
+        SDL_SetRenderTarget(renderer, previous);
+        return true;
+    }
+
+    bool SceneStack::render(SDL_Renderer *renderer) const
+    {
+        if (!transitioning_)
+        {
+            return false;
+        }
+
+        const Request &request = requests_.front();
+        float t = UI::ease(UI::Easing::EaseInOut, std::min(elapsed_ / request.duration, 1.0f));
+        int width = snapshotWidth_;
+        int offset = static_cast<int>(t * width);
+        SDL_Rect full = {0, 0, width, snapshotHeight_};
+
+        // Snapshots are opaque, only the fading one needs blending
+        SDL_SetTextureBlendMode(outgoing_, SDL_BLENDMODE_NONE);
+        SDL_SetTextureBlendMode(incoming_, SDL_BLENDMODE_NONE);
+        SDL_SetTextureAlphaMod(incoming_, 255);
+
+        switch (request.transition)
+        {
+        case SceneTransition::Fade:
+            SDL_RenderCopy(renderer, outgoing_, nullptr, &full);
+            SDL_SetTextureBlendMode(incoming_, SDL_BLENDMODE_BLEND);
+            SDL_SetTextureAlphaMod(incoming_, static_cast<Uint8>(t * 255.0f));
+            SDL_RenderCopy(renderer, incoming_, nullptr, &full);
+            break;
+        case SceneTransition::SlideLeft:
+        {
+            SDL_Rect out = {-offset, 0, width, snapshotHeight_};
+            SDL_Rect in = {width - offset, 0, width, snapshotHeight_};
+            SDL_RenderCopy(renderer, outgoing_, nullptr, &out);
+            SDL_RenderCopy(renderer, incoming_, nullptr, &in);
+            break;
+        }
+        case SceneTransition::SlideRight:
+        {
+            SDL_Rect out = {offset, 0, width, snapshotHeight_};
+            SDL_Rect in = {offset - width, 0, width, snapshotHeight_};
+            SDL_RenderCopy(renderer, outgoing_, nullptr, &out);
+            SDL_RenderCopy(renderer, incoming_, nullptr, &in);
+            break;
+        }
+        case SceneTransition::None:
+            SDL_RenderCopy(renderer, incoming_, nullptr, &full);
+            break;
+        }
+        return true;
+    }
+
+    void SceneStack::clear()
+    {
+        // A scene created for a transition in progress goes too; the others were never created
+        bool topIsLive = !transitioning_;
+        for (Request &request : requests_)
+        {
+            if (request.scene && request.scene->root_)
+            {
+                destroy(*request.scene);
+            }
+            else if (request.scene)
+            {
+                request.scene->resources_.reset();
+            }
+        }
+        requests_.clear();
+        transitioning_ = false;
+
+        // Covered scenes got onExit() when they were covered
+        while (!stack_.empty())
+        {
+            ScenePtr scene = stack_.back();
+            stack_.pop_back();
+            if (topIsLive)
+            {
+                scene->onExit();
+                topIsLive = false;
+            }
+            destroy(*scene);
+        }
+        releaseSnapshots();
+    }
+
+    void SceneStack::releaseSnapshots()
+    {
+        if (outgoing_)
+        {
+            SDL_DestroyTexture(outgoing_);
+            outgoing_ = nullptr;
+        }
+        if (incoming_)
+        {
+            SDL_DestroyTexture(incoming_);
+            incoming_ = nullptr;
+        }
+        snapshotWidth_ = 0;
+        snapshotHeight_ = 0;
+    }
+
+} // namespace TG5040
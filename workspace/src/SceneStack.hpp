@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ConstraintLayout.hpp"
+#include "ResourceManager.hpp"
+#include "StyleSheet.hpp"
+#include <SDL2/SDL.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace TG5040
+{
+
+    // How the incoming scene replaces the outgoing one
+    enum class SceneTransition
+    {
+        None,
+        Fade,       // Cross-fade
+        SlideLeft,  // Incoming enters from the right
+        SlideRight  // Incoming enters from the left
+    };
+
+    // One screen of the app, e.g. a menu or the game itself. Subclass it and push it onto the
+    // Application's scene stack.
+    class Scene
+    {
+    public:
+        explicit Scene(const std::string &name = "scene") : name_(name) {}
+        virtual ~Scene() = default;
+
+        // Files decoded on the ResourceManager worker before onCreate(), while the current
+        // scene is still on screen
+        virtual std::vector<ResourceRequest> resources() const { return {}; }
+
+        // Builds the element tree on the main thread once resources() are loaded
+        virtual UI::ElementPtr onCreate() = 0;
+
+        virtual void onEnter() {}   // Now the live scene, after its transition
+        virtual void onExit() {}    // No longer live: covered by another scene or being removed
+        virtual void onDestroy() {} // Removed from the stack, the tree is released after this
+        virtual void onUpdate(float /*deltaTime*/) {}
+        virtual bool onEvent(const SDL_Event &/*event*/) { return false; }
+
+        const std::string &getName() const { return name_; }
+        UI::ElementPtr getRoot() const { return root_; }
+        const PreloadGroupPtr &getResources() const { return resources_; }
+
+    private:
+        std::string name_;
+        UI::ElementPtr root_;       // Kept while the scene is on the stack, covered or not
+        PreloadGroupPtr resources_; // Keeps the preloaded resources resident
+        friend class SceneStack;
+    };
+
+    using ScenePtr = std::shared_ptr<Scene>;
+
+    // Push, pop and replace, one at a time in the order they were requested.
+    //
+    // A pushed scene starts preloading its resources() right away. The current scene stays live
+    // until they are loaded; then the new scene is built and laid out, both scenes are rendered
+    // once into two snapshot textures, and the transition composites those instead of rendering
+    // two live trees. Covered scenes keep their trees, so popping back needs no rebuild. Without
+    // render target support transitions are cuts.
+    class SceneStack
+    {
+    public:
+        static constexpr float DEFAULT_DURATION = 0.25f; // Seconds
+
+        SceneStack() = default;
+        SceneStack(const SceneStack &) = delete;
+        SceneStack &operator=(const SceneStack &) = delete;
+
+        void push(ScenePtr scene, SceneTransition transition = SceneTransition::Fade, float duration = DEFAULT_DURATION);
+        void replace(ScenePtr scene, SceneTransition transition = SceneTransition::Fade, float duration = DEFAULT_DURATION);
+        void pop(SceneTransition transition = SceneTransition::Fade, float duration = DEFAULT_DURATION);
+
+        // The live scene, null while the stack is empty
+        ScenePtr top() const { return stack_.empty() ? nullptr : stack_.back(); }
+        size_t size() const { return stack_.size(); }
+
+        // Requests waiting for resources or in their transition
+        bool isBusy() const { return !requests_.empty(); }
+        bool isTransitioning() const { return transitioning_; }
+
+        // Once per frame, after ResourceManager::update(): starts the next request once its
+        // scene is loaded and advances the transition. True when top() changed.
+        bool update(float deltaTime, UI::StyleSheet *styleSheet, const UI::Color &background);
+
+        // Draws the transition into the current frame, false when there is none
+        bool render(SDL_Renderer *renderer) const;
+
+        // Destroys every scene and the snapshot textures, before the renderer goes away
+        void clear();
+
+    private:
+        enum class Operation
+        {
+            Push,
+            Replace,
+            Pop
+        };
+
+        struct Request
+        {
+            Operation operation;
+            ScenePtr scene; // Null for Pop
+            SceneTransition transition;
+            float duration;
+        };
+
+        std::vector<ScenePtr> stack_;
+        std::deque<Request> requests_; // The front one is in progress
+
+        bool transitioning_ = false;
+        float elapsed_ = 0.0f;
+
+        // Reused by every transition, recreated when the render size changes
+        SDL_Texture *outgoing_ = nullptr;
+        SDL_Texture *incoming_ = nullptr;
+        int snapshotWidth_ = 0;
+        int snapshotHeight_ = 0;
+        bool snapshotsUnsupported_ = false;
+
+        void request(Operation operation, ScenePtr scene, SceneTransition transition, float duration);
+        bool begin(Request &request, UI::StyleSheet *styleSheet, const UI::Color &background);
+        void finish(Request &request);
+        static void destroy(Scene &scene);
+        static void layout(UI::Element *root, UI::StyleSheet *styleSheet);
+        bool takeSnapshots(UI::Element *outgoing, UI::Element *incoming, const UI::Color &background);
+        void releaseSnapshots();
+    };
+
+} // namespace TG5040
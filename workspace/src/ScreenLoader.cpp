@@ -0,0 +1,227 @@
+#define TG5040_LOG_CATEGORY Layout
+#include "ScreenLoader.hpp"
+#include "UIFormat.hpp"
+#include "Logger.hpp"
+#include "ResourceManager.hpp"
+#include <cstring>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        namespace
+        {
+            Color unpackColor(uint32_t packed)
+            {
+                return Color(static_cast<uint8_t>(packed >> 24), static_cast<uint8_t>(packed >> 16),
+                             static_cast<uint8_t>(packed >> 8), static_cast<uint8_t>(packed));
+            }
+
+            const char *stringAt(const char *table, uint32_t size, uint32_t offset)
+            {
+                if (offset == UIFormat::NO_STRING || offset >= size)
+                {
+                    return nullptr;
+                }
+                return table + offset;
+            }
+        } // namespace
+
+        ElementPtr Screen::find(const std::string &id) const
+        {
+            auto it = ids_.find(id);
+            return it != ids_.end() ? it->second : nullptr;
+        }
+
+        ScreenPtr ScreenLoader::load(const std::string &path)
+        {
+            // Packed screens are instantiated straight from the archive mapping
+            const uint8_t *packed = nullptr;
+            size_t packedSize = 0;
+            if (ResourceManager::getInstance().findData(path, packed, packedSize))
+            {
+                ScreenPtr screen = loadFromMemory(packed, packedSize);
+                if (screen)
+                {
+                    LOG_INFO("Loaded screen %s (%zu elements)", path.c_str(), screen->elements().size());
+                }
+                return screen;
+            }
+
+            SDL_RWops *rw = SDL_RWFromFile(path.c_str(), "rb");
+            if (!rw)
+            {
+                LOG_ERROR("Failed to open screen %s: %s", path.c_str(), SDL_GetError());
+                return nullptr;
+            }
+
+            Sint64 size = SDL_RWsize(rw);
+            std::vector<uint8_t> data(size > 0 ? static_cast<size_t>(size) : 0);
+            size_t read = data.empty() ? 0 : SDL_RWread(rw, data.data(), 1, data.size());
+            SDL_RWclose(rw);
+
+            if (read != data.size() || data.empty())
+            {
+                LOG_ERROR("Failed to read screen %s", path.c_str());
+                return nullptr;
+            }
+
+            ScreenPtr screen = loadFromMemory(data.data(), data.size());
+            if (screen)
+            {
+                LOG_INFO("Loaded screen %s (%zu elements)", path.c_str(), screen->elements().size());
+            }
+            return screen;
+        }
+
+        ScreenPtr ScreenLoader::loadFromMemory(const uint8_t *data, size_t size)
+        {
+            using namespace UIFormat;
+
+            if (!data || size < sizeof(Header))
+            {
+                LOG_ERROR("Screen blob too small");
+                return nullptr;
+            }
+
+            Header header;
+            std::memcpy(&header, data, sizeof(header));
+            if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+            {
+                LOG_ERROR("Invalid screen blob (bad magic or version %u)", header.version);
+                return nullptr;
+            }
+
+            size_t elementsOffset = sizeof(Header);
+            size_t constraintsOffset = elementsOffset + header.elementCount * sizeof(ElementRecord);
+            size_t stringsOffset = constraintsOffset + header.constraintCount * sizeof(ConstraintRecord);
+            if (header.elementCount == 0 || stringsOffset + header.stringTableSize > size)
+            {
+                LOG_ERROR("Screen blob truncated");
+                return nullptr;
+            }
+
+            const auto *elements = reinterpret_cast<const ElementRecord *>(data + elementsOffset);
+            const auto *constraints = reinterpret_cast<const ConstraintRecord *>(data + constraintsOffset);
+            const char *strings = reinterpret_cast<const char *>(data + stringsOffset);
+
+            auto screen = std::make_shared<Screen>();
+            screen->elements_.reserve(header.elementCount);
+            screen->ids_.reserve(header.elementCount);
+
+            for (uint16_t i = 0; i < header.elementCount; ++i)
+            {
+                const ElementRecord &record = elements[i];
+                const char *text = stringAt(strings, header.stringTableSize, record.text);
+                const char *font = stringAt(strings, header.stringTableSize, record.font);
+                int fontSize = record.fontSize > 0 ? record.fontSize : 16;
+
+                ElementPtr element;
+                switch (record.type)
+                {
+                case TYPE_CONTAINER:
+                    element = std::make_shared<Container>();
+                    break;
+                case TYPE_TEXT:
+                {
+                    auto label = std::make_shared<Text>(text ? text : "", fontSize);
+                    if (font)
+                    {
+                        label->setFontPath(font);
+                    }
+                    if (record.flags & FLAG_TEXT_COLOR)
+                    {
+                        label->setTextColor(unpackColor(record.textColor));
+                    }
+                    element = label;
+                    break;
+                }
+                case TYPE_BUTTON:
+                    element = std::make_shared<Button>(text ? text : "");
+                    break;
+                case TYPE_IMAGE:
+                    element = std::make_shared<Image>(text ? text : "");
+                    break;
+                default:
+                    element = std::make_shared<Element>();
+                    break;
+                }
+
+                if (record.flags & FLAG_BACKGROUND)
+                {
+                    element->backgroundColor = unpackColor(record.backgroundColor);
+                }
+                if (record.flags & FLAG_BORDER_COLOR)
+                {
+                    element->borderColor = unpackColor(record.borderColor);
+                }
+                element->borderWidth = record.borderWidth;
+                element->opacity = record.opacity;
+                element->focusable = (record.flags & FLAG_FOCUSABLE) != 0;
+                element->focusScope = (record.flags & FLAG_FOCUS_SCOPE) != 0;
+                element->userInteractionEnabled = (record.flags & FLAG_NO_INTERACTION) == 0;
+
+                if (const char *id = stringAt(strings, header.stringTableSize, record.id))
+                {
+                    element->setId(id);
+                    screen->ids_[id] = element;
+                }
+
+                if (const char *classes = stringAt(strings, header.stringTableSize, record.classes))
+                {
+                    std::string names(classes);
+                    size_t start = 0;
+                    while (start < names.size())
+                    {
+                        size_t end = names.find(' ', start);
+                        if (end == std::string::npos)
+                            end = names.size();
+                        if (end > start)
+                            element->addClass(names.substr(start, end - start));
+                        start = end + 1;
+                    }
+                }
+
+                if (i > 0)
+                {
+                    if (record.parent < 0 || record.parent >= i)
+                    {
+                        LOG_ERROR("Screen blob element %u has invalid parent %d", i, record.parent);
+                        return nullptr;
+                    }
+                    element->translatesAutoresizingMaskIntoConstraints = false;
+                    screen->elements_[record.parent]->addChild(element);
+                }
+
+                screen->elements_.push_back(element);
+            }
+
+            for (uint16_t i = 0; i < header.constraintCount; ++i)
+            {
+                const ConstraintRecord &record = constraints[i];
+                if (record.firstItem >= header.elementCount || record.secondItem >= header.elementCount ||
+                    record.firstAttribute > ATTR_TRAILING || record.secondAttribute > ATTR_TRAILING ||
+                    record.relation > REL_GREATER_OR_EQUAL)
+                {
+                    LOG_ERROR("Screen blob constraint %u is invalid", i);
+                    return nullptr;
+                }
+
+                Element *first = screen->elements_[record.firstItem].get();
+                Element *second = record.secondItem >= 0 ? screen->elements_[record.secondItem].get() : nullptr;
+
+                auto constraint = std::make_shared<Constraint>(
+                    first, static_cast<ConstraintAttribute>(record.firstAttribute),
+                    static_cast<ConstraintRelation>(record.relation),
+                    second, static_cast<ConstraintAttribute>(record.secondAttribute),
+                    record.multiplier, record.constant);
+                constraint->priority = static_cast<LayoutPriority>(record.priority);
+                first->addConstraint(constraint);
+            }
+
+            return screen;
+        }
+
+    } // namespace UI
+} // namespace TG5040
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ConstraintLayout.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        // An element tree instantiated from a compiled UI definition
+        class Screen
+        {
+        public:
+            ElementPtr root() const { return elements_.empty() ? nullptr : elements_.front(); }
+
+            ElementPtr find(const std::string &id) const;
+
+            template <typename T>
+            std::shared_ptr<T> find(const std::string &id) const
+            {
+                return std::dynamic_pointer_cast<T>(find(id));
+            }
+
+            const std::vector<ElementPtr> &elements() const { return elements_; }
+
+        private:
+            friend class ScreenLoader;
+
+            std::vector<ElementPtr> elements_;
+            std::unordered_map<std::string, ElementPtr> ids_;
+        };
+
+        using ScreenPtr = std::shared_ptr<Screen>;
+
+        // Instantiates screens from .uib blobs produced by tools/uic at build time.
+        // The blob is read in one go and turned into elements without any text parsing.
+        class ScreenLoader
+        {
+        public:
+            static ScreenPtr load(const std::string &path);
+            static ScreenPtr loadFromMemory(const uint8_t *data, size_t size);
+        };
+
+    } // namespace UI
+} // namespace TG5040
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace TG5040
+{
+
+    // Bounded lock-free queue for exactly one producer thread and one consumer thread.
+    // push() and pop() never block or allocate; push() fails when the queue is full.
+    template <typename T, size_t Capacity>
+    class SpscQueue
+    {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        // Producer side
+        bool push(const T &item)
+        {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_.load(std::memory_order_acquire) == Capacity)
+            {
+                return false;
+            }
+            items_[tail & (Capacity - 1)] = item;
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side
+        bool pop(T &item)
+        {
+            size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            item = items_[head & (Capacity - 1)];
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Approximate when called while the other side is active
+        size_t size() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+        bool empty() const { return size() == 0; }
+        static constexpr size_t capacity() { return Capacity; }
+
+    private:
+        // Producer and consumer indices on separate cache lines
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+        alignas(64) T items_[Capacity];
+    };
+
+    // Lock-free ring of trivially copyable values for one writer and one reader thread,
+    // moved in bulk (e.g. PCM samples from a decoder thread to the audio callback).
+    template <typename T>
+    class SpscRingBuffer
+    {
+    public:
+        // Capacity is rounded up to a power of two
+        explicit SpscRingBuffer(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity)
+            {
+                size <<= 1;
+            }
+            items_.resize(size);
+        }
+
+        // Writer side, returns how many values fit
+        size_t write(const T *data, size_t count)
+        {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            count = std::min(count, items_.size() - (tail - head_.load(std::memory_order_acquire)));
+            copyIn(tail, data, count);
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        // Reader side, returns how many values were read
+        size_t read(T *data, size_t count)
+        {
+            size_t head = head_.load(std::memory_order_relaxed);
+            count = std::min(count, tail_.load(std::memory_order_acquire) - head);
+            copyOut(head, data, count);
+            head_.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        // Approximate when called while the other side is active
+        size_t available() const { return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire); }
+        size_t space() const { return items_.size() - available(); }
+        size_t capacity() const { return items_.size(); }
+
+    private:
+        alignas(64) std::atomic<size_t> head_{0};
+        alignas(64) std::atomic<size_t> tail_{0};
+        std::vector<T> items_;
+
+        void copyIn(size_t position, const T *data, size_t count)
+        {
+            size_t start = position & (items_.size() - 1);
+            size_t first = std::min(count, items_.size() - start);
+            std::memcpy(items_.data() + start, data, first * sizeof(T));
+            std::memcpy(items_.data(), data + first, (count - first) * sizeof(T));
+        }
+
+        void copyOut(size_t position, T *data, size_t count) const
+        {
+            size_t start = position & (items_.size() - 1);
+            size_t first = std::min(count, items_.size() - start);
+            std::memcpy(data, items_.data() + start, first * sizeof(T));
+            std::memcpy(data + first, items_.data(), (count - first) * sizeof(T));
+        }
+    };
+
+} // namespace TG5040
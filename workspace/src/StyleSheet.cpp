@@ -0,0 +1,634 @@
+#define TG5040_LOG_CATEGORY Layout
+#include "StyleSheet.hpp"
+#include "Logger.hpp"
+#include "ResourceManager.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        namespace
+        {
+            std::string trim(const std::string &s)
+            {
+                size_t begin = 0;
+                size_t end = s.size();
+                while (begin < end && std::isspace(static_cast<unsigned char>(s[begin])))
+                    ++begin;
+                while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1])))
+                    --end;
+                return s.substr(begin, end - begin);
+            }
+
+            std::string lower(std::string s)
+            {
+                for (auto &c : s)
+                {
+                    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                }
+                return s;
+            }
+
+            bool isNameChar(char c)
+            {
+                return std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '_';
+            }
+
+            bool parseColor(const std::string &value, Color &color)
+            {
+                std::string v = lower(trim(value));
+
+                if (!v.empty() && v[0] == '#')
+                {
+                    std::string hex = v.substr(1);
+                    if (hex.size() == 3)
+                    {
+                        hex = {hex[0], hex[0], hex[1], hex[1], hex[2], hex[2]};
+                    }
+                    if (hex.size() != 6 && hex.size() != 8)
+                    {
+                        return false;
+                    }
+                    char *end = nullptr;
+                    unsigned long packed = std::strtoul(hex.c_str(), &end, 16);
+                    if (*end != '\0')
+                    {
+                        return false;
+                    }
+                    if (hex.size() == 6)
+                    {
+                        packed = (packed << 8) | 0xFF;
+                    }
+                    color = Color(static_cast<uint8_t>(packed >> 24), static_cast<uint8_t>(packed >> 16),
+                                  static_cast<uint8_t>(packed >> 8), static_cast<uint8_t>(packed));
+                    return true;
+                }
+
+                if (v.compare(0, 4, "rgb(") == 0 || v.compare(0, 5, "rgba(") == 0)
+                {
+                    float c[4] = {0, 0, 0, 1};
+                    int n = std::sscanf(v.c_str() + v.find('(') + 1, "%f , %f , %f , %f", &c[0], &c[1], &c[2], &c[3]);
+                    if (n < 3)
+                    {
+                        return false;
+                    }
+                    color = Color(static_cast<uint8_t>(c[0]), static_cast<uint8_t>(c[1]), static_cast<uint8_t>(c[2]),
+                                  static_cast<uint8_t>(std::min(std::max(c[3], 0.0f), 1.0f) * 255.0f));
+                    return true;
+                }
+
+                static const std::unordered_map<std::string, Color> named = {
+                    {"white", Color::white()}, {"black", Color::black()}, {"red", Color::red()},
+                    {"green", Color::green()}, {"blue", Color::blue()}, {"transparent", Color::transparent()}};
+                auto it = named.find(v);
+                if (it != named.end())
+                {
+                    color = it->second;
+                    return true;
+                }
+                return false;
+            }
+
+            bool parseNumber(const std::string &value, float &number)
+            {
+                std::string v = trim(value);
+                char *end = nullptr;
+                number = std::strtof(v.c_str(), &end);
+                if (end == v.c_str())
+                {
+                    return false;
+                }
+                std::string unit = trim(end);
+                return unit.empty() || unit == "px";
+            }
+        } // namespace
+
+        uint32_t StyleSheet::intern(const std::string &name)
+        {
+            // 0 is reserved for "no name"
+            static std::unordered_map<std::string, uint32_t> names;
+            if (name.empty())
+            {
+                return 0;
+            }
+            auto it = names.find(name);
+            if (it != names.end())
+            {
+                return it->second;
+            }
+            uint32_t id = static_cast<uint32_t>(names.size()) + 1;
+            names.emplace(name, id);
+            return id;
+        }
+
+        bool StyleSheet::loadFromFile(const std::string &path)
+        {
+            SDL_RWops *rw = ResourceManager::getInstance().openFile(path);
+            if (!rw)
+            {
+                LOG_ERROR("Failed to open stylesheet %s: %s", path.c_str(), SDL_GetError());
+                return false;
+            }
+
+            Sint64 size = SDL_RWsize(rw);
+            std::string source(size > 0 ? static_cast<size_t>(size) : 0, '\0');
+            size_t read = source.empty() ? 0 : SDL_RWread(rw, &source[0], 1, source.size());
+            SDL_RWclose(rw);
+
+            if (read != source.size())
+            {
+                LOG_ERROR("Failed to read stylesheet %s", path.c_str());
+                return false;
+            }
+
+            if (!parse(source))
+            {
+                LOG_ERROR("Failed to parse stylesheet %s", path.c_str());
+                return false;
+            }
+
+            LOG_INFO("Loaded stylesheet %s (%zu rules)", path.c_str(), rules_.size());
+            return true;
+        }
+
+        bool StyleSheet::parse(const std::string &input)
+        {
+            // Strip comments
+            std::string source;
+            source.reserve(input.size());
+            for (size_t i = 0; i < input.size(); ++i)
+            {
+                if (input[i] == '/' && i + 1 < input.size() && input[i + 1] == '*')
+                {
+                    size_t end = input.find("*/", i + 2);
+                    if (end == std::string::npos)
+                    {
+                        break;
+                    }
+                    i = end + 1;
+                    continue;
+                }
+                source += input[i];
+            }
+
+            bool ok = true;
+            size_t pos = 0;
+            while (pos < source.size())
+            {
+                size_t open = source.find('{', pos);
+                if (open == std::string::npos)
+                {
+                    if (!trim(source.substr(pos)).empty())
+                    {
+                        LOG_WARN("Stylesheet: trailing text without a block");
+                        ok = false;
+                    }
+                    break;
+                }
+                size_t close = source.find('}', open);
+                if (close == std::string::npos)
+                {
+                    LOG_WARN("Stylesheet: unterminated block");
+                    ok = false;
+                    break;
+                }
+
+                std::string selectors = source.substr(pos, open - pos);
+                std::string body = source.substr(open + 1, close - open - 1);
+                pos = close + 1;
+
+                ComputedStyle declarations;
+                if (!parseDeclarations(body, declarations))
+                {
+                    ok = false;
+                }
+
+                // A selector list shares the declarations
+                size_t start = 0;
+                while (start <= selectors.size())
+                {
+                    size_t comma = selectors.find(',', start);
+                    std::string selector = trim(selectors.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+                    start = comma == std::string::npos ? selectors.size() + 1 : comma + 1;
+
+                    if (selector.empty())
+                    {
+                        continue;
+                    }
+
+                    Rule rule;
+                    rule.declarations = declarations;
+                    rule.order = static_cast<uint32_t>(rules_.size());
+                    if (parseSelector(selector, rule))
+                    {
+                        rules_.push_back(std::move(rule));
+                    }
+                    else
+                    {
+                        LOG_WARN("Stylesheet: invalid selector '%s'", selector.c_str());
+                        ok = false;
+                    }
+                }
+            }
+
+            index();
+            styleCache_.clear();
+            return ok;
+        }
+
+        bool StyleSheet::parseSelector(const std::string &text, Rule &rule)
+        {
+            uint32_t ids = 0, classes = 0, tags = 0;
+            bool childOf = false;
+            size_t i = 0;
+
+            while (i < text.size())
+            {
+                while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i])))
+                    ++i;
+                if (i < text.size() && text[i] == '>')
+                {
+                    childOf = true;
+                    ++i;
+                    continue;
+                }
+                if (i >= text.size())
+                    break;
+
+                Compound compound;
+                compound.childOf = childOf;
+                childOf = false;
+
+                bool any = false;
+                while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i])) && text[i] != '>')
+                {
+                    char prefix = text[i];
+                    if (prefix == '*')
+                    {
+                        ++i;
+                        any = true;
+                        continue;
+                    }
+
+                    size_t start = (prefix == '.' || prefix == '#' || prefix == ':') ? i + 1 : i;
+                    size_t end = start;
+                    while (end < text.size() && isNameChar(text[end]))
+                        ++end;
+                    if (end == start)
+                    {
+                        return false;
+                    }
+                    std::string name = text.substr(start, end - start);
+                    i = end;
+                    any = true;
+
+                    if (prefix == '.')
+                    {
+                        compound.classes.push_back(intern(name));
+                        ++classes;
+                    }
+                    else if (prefix == '#')
+                    {
+                        compound.id = intern(name);
+                        ++ids;
+                    }
+                    else if (prefix == ':')
+                    {
+                        std::string state = lower(name);
+                        if (state == "pressed" || state == "active")
+                            compound.states |= static_cast<uint32_t>(ElementState::Pressed);
+                        else if (state == "focused" || state == "focus")
+                            compound.states |= static_cast<uint32_t>(ElementState::Focused);
+                        else if (state == "disabled")
+                            compound.states |= static_cast<uint32_t>(ElementState::Disabled);
+                        else
+                            return false;
+                        ++classes;
+                    }
+                    else
+                    {
+                        compound.tag = intern(name);
+                        ++tags;
+                    }
+                }
+
+                if (!any)
+                {
+                    return false;
+                }
+                rule.compounds.push_back(std::move(compound));
+            }
+
+            if (rule.compounds.empty() || rule.compounds.front().childOf)
+            {
+                return false;
+            }
+
+            if (rule.compounds.size() > 1)
+            {
+                hasCombinators_ = true;
+            }
+
+            rule.specificity = (std::min(ids, 255u) << 16) | (std::min(classes, 255u) << 8) | std::min(tags, 255u);
+            return true;
+        }
+
+        bool StyleSheet::parseDeclarations(const std::string &text, ComputedStyle &style)
+        {
+            bool ok = true;
+            size_t pos = 0;
+            while (pos < text.size())
+            {
+                size_t semi = text.find(';', pos);
+                std::string declaration = text.substr(pos, semi == std::string::npos ? std::string::npos : semi - pos);
+                pos = semi == std::string::npos ? text.size() : semi + 1;
+
+                size_t colon = declaration.find(':');
+                if (trim(declaration).empty())
+                {
+                    continue;
+                }
+                if (colon == std::string::npos)
+                {
+                    ok = false;
+                    continue;
+                }
+
+                std::string property = lower(trim(declaration.substr(0, colon)));
+                std::string value = trim(declaration.substr(colon + 1));
+                float number = 0.0f;
+                bool valid = true;
+
+                if (property == "background-color" || property == "background")
+                {
+                    valid = parseColor(value, style.backgroundColor);
+                    style.mask |= ComputedStyle::BackgroundColor;
+                }
+                else if (property == "border-color")
+                {
+                    valid = parseColor(value, style.borderColor);
+                    style.mask |= ComputedStyle::BorderColor;
+                }
+                else if (property == "border-width")
+                {
+                    valid = parseNumber(value, style.borderWidth);
+                    style.mask |= ComputedStyle::BorderWidth;
+                }
+                else if (property == "opacity")
+                {
+                    valid = parseNumber(value, style.opacity);
+                    style.mask |= ComputedStyle::Opacity;
+                }
+                else if (property == "color")
+                {
+                    valid = parseColor(value, style.textColor);
+                    style.mask |= ComputedStyle::TextColor;
+                }
+                else if (property == "font-size")
+                {
+                    valid = parseNumber(value, number);
+                    style.fontSize = static_cast<int>(number);
+                    style.mask |= ComputedStyle::FontSize;
+                }
+                else if (property == "font-family" || property == "font")
+                {
+                    style.fontPath = value;
+                    if (style.fontPath.size() >= 2 && (style.fontPath.front() == '"' || style.fontPath.front() == '\''))
+                    {
+                        style.fontPath = style.fontPath.substr(1, style.fontPath.size() - 2);
+                    }
+                    style.mask |= ComputedStyle::FontPath;
+                }
+                else if (property == "border-radius" || property == "corner-radius")
+                {
+                    valid = parseNumber(value, style.cornerRadius);
+                    style.mask |= ComputedStyle::CornerRadius;
+                }
+                else
+                {
+                    LOG_WARN("Stylesheet: unsupported property '%s'", property.c_str());
+                    continue;
+                }
+
+                if (!valid)
+                {
+                    LOG_WARN("Stylesheet: invalid value '%s' for %s", value.c_str(), property.c_str());
+                    ok = false;
+                }
+            }
+            return ok;
+        }
+
+        void StyleSheet::index()
+        {
+            byId_.clear();
+            byClass_.clear();
+            byTag_.clear();
+            universal_.clear();
+
+            for (uint32_t i = 0; i < rules_.size(); ++i)
+            {
+                const Compound &key = rules_[i].compounds.back();
+                if (key.id)
+                    byId_[key.id].push_back(i);
+                else if (!key.classes.empty())
+                    byClass_[key.classes.front()].push_back(i);
+                else if (key.tag)
+                    byTag_[key.tag].push_back(i);
+                else
+                    universal_.push_back(i);
+            }
+        }
+
+        bool StyleSheet::matchesCompound(const Compound &compound, const Element *element)
+        {
+            if (compound.tag && compound.tag != element->tagId_)
+                return false;
+            if (compound.id && compound.id != element->idId_)
+                return false;
+            if ((element->state_ & compound.states) != compound.states)
+                return false;
+            for (uint32_t cls : compound.classes)
+            {
+                if (std::find(element->classIds_.begin(), element->classIds_.end(), cls) == element->classIds_.end())
+                    return false;
+            }
+            return true;
+        }
+
+        bool StyleSheet::matches(const Rule &rule, const Element *element) const
+        {
+            int index = static_cast<int>(rule.compounds.size()) - 1;
+            if (!matchesCompound(rule.compounds[index], element))
+            {
+                return false;
+            }
+
+            // Walk ancestors for the remaining compounds (greedy, right to left)
+            const Element *current = element;
+            while (--index >= 0)
+            {
+                bool childOf = rule.compounds[index + 1].childOf;
+                const Element *ancestor = current->parent();
+                while (ancestor && !matchesCompound(rule.compounds[index], ancestor))
+                {
+                    if (childOf)
+                    {
+                        return false;
+                    }
+                    ancestor = ancestor->parent();
+                }
+                if (!ancestor)
+                {
+                    return false;
+                }
+                current = ancestor;
+            }
+            return true;
+        }
+
+        ComputedStylePtr StyleSheet::resolve(const Element *element)
+        {
+            matched_.clear();
+
+            auto collect = [&](const std::vector<uint32_t> &candidates)
+            {
+                for (uint32_t index : candidates)
+                {
+                    if (matches(rules_[index], element))
+                    {
+                        matched_.push_back(index);
+                    }
+                }
+            };
+
+            if (element->idId_)
+            {
+                auto it = byId_.find(element->idId_);
+                if (it != byId_.end())
+                    collect(it->second);
+            }
+            for (uint32_t cls : element->classIds_)
+            {
+                auto it = byClass_.find(cls);
+                if (it != byClass_.end())
+                    collect(it->second);
+            }
+            auto tag = byTag_.find(element->tagId_);
+            if (tag != byTag_.end())
+            {
+                collect(tag->second);
+            }
+            collect(universal_);
+
+            if (matched_.empty())
+            {
+                return nullptr;
+            }
+
+            // Cascade order: specificity, then source order
+            std::sort(matched_.begin(), matched_.end(), [this](uint32_t a, uint32_t b)
+                      {
+                          const Rule &ra = rules_[a];
+                          const Rule &rb = rules_[b];
+                          return ra.specificity != rb.specificity ? ra.specificity < rb.specificity : ra.order < rb.order; });
+            matched_.erase(std::unique(matched_.begin(), matched_.end()), matched_.end());
+
+            // Elements matching the same rules share one computed style
+            auto cached = styleCache_.find(matched_);
+            if (cached != styleCache_.end())
+            {
+                return cached->second;
+            }
+
+            auto style = std::make_shared<ComputedStyle>();
+            for (uint32_t index : matched_)
+            {
+                const ComputedStyle &d = rules_[index].declarations;
+                if (d.has(ComputedStyle::BackgroundColor))
+                    style->backgroundColor = d.backgroundColor;
+                if (d.has(ComputedStyle::BorderColor))
+                    style->borderColor = d.borderColor;
+                if (d.has(ComputedStyle::BorderWidth))
+                    style->borderWidth = d.borderWidth;
+                if (d.has(ComputedStyle::Opacity))
+                    style->opacity = d.opacity;
+                if (d.has(ComputedStyle::TextColor))
+                    style->textColor = d.textColor;
+                if (d.has(ComputedStyle::FontSize))
+                    style->fontSize = d.fontSize;
+                if (d.has(ComputedStyle::FontPath))
+                    style->fontPath = d.fontPath;
+                if (d.has(ComputedStyle::CornerRadius))
+                    style->cornerRadius = d.cornerRadius;
+                style->mask |= d.mask;
+            }
+
+            styleCache_.emplace(matched_, style);
+            return style;
+        }
+
+        bool StyleSheet::apply(Element *root)
+        {
+            return root ? applyTree(root, false) : false;
+        }
+
+        bool StyleSheet::applyTree(Element *element, bool force)
+        {
+            bool changed = false;
+            bool dirty = force || element->styleDirty_;
+
+            if (dirty)
+            {
+                ComputedStylePtr style = resolve(element);
+                // Matching nothing now, the element still gets back what earlier rules changed
+                bool restore = !style && element->unstyled_ && element->unstyled_->mask;
+                if (style != element->computedStyle_ || restore)
+                {
+                    static const ComputedStyle unmatched;
+                    element->computedStyle_ = style;
+                    element->applyStyle(style ? *style : unmatched);
+                    changed = true;
+                }
+                element->styleDirty_ = false;
+            }
+
+            if (dirty || element->childNeedsStyle_)
+            {
+                // Descendant selectors may depend on this element, so restyle the subtree
+                bool forceChildren = dirty && hasCombinators_;
+                for (auto &child : element->children())
+                {
+                    if (forceChildren || child->styleDirty_ || child->childNeedsStyle_)
+                    {
+                        changed = applyTree(child.get(), forceChildren) || changed;
+                    }
+                }
+                element->childNeedsStyle_ = false;
+            }
+
+            return changed;
+        }
+
+        void StyleSheet::invalidate(Element *root)
+        {
+            if (!root)
+            {
+                return;
+            }
+            root->computedStyle_.reset();
+            root->styleDirty_ = true;
+            root->childNeedsStyle_ = true;
+            for (auto &child : root->children())
+            {
+                invalidate(child.get());
+            }
+        }
+
+    } // namespace UI
+} // namespace TG5040
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ConstraintLayout.hpp"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        // Resolved style values. Only properties whose bit is set in `mask` are applied.
+        struct ComputedStyle
+        {
+            enum Property : uint32_t
+            {
+                BackgroundColor = 1 << 0,
+                BorderColor = 1 << 1,
+                BorderWidth = 1 << 2,
+                Opacity = 1 << 3,
+                TextColor = 1 << 4,
+                FontSize = 1 << 5,
+                FontPath = 1 << 6,
+                CornerRadius = 1 << 7
+            };
+
+            uint32_t mask = 0;
+            Color backgroundColor;
+            Color borderColor;
+            float borderWidth = 0.0f;
+            float opacity = 1.0f;
+            Color textColor;
+            int fontSize = 16;
+            std::string fontPath;
+            float cornerRadius = 0.0f;
+
+            bool has(Property property) const { return (mask & property) != 0; }
+        };
+
+        using ComputedStylePtr = std::shared_ptr<const ComputedStyle>;
+
+        // CSS-like stylesheet. Supports tag, .class, #id and :pressed / :focused / :disabled
+        // selectors, descendant (space) and child (>) combinators, and specificity ordering.
+        // Elements matching the same set of rules share one ComputedStyle object, and only
+        // elements whose classes or state changed are re-matched. A property no matching rule sets
+        // any more goes back to the element's own value.
+        class StyleSheet
+        {
+        public:
+            StyleSheet() = default;
+
+            bool loadFromFile(const std::string &path);
+            bool parse(const std::string &source);
+
+            // Resolve styles for dirty elements in the tree, returns true if any element changed
+            bool apply(Element *root);
+
+            // Force every element to be re-matched on the next apply
+            void invalidate(Element *root);
+
+            size_t ruleCount() const { return rules_.size(); }
+            size_t sharedStyleCount() const { return styleCache_.size(); }
+
+            // Intern tag / class / id names so matching compares integers
+            static uint32_t intern(const std::string &name);
+
+        private:
+            struct Compound
+            {
+                uint32_t tag = 0; // 0 = any
+                uint32_t id = 0;  // 0 = any
+                std::vector<uint32_t> classes;
+                uint32_t states = 0;
+                bool childOf = false; // Combinator to the compound on the left is '>'
+            };
+
+            struct Rule
+            {
+                std::vector<Compound> compounds; // Left to right
+                uint32_t specificity = 0;
+                uint32_t order = 0;
+                ComputedStyle declarations;
+            };
+
+            std::vector<Rule> rules_;
+            bool hasCombinators_ = false;
+
+            // Rules bucketed by the rightmost compound's most selective key
+            std::unordered_map<uint32_t, std::vector<uint32_t>> byId_;
+            std::unordered_map<uint32_t, std::vector<uint32_t>> byClass_;
+            std::unordered_map<uint32_t, std::vector<uint32_t>> byTag_;
+            std::vector<uint32_t> universal_;
+
+            std::map<std::vector<uint32_t>, ComputedStylePtr> styleCache_;
+            std::vector<uint32_t> matched_;
+
+            bool parseSelector(const std::string &text, Rule &rule);
+            bool parseDeclarations(const std::string &text, ComputedStyle &style);
+            void index();
+
+            bool matches(const Rule &rule, const Element *element) const;
+            static bool matchesCompound(const Compound &compound, const Element *element);
+
+            ComputedStylePtr resolve(const Element *element);
+            bool applyTree(Element *element, bool force);
+        };
+
+        using StyleSheetPtr = std::shared_ptr<StyleSheet>;
+
+    } // namespace UI
+} // namespace TG5040
@@ -0,0 +1,328 @@
+#include "TextLayout.hpp"
+#include "SDLManager.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        namespace
+        {
+            const char ELLIPSIS[] = "...";
+
+            // Ideographic scripts can break between any two characters
+            bool breaksAnywhere(uint32_t cp)
+            {
+                return (cp >= 0x2E80 && cp <= 0x9FFF) || (cp >= 0xAC00 && cp <= 0xD7AF) ||
+                       (cp >= 0xF900 && cp <= 0xFAFF) || (cp >= 0xFF00 && cp <= 0xFFEF);
+            }
+
+            int lineStep(int lineHeight, float lineSpacing)
+            {
+                return static_cast<int>(std::lround(lineHeight * lineSpacing));
+            }
+        } // namespace
+
+        void TextLayout::setText(const std::string &text)
+        {
+            if (text == text_ && !paragraphs_.empty())
+            {
+                return;
+            }
+
+            text_ = text;
+            paragraphs_.clear();
+            laidOutWidth_ = -1;
+
+            size_t start = 0;
+            while (true)
+            {
+                size_t end = text_.find('\n', start);
+                Paragraph paragraph;
+                paragraph.start = static_cast<uint32_t>(start);
+                paragraph.length = static_cast<uint32_t>((end == std::string::npos ? text_.size() : end) - start);
+                paragraphs_.push_back(paragraph);
+                if (end == std::string::npos)
+                {
+                    break;
+                }
+                start = end + 1;
+            }
+        }
+
+        void TextLayout::setFont(FontId font)
+        {
+            if (font == font_)
+            {
+                return;
+            }
+
+            font_ = font;
+            laidOutWidth_ = -1;
+            for (auto &paragraph : paragraphs_)
+            {
+                paragraph.naturalWidth = -1;
+                paragraph.breakWidth = -1;
+                paragraph.lines.clear();
+            }
+        }
+
+        const std::vector<TextLine> &TextLayout::layout(int maxWidth, int maxLines, bool ellipsis)
+        {
+            maxWidth = std::max(maxWidth, 0);
+            maxLines = std::max(maxLines, 0);
+
+            if (lineHeight_ > 0 && maxWidth == laidOutWidth_ && maxLines == laidOutMaxLines_ && ellipsis == laidOutEllipsis_)
+            {
+                return lines_;
+            }
+
+            FontCache &fonts = SDLManager::getInstance().getFontCache();
+            lines_.clear();
+            width_ = 0;
+
+            // Without metrics (font not available yet) nothing is cached, the next call retries
+            lineHeight_ = fonts.getLineHeight(font_);
+            if (lineHeight_ == 0)
+            {
+                return lines_;
+            }
+            ellipsisWidth_ = 3 * fonts.getAdvance(font_, '.');
+
+            // A single line is cut inside the line rather than wrapped
+            int wrapWidth = maxLines == 1 ? 0 : maxWidth;
+            bool truncated = false;
+
+            for (auto &paragraph : paragraphs_)
+            {
+                if (paragraph.naturalWidth < 0)
+                {
+                    int width = 0;
+                    const char *data = text_.data() + paragraph.start;
+                    for (size_t i = 0; i < paragraph.length;)
+                    {
+                        width += fonts.getAdvance(font_, FontCache::decodeUtf8(data, paragraph.length, i));
+                    }
+                    paragraph.naturalWidth = width;
+                }
+
+                if (wrapWidth == 0 || paragraph.naturalWidth <= wrapWidth)
+                {
+                    // Fits on one line, no need to look for breaks
+                    if (paragraph.lines.size() != 1 || paragraph.breakWidth != wrapWidth)
+                    {
+                        TextLine line;
+                        line.start = paragraph.start;
+                        line.length = paragraph.length;
+                        line.width = paragraph.naturalWidth;
+                        paragraph.lines.assign(1, line);
+                    }
+                    paragraph.breakWidth = wrapWidth;
+                }
+                else if (paragraph.breakWidth != wrapWidth)
+                {
+                    breakParagraph(fonts, paragraph, wrapWidth);
+                }
+
+                for (const auto &line : paragraph.lines)
+                {
+                    if (maxLines > 0 && static_cast<int>(lines_.size()) == maxLines)
+                    {
+                        truncated = true;
+                        break;
+                    }
+                    lines_.push_back(line);
+                }
+                if (truncated)
+                {
+                    break;
+                }
+            }
+
+            if (ellipsis && !lines_.empty())
+            {
+                if (truncated)
+                {
+                    ellipsize(fonts, lines_.back(), maxWidth);
+                }
+                for (auto &line : lines_)
+                {
+                    if (maxWidth > 0 && line.width > maxWidth && !line.ellipsis)
+                    {
+                        ellipsize(fonts, line, maxWidth);
+                    }
+                }
+            }
+
+            for (const auto &line : lines_)
+            {
+                width_ = std::max(width_, line.width);
+            }
+
+            laidOutWidth_ = maxWidth;
+            laidOutMaxLines_ = maxLines;
+            laidOutEllipsis_ = ellipsis;
+            return lines_;
+        }
+
+        void TextLayout::breakParagraph(FontCache &fonts, Paragraph &paragraph, int maxWidth)
+        {
+            paragraph.lines.clear();
+            paragraph.breakWidth = maxWidth;
+
+            const char *data = text_.data();
+            uint32_t end = paragraph.start + paragraph.length;
+
+            TextLine line;
+            line.start = paragraph.start;
+            int lineWidth = 0;
+
+            // Last break opportunity on the current line
+            uint32_t breakPos = 0;      // Where the next line starts
+            uint32_t breakLineEnd = 0;  // Where the current line ends (trailing spaces excluded)
+            int breakLineWidth = 0;     // Width up to breakLineEnd
+            int breakWidth = 0;         // Width up to breakPos
+            bool hasBreak = false;
+            bool afterSpace = false;
+
+            size_t i = paragraph.start;
+            while (i < end)
+            {
+                uint32_t cpStart = static_cast<uint32_t>(i);
+                uint32_t cp = FontCache::decodeUtf8(data, end, i);
+                int advance = fonts.getAdvance(font_, cp);
+                bool space = cp == ' ' || cp == '\t';
+
+                if (space)
+                {
+                    if (!afterSpace)
+                    {
+                        breakLineEnd = cpStart;
+                        breakLineWidth = lineWidth;
+                    }
+                    lineWidth += advance;
+                    breakPos = static_cast<uint32_t>(i);
+                    breakWidth = lineWidth;
+                    hasBreak = true;
+                    afterSpace = true;
+                    continue;
+                }
+
+                if (breaksAnywhere(cp) && cpStart > line.start && !afterSpace)
+                {
+                    breakLineEnd = breakPos = cpStart;
+                    breakLineWidth = breakWidth = lineWidth;
+                    hasBreak = true;
+                }
+                afterSpace = false;
+
+                if (lineWidth + advance > maxWidth && cpStart > line.start)
+                {
+                    if (hasBreak)
+                    {
+                        // Wrap at the last break, the rest of the word moves down
+                        line.length = breakLineEnd - line.start;
+                        line.width = breakLineWidth;
+                        paragraph.lines.push_back(line);
+                        line.start = breakPos;
+                        lineWidth -= breakWidth;
+                    }
+                    else
+                    {
+                        // A single word wider than the line is split
+                        line.length = cpStart - line.start;
+                        line.width = lineWidth;
+                        paragraph.lines.push_back(line);
+                        line.start = cpStart;
+                        lineWidth = 0;
+                    }
+                    hasBreak = false;
+
+                    if (breaksAnywhere(cp) && cpStart > line.start)
+                    {
+                        breakLineEnd = breakPos = cpStart;
+                        breakLineWidth = breakWidth = lineWidth;
+                        hasBreak = true;
+                    }
+                }
+
+                lineWidth += advance;
+            }
+
+            // Trailing spaces don't count towards the last line
+            line.length = (afterSpace ? breakLineEnd : end) - line.start;
+            line.width = afterSpace ? breakLineWidth : lineWidth;
+            paragraph.lines.push_back(line);
+        }
+
+        void TextLayout::ellipsize(FontCache &fonts, TextLine &line, int maxWidth)
+        {
+            int limit = maxWidth > 0 ? maxWidth - ellipsisWidth_ : INT_MAX;
+            const char *data = text_.data();
+            uint32_t end = line.start + line.length;
+
+            // Keep as many characters as fit in front of the ellipsis, without trailing spaces
+            uint32_t fitEnd = line.start;
+            int fitWidth = 0;
+            int width = 0;
+            size_t i = line.start;
+            while (i < end)
+            {
+                uint32_t cp = FontCache::decodeUtf8(data, end, i);
+                width += fonts.getAdvance(font_, cp);
+                if (width > limit)
+                {
+                    break;
+                }
+                if (cp != ' ' && cp != '\t')
+                {
+                    fitEnd = static_cast<uint32_t>(i);
+                    fitWidth = width;
+                }
+            }
+
+            line.length = fitEnd - line.start;
+            line.width = fitWidth + ellipsisWidth_;
+            line.ellipsis = true;
+        }
+
+        int TextLayout::height(float lineSpacing) const
+        {
+            if (lines_.empty())
+            {
+                return 0;
+            }
+            return lineHeight_ + static_cast<int>(lines_.size() - 1) * lineStep(lineHeight_, lineSpacing);
+        }
+
+        void TextLayout::draw(int x, int y, int boxWidth, TextAlignment alignment, float lineSpacing, SDL_Color color) const
+        {
+            FontCache &fonts = SDLManager::getInstance().getFontCache();
+            int step = lineStep(lineHeight_, lineSpacing);
+
+            for (const auto &line : lines_)
+            {
+                int lineX = x;
+                if (alignment == TextAlignment::Center)
+                {
+                    lineX += (boxWidth - line.width) / 2;
+                }
+                else if (alignment == TextAlignment::Right)
+                {
+                    lineX += boxWidth - line.width;
+                }
+
+                fonts.drawText(font_, text_.data() + line.start, line.length, lineX, y, color);
+                if (line.ellipsis)
+                {
+                    fonts.drawText(font_, ELLIPSIS, sizeof(ELLIPSIS) - 1, lineX + line.width - ellipsisWidth_, y, color);
+                }
+                y += step;
+            }
+        }
+
+    } // namespace UI
+} // namespace TG5040
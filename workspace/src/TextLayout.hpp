@@ -0,0 +1,83 @@
+#pragma once
+
+#include "FontCache.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace TG5040
+{
+    namespace UI
+    {
+
+        enum class TextAlignment
+        {
+            Left,
+            Center,
+            Right
+        };
+
+        // One laid out line, a byte range into the layout's text
+        struct TextLine
+        {
+            uint32_t start = 0;
+            uint32_t length = 0;
+            int width = 0;
+            bool ellipsis = false; // Draw "..." after the range
+        };
+
+        // UTF-8 paragraph layout: word wrap, alignment, line spacing and ellipsis truncation.
+        //
+        // Text is split into paragraphs at '\n'. Each paragraph remembers its unwrapped width and
+        // the breaks computed for the last width, so laying out again at the same width costs
+        // nothing and a resize only re-breaks paragraphs that wrapped before or no longer fit.
+        class TextLayout
+        {
+        public:
+            void setText(const std::string &text);
+            const std::string &text() const { return text_; }
+
+            void setFont(FontId font);
+            FontId font() const { return font_; }
+
+            // Compute lines for a width (0 = no wrapping) and line limit (0 = unlimited).
+            // With ellipsis enabled, text cut off by either limit ends in "...".
+            const std::vector<TextLine> &layout(int maxWidth, int maxLines = 0, bool ellipsis = true);
+
+            // Size of the last layout; lineSpacing multiplies the font's line height
+            int width() const { return width_; }
+            int height(float lineSpacing = 1.0f) const;
+            int lineHeight() const { return lineHeight_; }
+
+            // Draw the last layout inside a box of the given width
+            void draw(int x, int y, int boxWidth, TextAlignment alignment, float lineSpacing, SDL_Color color) const;
+
+        private:
+            struct Paragraph
+            {
+                uint32_t start = 0;
+                uint32_t length = 0;
+                int naturalWidth = -1; // Unwrapped width, -1 until measured
+                int breakWidth = -1;   // Width the cached lines were broken for
+                std::vector<TextLine> lines;
+            };
+
+            std::string text_;
+            FontId font_ = INVALID_FONT;
+            std::vector<Paragraph> paragraphs_;
+
+            // Result of the last layout call
+            std::vector<TextLine> lines_;
+            int laidOutWidth_ = -1;
+            int laidOutMaxLines_ = -1;
+            bool laidOutEllipsis_ = false;
+            int width_ = 0;
+            int lineHeight_ = 0;
+            int ellipsisWidth_ = 0;
+
+            void breakParagraph(FontCache &fonts, Paragraph &paragraph, int maxWidth);
+            void ellipsize(FontCache &fonts, TextLine &line, int maxWidth);
+        };
+
+    } // namespace UI
+} // namespace TG5040
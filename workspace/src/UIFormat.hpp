@@ -0,0 +1,111 @@
+#pragma once
+
+// Binary layout of compiled UI definition files (.uib).
+// Shared by the runtime loader and the host-side compiler (tools/uic.cpp),
+// so this header must not depend on SDL.
+
+#include <cstdint>
+
+namespace TG5040
+{
+    namespace UIFormat
+    {
+
+        constexpr char MAGIC[4] = {'T', 'G', 'U', 'I'};
+        constexpr uint16_t VERSION = 2;
+        constexpr uint32_t NO_STRING = 0xFFFFFFFFu;
+        constexpr int16_t NO_ELEMENT = -1;
+
+        enum ElementType : uint8_t
+        {
+            TYPE_CONTAINER = 0,
+            TYPE_TEXT,
+            TYPE_BUTTON,
+            TYPE_IMAGE,
+            TYPE_ELEMENT
+        };
+
+        enum ElementFlags : uint16_t
+        {
+            FLAG_FOCUSABLE = 1 << 0,
+            FLAG_FOCUS_SCOPE = 1 << 1,
+            FLAG_NO_INTERACTION = 1 << 2,
+            FLAG_BACKGROUND = 1 << 3,
+            FLAG_BORDER_COLOR = 1 << 4,
+            FLAG_TEXT_COLOR = 1 << 5,
+            FLAG_FONT_SIZE = 1 << 6
+        };
+
+        // Matches UI::ConstraintAttribute / UI::ConstraintRelation ordering
+        enum Attribute : uint8_t
+        {
+            ATTR_LEFT = 0,
+            ATTR_RIGHT,
+            ATTR_TOP,
+            ATTR_BOTTOM,
+            ATTR_WIDTH,
+            ATTR_HEIGHT,
+            ATTR_CENTER_X,
+            ATTR_CENTER_Y,
+            ATTR_LEADING,
+            ATTR_TRAILING
+        };
+
+        enum Relation : uint8_t
+        {
+            REL_EQUAL = 0,
+            REL_LESS_OR_EQUAL,
+            REL_GREATER_OR_EQUAL
+        };
+
+        struct Header
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t elementCount;
+            uint16_t constraintCount;
+            uint16_t reserved;
+            uint32_t stringTableSize;
+        };
+
+        // Elements are stored in pre-order, a parent always precedes its children
+        struct ElementRecord
+        {
+            uint8_t type;
+            uint8_t reserved;
+            uint16_t flags;
+            int16_t parent;
+            uint16_t fontSize;
+            uint32_t id;   // String table offsets
+            uint32_t text; // Text content, button title or image path
+            uint32_t font;
+            uint32_t classes; // Space separated style classes
+            uint32_t backgroundColor; // Packed 0xRRGGBBAA
+            uint32_t borderColor;
+            uint32_t textColor;
+            float borderWidth;
+            float opacity;
+        };
+
+        struct ConstraintRecord
+        {
+            uint16_t firstItem;
+            int16_t secondItem; // NO_ELEMENT for constant constraints
+            uint8_t firstAttribute;
+            uint8_t secondAttribute;
+            uint8_t relation;
+            uint8_t reserved;
+            float multiplier;
+            float constant;
+            uint16_t priority;
+            uint16_t reserved2;
+        };
+
+        static_assert(sizeof(Header) == 16, "UI header layout changed");
+        static_assert(sizeof(ElementRecord) == 44, "UI element record layout changed");
+        static_assert(sizeof(ConstraintRecord) == 20, "UI constraint record layout changed");
+
+        // File layout: Header, ElementRecord[elementCount], ConstraintRecord[constraintCount], string table
+
+    } // namespace UIFormat
+} // namespace TG5040
@@ -1,7 +1,9 @@
 #include "Application.hpp"
+#include "Animator.hpp"
 #include "ConstraintLayout.hpp"
 #include "ControllerManager.hpp"
 #include "Logger.hpp"
+#include "ScreenLoader.hpp"
 #include <memory>
 
 using namespace TG5040;
@@ -55,6 +57,7 @@ private:
     bool exitScheduled_ = false;
     float exitTimer_ = 0.0f;
 
+    ScreenPtr screen_;
     std::shared_ptr<Container> mainContainer_;
     std::shared_ptr<Text> titleText_;
     std::shared_ptr<Text> countdownText_;
@@ -66,13 +69,6 @@ private:
     {
         auto &controller = ControllerManager::getInstance();
 
-        // A button - restart countdown
-        controller.onButtonPressed(GamepadButton::A, [this]() 
-        {
-            LOG_INFO("Controller A button pressed - restarting countdown");
-            restartCountdown(); 
-        });
-
         // B button - quit app
         controller.onButtonPressed(GamepadButton::B, [this]()
         {
@@ -80,133 +76,65 @@ private:
             quit(); 
         });
 
-        // DPAD for navigation (example)
-        controller.onButtonPressed(GamepadButton::DPAD_UP, [this]() { LOG_INFO("DPAD UP pressed"); });
-
-        controller.onButtonPressed(GamepadButton::DPAD_DOWN, [this]() { LOG_INFO("DPAD DOWN pressed"); });
+        // DPAD moves focus between the buttons and A activates the focused one,
+        // both handled by the Application focus manager
 
         // Log all button events for debugging
         controller.onButtonEvent([](GamepadButton button, ButtonState state)
         {
             const char* stateStr = (state == ButtonState::Pressed) ? "pressed" : "released";
-            LOG_DEBUG("Controller button %d %s", static_cast<int>(button), stateStr); 
+            LOGC_DEBUG(Input, "Controller button %d %s", static_cast<int>(button), stateStr); 
         });
     }
 
     void createUserInterface()
     {
-        // Create main container (root view)
-        mainContainer_ = std::make_shared<Container>();
-        mainContainer_->backgroundColor = Color(30, 30, 30); // Dark background
-
-        // Create title text
-        titleText_ = std::make_shared<Text>("TG5040 Constraint Demo", 36);
-        titleText_->setTextColor(Color::white());
-        titleText_->backgroundColor = Color(50, 50, 100, 100); // Semi-transparent blue
-
-        // Create countdown text
-        countdownText_ = std::make_shared<Text>("10", 72);
-        countdownText_->setTextColor(Color(51, 102, 255));    // Blue
-        countdownText_->backgroundColor = Color(0, 0, 0, 50); // Semi-transparent black
-
-        // Create instruction text
-        instructionText_ = std::make_shared<Text>("A: Restart | B: Quit | SPACE: Restart", 18);
-        instructionText_->setTextColor(Color(200, 200, 200)); // Light gray
-
-        // Create restart button
-        restartButton_ = std::make_shared<Button>("Restart (A)");
-        restartButton_->backgroundColor = Color(76, 175, 80); // Green
+        // The screen layout lives in ui/main.ui and is compiled to res/main.uib at build time
+        screen_ = ScreenLoader::load("res/main.uib");
+        if (!screen_)
+        {
+            LOG_FATAL("Failed to load main screen");
+            return;
+        }
+
+        mainContainer_ = screen_->find<Container>("main");
+        titleText_ = screen_->find<Text>("title");
+        countdownText_ = screen_->find<Text>("countdown");
+        instructionText_ = screen_->find<Text>("instruction");
+        restartButton_ = screen_->find<Button>("restart");
+        quitButton_ = screen_->find<Button>("quit");
+
+        if (!mainContainer_ || !countdownText_ || !restartButton_ || !quitButton_)
+        {
+            LOG_FATAL("Main screen is missing required elements");
+            screen_.reset();
+            return;
+        }
+
         restartButton_->setOnClick([this]()
                                    { restartCountdown(); });
-
-        // Create quit button
-        quitButton_ = std::make_shared<Button>("Quit (B)");
-        quitButton_->backgroundColor = Color(244, 67, 54); // Red
         quitButton_->setOnClick([this]()
                                 { quit(); });
 
-        // Add children to container
-        mainContainer_->addChild(titleText_);
-        mainContainer_->addChild(countdownText_);
-        mainContainer_->addChild(instructionText_);
-        mainContainer_->addChild(restartButton_);
-        mainContainer_->addChild(quitButton_);
-
-        // Setup constraints - iOS Auto Layout style
-        setupLayoutConstraints();
-
         // Set as root element
         setRootElement(mainContainer_);
-    }
 
-    void setupLayoutConstraints()
-    {
-        // Disable autoresizing mask translation for constraint-based layout
-        titleText_->translatesAutoresizingMaskIntoConstraints = false;
-        countdownText_->translatesAutoresizingMaskIntoConstraints = false;
-        instructionText_->translatesAutoresizingMaskIntoConstraints = false;
-        restartButton_->translatesAutoresizingMaskIntoConstraints = false;
-        quitButton_->translatesAutoresizingMaskIntoConstraints = false;
-
-        // Title text constraints - centered horizontally, 150pt from top
-        auto titleCenterX = std::make_shared<Constraint>(
-            titleText_.get(), ConstraintAttribute::CenterX, ConstraintRelation::Equal,
-            mainContainer_.get(), ConstraintAttribute::CenterX, 1.0f, 0.0f);
-        auto titleTop = std::make_shared<Constraint>(
-            titleText_.get(), ConstraintAttribute::Top, ConstraintRelation::Equal,
-            mainContainer_.get(), ConstraintAttribute::Top, 1.0f, 150.0f);
-        titleText_->addConstraints({titleCenterX, titleTop});
-
-        // Countdown text constraints - centered both ways
-        auto countdownCenterX = std::make_shared<Constraint>(
-            countdownText_.get(), ConstraintAttribute::CenterX, ConstraintRelation::Equal,
-            mainContainer_.get(), ConstraintAttribute::CenterX, 1.0f, 0.0f);
-        auto countdownCenterY = std::make_shared<Constraint>(
-            countdownText_.get(), ConstraintAttribute::CenterY, ConstraintRelation::Equal,
-            mainContainer_.get(), ConstraintAttribute::CenterY, 1.0f, 0.0f);
-        countdownText_->addConstraints({countdownCenterX, countdownCenterY});
-
-        // Instruction text constraints - centered horizontally, 100pt from bottom
-        auto instructionCenterX = std::make_shared<Constraint>(
-            instructionText_.get(), ConstraintAttribute::CenterX, ConstraintRelation::Equal,
-            mainContainer_.get(), ConstraintAttribute::CenterX, 1.0f, 0.0f);
-        auto instructionBottom = std::make_shared<Constraint>(
-            instructionText_.get(), ConstraintAttribute::Bottom, ConstraintRelation::Equal,
-            mainContainer_.get(), ConstraintAttribute::Bottom, 1.0f, -100.0f);
-        instructionText_->addConstraints({instructionCenterX, instructionBottom});
-
-        // Button constraints - side by side, centered horizontally as a group
-        auto restartWidth = std::make_shared<Constraint>(
-            restartButton_.get(), ConstraintAttribute::Width, ConstraintRelation::Equal,
-            nullptr, ConstraintAttribute::Width, 1.0f, 150.0f);
-        auto restartHeight = std::make_shared<Constraint>(
-            restartButton_.get(), ConstraintAttribute::Height, ConstraintRelation::Equal,
-            nullptr, ConstraintAttribute::Height, 1.0f, 50.0f);
-        auto restartRight = std::make_shared<Constraint>(
-            restartButton_.get(), ConstraintAttribute::Right, ConstraintRelation::Equal,
-            mainContainer_.get(), ConstraintAttribute::CenterX, 1.0f, -10.0f);
-        auto restartBottom = std::make_shared<Constraint>(
-            restartButton_.get(), ConstraintAttribute::Bottom, ConstraintRelation::Equal,
-            instructionText_.get(), ConstraintAttribute::Top, 1.0f, -20.0f);
-        restartButton_->addConstraints({restartWidth, restartHeight, restartRight, restartBottom});
-
-        auto quitWidth = std::make_shared<Constraint>(
-            quitButton_.get(), ConstraintAttribute::Width, ConstraintRelation::Equal,
-            nullptr, ConstraintAttribute::Width, 1.0f, 150.0f);
-        auto quitHeight = std::make_shared<Constraint>(
-            quitButton_.get(), ConstraintAttribute::Height, ConstraintRelation::Equal,
-            nullptr, ConstraintAttribute::Height, 1.0f, 50.0f);
-        auto quitLeft = std::make_shared<Constraint>(
-            quitButton_.get(), ConstraintAttribute::Left, ConstraintRelation::Equal,
-            mainContainer_.get(), ConstraintAttribute::CenterX, 1.0f, 10.0f);
-        auto quitBottom = std::make_shared<Constraint>(
-            quitButton_.get(), ConstraintAttribute::Bottom, ConstraintRelation::Equal,
-            instructionText_.get(), ConstraintAttribute::Top, 1.0f, -20.0f);
-        quitButton_->addConstraints({quitWidth, quitHeight, quitLeft, quitBottom});
+        // Button colors and pressed/focused variants come from the stylesheet
+        auto styles = std::make_shared<StyleSheet>();
+        if (styles->loadFromFile("res/styles.css"))
+        {
+            setStyleSheet(styles);
+        }
     }
 
     void updateCountdown(float deltaTime)
     {
+        if (!screen_)
+        {
+            quit();
+            return;
+        }
+
         if (countdownTime_ > 0)
         {
             Uint32 currentTime = SDL_GetTicks();
@@ -242,6 +170,11 @@ private:
 
     void restartCountdown()
     {
+        if (!screen_)
+        {
+            return;
+        }
+
         LOG_INFO("Restarting countdown");
         countdownTime_ = 10.0f;
         startTime_ = SDL_GetTicks();
@@ -254,6 +187,12 @@ private:
         countdownText_->setText("10");
         countdownText_->setTextColor(Color(51, 102, 255)); // Blue
         countdownText_->setFontSize(72);
+
+        // Fade the countdown back in
+        auto &animator = Animator::getInstance();
+        animator.cancelAll(countdownText_.get());
+        countdownText_->opacity = 0.0f;
+        animator.animateOpacity(countdownText_, 1.0f, 0.4f, Easing::EaseOut);
     }
 };
 
@@ -0,0 +1,132 @@
+// Asset packer - packs resource files into one archive that AssetArchive maps at runtime,
+// so the device reads a single file instead of many small ones from the SD card.
+// Runs on the build host: assetpack <output.pack> <file | path=file>...
+//
+//   assetpack .build/pack/res.pack res/aller.ttf res/main.uib=.build/res/main.uib
+//
+// A plain argument is stored under the path as given; path=file stores the file found at
+// file under path. Stored paths must match the paths used at runtime.
+
+#include "AssetArchiveFormat.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace TG5040::AssetArchiveFormat;
+
+namespace
+{
+    [[noreturn]] void fail(const std::string &message)
+    {
+        std::cerr << "assetpack: " << message << std::endl;
+        std::exit(1);
+    }
+
+    struct File
+    {
+        std::string path;
+        std::vector<char> data;
+        Entry entry;
+    };
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: assetpack <output.pack> <file | path=file>..." << std::endl;
+        return 1;
+    }
+
+    std::string outputPath = argv[1];
+    std::vector<File> files;
+
+    for (int arg = 2; arg < argc; ++arg)
+    {
+        std::string spec = argv[arg];
+        size_t equals = spec.find('=');
+        std::string path = equals == std::string::npos ? spec : spec.substr(0, equals);
+        std::string source = equals == std::string::npos ? spec : spec.substr(equals + 1);
+
+        auto duplicate = std::find_if(files.begin(), files.end(), [&path](const File &file)
+                                      { return file.path == path; });
+        if (duplicate != files.end())
+        {
+            fail("duplicate path '" + path + "'");
+        }
+
+        std::ifstream in(source, std::ios::binary);
+        if (!in)
+        {
+            fail("cannot read " + source);
+        }
+
+        File file;
+        file.path = path;
+        file.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        file.entry.hash = hashPath(path.data(), path.size());
+        files.push_back(std::move(file));
+    }
+
+    std::sort(files.begin(), files.end(), [](const File &a, const File &b)
+              { return a.entry.hash != b.entry.hash ? a.entry.hash < b.entry.hash : a.path < b.path; });
+
+    std::vector<char> strings;
+    for (auto &file : files)
+    {
+        file.entry.path = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), file.path.begin(), file.path.end());
+        strings.push_back('\0');
+    }
+
+    // Assign data offsets after the table
+    size_t offset = sizeof(Header) + files.size() * sizeof(Entry) + strings.size();
+    for (auto &file : files)
+    {
+        offset = (offset + DATA_ALIGNMENT - 1) & ~static_cast<size_t>(DATA_ALIGNMENT - 1);
+        if (offset + file.data.size() > UINT32_MAX)
+        {
+            fail("archive exceeds 4 GB");
+        }
+        file.entry.offset = static_cast<uint32_t>(offset);
+        file.entry.size = static_cast<uint32_t>(file.data.size());
+        offset += file.data.size();
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.reserved = 0;
+    header.entryCount = static_cast<uint32_t>(files.size());
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out)
+    {
+        fail("cannot write " + outputPath);
+    }
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const auto &file : files)
+    {
+        out.write(reinterpret_cast<const char *>(&file.entry), sizeof(Entry));
+    }
+    out.write(strings.data(), strings.size());
+
+    for (const auto &file : files)
+    {
+        std::streamoff position = out.tellp();
+        static const char padding[DATA_ALIGNMENT] = {};
+        out.write(padding, file.entry.offset - position);
+        out.write(file.data.data(), file.data.size());
+    }
+
+    std::cout << "assetpack: wrote " << outputPath << " (" << files.size() << " files, " << offset / 1024 << " KB)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,300 @@
+// Font atlas baker - pre-renders glyph pages of selected fonts into a .atlas file that
+// FontCache maps at runtime instead of rasterizing through FreeType on the device.
+// Runs on the build host: fontbake [-p first-last] <output.atlas> <font.ttf:size[,size...]>...
+//
+//   fontbake .build/res/fonts.atlas res/aller.ttf:18,36,72
+//
+// Font paths are stored exactly as given and must match the paths used at runtime.
+// Pages hold 128 consecutive codepoints; the default range 0-1 covers ASCII and Latin-1.
+// Glyphs outside the baked pages are still rendered live by SDL_ttf.
+
+#include "FontAtlasFormat.hpp"
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace TG5040::FontAtlasFormat;
+
+namespace
+{
+    constexpr int PAGE_WIDTH = 512; // Same row width as FontCache
+
+    [[noreturn]] void fail(const std::string &message)
+    {
+        std::cerr << "fontbake: " << message << std::endl;
+        std::exit(1);
+    }
+
+    struct BakedPage
+    {
+        PageRecord record;
+        GlyphRecord glyphs[GLYPHS_PER_PAGE];
+        std::vector<uint8_t> pixels;
+    };
+
+    void encodeUtf8(uint32_t cp, char *out)
+    {
+        if (cp < 0x80)
+        {
+            out[0] = static_cast<char>(cp);
+            out[1] = '\0';
+        }
+        else if (cp < 0x800)
+        {
+            out[0] = static_cast<char>(0xC0 | (cp >> 6));
+            out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+            out[2] = '\0';
+        }
+        else
+        {
+            out[0] = static_cast<char>(0xE0 | (cp >> 12));
+            out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+            out[3] = '\0';
+        }
+    }
+
+    // Mirrors FontCache::buildPage so baked and live pages look the same
+    bool bakePage(TTF_Font *font, uint16_t fontIndex, uint32_t page, BakedPage &result)
+    {
+        const SDL_Color white = {255, 255, 255, 255};
+        SDL_Surface *surfaces[GLYPHS_PER_PAGE] = {};
+
+        std::memset(result.glyphs, 0, sizeof(result.glyphs));
+        int penX = 0, penY = 0, rowHeight = 0, atlasWidth = 0;
+
+        for (uint32_t i = 0; i < GLYPHS_PER_PAGE; ++i)
+        {
+            uint32_t cp = (page << PAGE_SHIFT) | i;
+            if (cp < 32 || cp > 0xFFFF || (cp >= 0xD800 && cp <= 0xDFFF) || !TTF_GlyphIsProvided(font, static_cast<Uint16>(cp)))
+            {
+                continue;
+            }
+
+            int minx, maxx, miny, maxy, advance;
+            if (TTF_GlyphMetrics(font, static_cast<Uint16>(cp), &minx, &maxx, &miny, &maxy, &advance) != 0)
+            {
+                continue;
+            }
+
+            GlyphRecord &glyph = result.glyphs[i];
+            glyph.advance = static_cast<int16_t>(advance);
+            glyph.offsetX = static_cast<int16_t>(std::min(minx, 0));
+
+            char utf8[4];
+            encodeUtf8(cp, utf8);
+            SDL_Surface *surface = TTF_RenderUTF8_Blended(font, utf8, white);
+            if (!surface)
+            {
+                continue;
+            }
+
+            if (penX > 0 && penX + surface->w > PAGE_WIDTH)
+            {
+                penX = 0;
+                penY += rowHeight + 1;
+                rowHeight = 0;
+            }
+
+            glyph.x = static_cast<uint16_t>(penX);
+            glyph.y = static_cast<uint16_t>(penY);
+            glyph.w = static_cast<uint16_t>(surface->w);
+            glyph.h = static_cast<uint16_t>(surface->h);
+
+            penX += surface->w + 1;
+            rowHeight = std::max(rowHeight, surface->h);
+            atlasWidth = std::max(atlasWidth, penX);
+            surfaces[i] = surface;
+        }
+
+        int atlasHeight = penY + rowHeight;
+        result.record.font = fontIndex;
+        result.record.page = static_cast<uint16_t>(page);
+        result.record.width = static_cast<uint16_t>(atlasWidth);
+        result.record.height = static_cast<uint16_t>(atlasHeight);
+        result.record.pixelOffset = 0;
+
+        if (atlasWidth == 0 || atlasHeight == 0)
+        {
+            return false;
+        }
+
+        SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (!atlas)
+        {
+            fail(std::string("cannot create atlas surface: ") + SDL_GetError());
+        }
+        SDL_FillRect(atlas, nullptr, 0);
+
+        for (uint32_t i = 0; i < GLYPHS_PER_PAGE; ++i)
+        {
+            if (!surfaces[i])
+            {
+                continue;
+            }
+            SDL_Rect dst = {result.glyphs[i].x, result.glyphs[i].y, surfaces[i]->w, surfaces[i]->h};
+            SDL_SetSurfaceBlendMode(surfaces[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(surfaces[i], nullptr, atlas, &dst);
+            SDL_FreeSurface(surfaces[i]);
+        }
+
+        // Store tightly packed rows so the runtime can upload straight from the mapping
+        size_t rowBytes = static_cast<size_t>(atlasWidth) * 4;
+        result.pixels.resize(rowBytes * atlasHeight);
+        SDL_LockSurface(atlas);
+        for (int y = 0; y < atlasHeight; ++y)
+        {
+            std::memcpy(result.pixels.data() + y * rowBytes, static_cast<uint8_t *>(atlas->pixels) + y * atlas->pitch, rowBytes);
+        }
+        SDL_UnlockSurface(atlas);
+        SDL_FreeSurface(atlas);
+        return true;
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint32_t firstPage = 0, lastPage = 1;
+    int arg = 1;
+
+    if (arg + 1 < argc && std::strcmp(argv[arg], "-p") == 0)
+    {
+        if (std::sscanf(argv[arg + 1], "%u-%u", &firstPage, &lastPage) != 2 || lastPage < firstPage || lastPage > 0xFFFF >> PAGE_SHIFT)
+        {
+            fail(std::string("invalid page range '") + argv[arg + 1] + "'");
+        }
+        arg += 2;
+    }
+
+    if (argc - arg < 2)
+    {
+        std::cerr << "usage: fontbake [-p first-last] <output.atlas> <font.ttf:size[,size...]>..." << std::endl;
+        return 1;
+    }
+
+    std::string outputPath = argv[arg++];
+
+    if (TTF_Init() < 0)
+    {
+        fail(std::string("TTF_Init failed: ") + TTF_GetError());
+    }
+
+    std::vector<FontRecord> fonts;
+    std::vector<BakedPage> pages;
+    std::vector<char> strings;
+
+    for (; arg < argc; ++arg)
+    {
+        std::string spec = argv[arg];
+        size_t colon = spec.rfind(':');
+        if (colon == std::string::npos)
+        {
+            fail("expected font.ttf:size, got '" + spec + "'");
+        }
+
+        std::string path = spec.substr(0, colon);
+        uint32_t pathOffset = static_cast<uint32_t>(strings.size());
+        strings.insert(strings.end(), path.begin(), path.end());
+        strings.push_back('\0');
+
+        std::string sizes = spec.substr(colon + 1);
+        size_t start = 0;
+        while (start < sizes.size())
+        {
+            size_t comma = sizes.find(',', start);
+            int size = std::atoi(sizes.substr(start, comma == std::string::npos ? std::string::npos : comma - start).c_str());
+            start = comma == std::string::npos ? sizes.size() : comma + 1;
+            if (size <= 0)
+            {
+                fail("invalid size in '" + spec + "'");
+            }
+
+            TTF_Font *font = TTF_OpenFont(path.c_str(), size);
+            if (!font)
+            {
+                fail("cannot open " + path + ": " + TTF_GetError());
+            }
+
+            FontRecord record;
+            record.path = pathOffset;
+            record.size = static_cast<uint16_t>(size);
+            record.height = static_cast<int16_t>(TTF_FontHeight(font));
+            record.ascent = static_cast<int16_t>(TTF_FontAscent(font));
+            record.reserved = 0;
+
+            uint16_t fontIndex = static_cast<uint16_t>(fonts.size());
+            fonts.push_back(record);
+
+            size_t baked = 0;
+            for (uint32_t page = firstPage; page <= lastPage; ++page)
+            {
+                BakedPage result;
+                if (bakePage(font, fontIndex, page, result))
+                {
+                    pages.push_back(std::move(result));
+                    ++baked;
+                }
+            }
+            TTF_CloseFont(font);
+
+            std::cout << "fontbake: " << path << " " << size << "px, " << baked << " pages" << std::endl;
+        }
+    }
+
+    TTF_Quit();
+
+    // Assign pixel offsets after the metadata
+    size_t offset = sizeof(Header) + fonts.size() * sizeof(FontRecord) + pages.size() * sizeof(PageRecord) +
+                    pages.size() * GLYPHS_PER_PAGE * sizeof(GlyphRecord) + strings.size();
+    for (auto &page : pages)
+    {
+        offset = (offset + PIXEL_ALIGNMENT - 1) & ~static_cast<size_t>(PIXEL_ALIGNMENT - 1);
+        page.record.pixelOffset = static_cast<uint32_t>(offset);
+        offset += page.pixels.size();
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.fontCount = static_cast<uint16_t>(fonts.size());
+    header.pageCount = static_cast<uint32_t>(pages.size());
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if (!out)
+    {
+        fail("cannot write " + outputPath);
+    }
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(fonts.data()), fonts.size() * sizeof(FontRecord));
+    for (const auto &page : pages)
+    {
+        out.write(reinterpret_cast<const char *>(&page.record), sizeof(PageRecord));
+    }
+    for (const auto &page : pages)
+    {
+        out.write(reinterpret_cast<const char *>(page.glyphs), sizeof(page.glyphs));
+    }
+    out.write(strings.data(), strings.size());
+
+    for (const auto &page : pages)
+    {
+        std::streamoff position = out.tellp();
+        static const char padding[PIXEL_ALIGNMENT] = {};
+        out.write(padding, page.record.pixelOffset - position);
+        out.write(reinterpret_cast<const char *>(page.pixels.data()), page.pixels.size());
+    }
+
+    std::cout << "fontbake: wrote " << outputPath << " (" << fonts.size() << " fonts, " << pages.size() << " pages, "
+              << offset / 1024 << " KB)" << std::endl;
+    return 0;
+}
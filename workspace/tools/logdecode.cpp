@@ -0,0 +1,381 @@
+// Binary log decoder - turns a log written with LogOutput::Binary, or a flight recorder file,
+// back into the text lines the Logger would have printed. Runs on the build host:
+//
+//   logdecode <file.logb | file.flight>
+//
+// Format strings come from the site entries of a binary log or from the flight recorder
+// slots, and the arguments are formatted here with the host's printf, one conversion at a time.
+
+#include "BinaryLogFormat.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace TG5040::BinaryLogFormat;
+
+namespace
+{
+    [[noreturn]] void fail(const std::string &message)
+    {
+        std::cerr << "logdecode: " << message << std::endl;
+        std::exit(1);
+    }
+
+    const char *levelName(uint8_t level)
+    {
+        static const char *names[] = {"DEBUG", "INFO ", "WARN ", "ERROR", "FATAL"};
+        return level < 5 ? names[level] : "UNKNOWN";
+    }
+
+    struct Site
+    {
+        uint8_t level = 0;
+        uint32_t line = 0;
+        std::string file;
+        std::string format;
+    };
+
+    // Reads the tagged arguments of one record in order, integers widened to 64 bits
+    class ArgReader
+    {
+    public:
+        ArgReader(const char *data, size_t size) : data_(data), size_(size) {}
+
+        bool next(uint8_t &tag, uint64_t &bits, std::string &text)
+        {
+            if (position_ >= size_)
+            {
+                return false;
+            }
+            tag = static_cast<uint8_t>(data_[position_++]);
+            if (tag == ARG_STRING)
+            {
+                uint16_t length = 0;
+                if (position_ + sizeof(length) > size_)
+                {
+                    return false;
+                }
+                std::memcpy(&length, data_ + position_, sizeof(length));
+                position_ += sizeof(length);
+                length = static_cast<uint16_t>(std::min<size_t>(length, size_ - position_));
+                text.assign(data_ + position_, length);
+                position_ += length;
+                return true;
+            }
+            if (tag == ARG_INT || tag == ARG_UINT)
+            {
+                uint32_t value = 0;
+                if (position_ + sizeof(value) > size_)
+                {
+                    return false;
+                }
+                std::memcpy(&value, data_ + position_, sizeof(value));
+                position_ += sizeof(value);
+                bits = tag == ARG_INT ? static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(value))) : value;
+                return true;
+            }
+            if (position_ + sizeof(bits) > size_)
+            {
+                return false;
+            }
+            std::memcpy(&bits, data_ + position_, sizeof(bits));
+            position_ += sizeof(bits);
+            return true;
+        }
+
+    private:
+        const char *data_;
+        size_t size_;
+        size_t position_ = 0;
+    };
+
+    // Formats one conversion (spec holds flags, width and precision, length modifiers removed)
+    void formatArg(std::string &out, std::string spec, char conversion, uint8_t tag, uint64_t bits, const std::string &text)
+    {
+        char buffer[512];
+        int64_t signedValue;
+        double floatValue;
+        std::memcpy(&signedValue, &bits, sizeof(bits));
+        std::memcpy(&floatValue, &bits, sizeof(bits));
+
+        switch (conversion)
+        {
+        case 'd':
+        case 'i':
+            spec += "ll";
+            spec += conversion;
+            snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<long long>(tag == ARG_DOUBLE ? floatValue : signedValue));
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            // A negative 32-bit value prints as it would have on the device
+            spec += "ll";
+            spec += conversion;
+            snprintf(buffer, sizeof(buffer), spec.c_str(),
+                     static_cast<unsigned long long>(tag == ARG_INT ? static_cast<uint32_t>(bits) : bits));
+            break;
+        case 'c':
+            spec += 'c';
+            snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(signedValue));
+            break;
+        case 's':
+            spec += 's';
+            snprintf(buffer, sizeof(buffer), spec.c_str(), tag == ARG_STRING ? text.c_str() : "(?)");
+            break;
+        case 'p':
+            snprintf(buffer, sizeof(buffer), "0x%llx", static_cast<unsigned long long>(bits));
+            break;
+        default: // f, F, e, E, g, G, a, A
+            spec += conversion;
+            snprintf(buffer, sizeof(buffer), spec.c_str(),
+                     tag == ARG_DOUBLE                       ? floatValue
+                     : tag == ARG_INT || tag == ARG_INT64 ? static_cast<double>(signedValue)
+                                                          : static_cast<double>(bits));
+            break;
+        }
+        out += buffer;
+    }
+
+    std::string formatMessage(const std::string &format, const char *payload, size_t size)
+    {
+        static const char *CONVERSIONS = "diuxXocspfFeEgGaA";
+
+        std::string out;
+        ArgReader args(payload, size);
+        for (size_t i = 0; i < format.size(); ++i)
+        {
+            if (format[i] != '%')
+            {
+                out += format[i];
+                continue;
+            }
+            if (i + 1 < format.size() && format[i + 1] == '%')
+            {
+                out += '%';
+                ++i;
+                continue;
+            }
+
+            // Flags, width and precision are kept, length modifiers dropped, * replaced by its argument
+            std::string spec = "%";
+            size_t j = i + 1;
+            while (j < format.size() && !std::strchr(CONVERSIONS, format[j]))
+            {
+                uint8_t tag = 0;
+                uint64_t bits = 0;
+                std::string text;
+                if (format[j] == '*' && args.next(tag, bits, text))
+                {
+                    spec += std::to_string(static_cast<int>(bits));
+                }
+                else if (!std::strchr("hlLqjzt*", format[j]))
+                {
+                    spec += format[j];
+                }
+                ++j;
+            }
+            if (j == format.size())
+            {
+                out += format.substr(i);
+                break;
+            }
+
+            uint8_t tag = 0;
+            uint64_t bits = 0;
+            std::string text;
+            if (args.next(tag, bits, text))
+            {
+                formatArg(out, spec, format[j], tag, bits, text);
+            }
+            else
+            {
+                out += "(missing)";
+            }
+            i = j;
+        }
+        return out;
+    }
+
+    void printLine(uint64_t timeNs, uint8_t level, const std::string &file, uint32_t line, const std::string &message)
+    {
+        std::time_t seconds = static_cast<std::time_t>(timeNs / 1000000000ull);
+        std::tm tm;
+        localtime_r(&seconds, &tm);
+        char time[16];
+        std::strftime(time, sizeof(time), "%H:%M:%S", &tm);
+        std::printf("[%s] [%s] %s:%u - %s\n", time, levelName(level), file.c_str(), line, message.c_str());
+    }
+
+    size_t decodeLog(const std::vector<char> &data)
+    {
+        Header header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.version != VERSION)
+        {
+            fail("unsupported binary log version");
+        }
+
+        // A file opened in append mode again by a later run starts over with a new header
+        std::unordered_map<uint32_t, Site> sites;
+        size_t position = sizeof(header);
+        size_t records = 0;
+        while (position < data.size())
+        {
+            const char *entry = data.data() + position;
+            size_t left = data.size() - position;
+
+            if (left >= sizeof(header) && std::memcmp(entry, MAGIC, sizeof(MAGIC)) == 0)
+            {
+                sites.clear();
+                position += sizeof(header);
+                continue;
+            }
+
+            if (static_cast<uint8_t>(entry[0]) == ENTRY_SITE && left >= sizeof(SiteEntry))
+            {
+                SiteEntry site;
+                std::memcpy(&site, entry, sizeof(site));
+                if (left < sizeof(site) + site.fileLength + site.formatLength)
+                {
+                    break;
+                }
+                Site &target = sites[site.id];
+                target.level = site.level;
+                target.line = site.line;
+                target.file.assign(entry + sizeof(site), site.fileLength);
+                target.format.assign(entry + sizeof(site) + site.fileLength, site.formatLength);
+                position += sizeof(site) + site.fileLength + site.formatLength;
+            }
+            else if (static_cast<uint8_t>(entry[0]) == ENTRY_RECORD && left >= sizeof(RecordEntry))
+            {
+                RecordEntry record;
+                std::memcpy(&record, entry, sizeof(record));
+                if (left < sizeof(record) + record.payloadLength)
+                {
+                    break;
+                }
+
+                auto it = sites.find(record.site);
+                if (it == sites.end())
+                {
+                    printLine(record.timeNs, 0xff, "?", 0, "unknown site " + std::to_string(record.site));
+                }
+                else
+                {
+                    printLine(record.timeNs, it->second.level, it->second.file, it->second.line,
+                              formatMessage(it->second.format, entry + sizeof(record), record.payloadLength));
+                }
+                position += sizeof(record) + record.payloadLength;
+                ++records;
+            }
+            else
+            {
+                fail("corrupt entry at offset " + std::to_string(position));
+            }
+        }
+
+        if (position < data.size())
+        {
+            std::cerr << "logdecode: last entry truncated" << std::endl;
+        }
+        return records;
+    }
+
+    // The ring holds records in slot order; sequence numbers restore the order they were logged in
+    size_t decodeFlight(const std::vector<char> &data)
+    {
+        FlightHeader header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.version != FLIGHT_VERSION || header.slotSize != sizeof(FlightSlot))
+        {
+            fail("unsupported flight recorder version");
+        }
+
+        size_t available = (data.size() - sizeof(header)) / sizeof(FlightSlot);
+        if (available < header.slotCount)
+        {
+            std::cerr << "logdecode: flight recorder truncated to " << available << " of " << header.slotCount << " slots" << std::endl;
+        }
+
+        std::vector<FlightSlot> slots;
+        for (size_t i = 0; i < std::min<size_t>(available, header.slotCount); ++i)
+        {
+            FlightSlot slot;
+            std::memcpy(&slot, data.data() + sizeof(header) + i * sizeof(FlightSlot), sizeof(slot));
+            if (slot.sequence != 0) // Never used, or being written when the process died
+            {
+                slots.push_back(slot);
+            }
+        }
+        std::sort(slots.begin(), slots.end(), [](const FlightSlot &a, const FlightSlot &b)
+                  { return a.sequence < b.sequence; });
+
+        for (const FlightSlot &slot : slots)
+        {
+            size_t length = std::min<size_t>(slot.length, sizeof(slot.payload));
+            std::string file(slot.file, strnlen(slot.file, sizeof(slot.file)));
+            std::string message;
+            if (slot.packed)
+            {
+                size_t formatLength = strnlen(slot.payload, length);
+                size_t arguments = formatLength < length ? formatLength + 1 : length;
+                message = formatMessage(std::string(slot.payload, formatLength), slot.payload + arguments, length - arguments);
+            }
+            else
+            {
+                message.assign(slot.payload, length);
+            }
+            printLine(slot.timeNs, slot.level, file, slot.line, message);
+        }
+
+        if (!slots.empty() && slots.front().sequence > 1)
+        {
+            std::cerr << "logdecode: " << slots.front().sequence - 1 << " older records overwritten" << std::endl;
+        }
+        return slots.size();
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "usage: logdecode <file.logb | file.flight>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in)
+    {
+        fail(std::string("cannot open ") + argv[1]);
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t records;
+    if (data.size() >= sizeof(FlightHeader) && std::memcmp(data.data(), FLIGHT_MAGIC, sizeof(FLIGHT_MAGIC)) == 0)
+    {
+        records = decodeFlight(data);
+    }
+    else if (data.size() >= sizeof(Header) && std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) == 0)
+    {
+        records = decodeLog(data);
+    }
+    else
+    {
+        fail("not a binary log or flight recorder file");
+    }
+
+    std::cerr << "logdecode: " << records << " records" << std::endl;
+    return 0;
+}
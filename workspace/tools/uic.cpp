@@ -0,0 +1,491 @@
+// UI definition compiler - turns .ui text files into .uib blobs loaded by UI::ScreenLoader.
+// Runs on the build host: uic <input.ui> <output.uib>
+//
+// Format:
+//   # comment
+//   container id=main background=#1e1e1e
+//       text id=title text="Hello" size=36 color=#ffffff
+//       button id=ok title="OK" background=#4caf50 focusable
+//
+//   constraints
+//       title.centerX = main.centerX
+//       title.top = main.top + 150
+//       ok.width = 150
+//       ok.right = main.centerX * 1.0 - 10 @750
+//
+// Children are indented below their parent. Element properties:
+//   all:    id, class, background, border-width, border-color, opacity, focusable, focus-scope, no-interaction
+//   text:   text, size, color, font
+//   button: title
+//   image:  src
+
+#include "UIFormat.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace TG5040::UIFormat;
+
+namespace
+{
+    std::string inputPath;
+    int lineNumber = 0;
+
+    [[noreturn]] void fail(const std::string &message)
+    {
+        std::cerr << inputPath << ":" << lineNumber << ": error: " << message << std::endl;
+        std::exit(1);
+    }
+
+    std::string lower(std::string s)
+    {
+        for (auto &c : s)
+        {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return s;
+    }
+
+    class StringTable
+    {
+    public:
+        uint32_t add(const std::string &s)
+        {
+            auto it = offsets_.find(s);
+            if (it != offsets_.end())
+            {
+                return it->second;
+            }
+            uint32_t offset = static_cast<uint32_t>(data_.size());
+            data_.insert(data_.end(), s.begin(), s.end());
+            data_.push_back('\0');
+            offsets_[s] = offset;
+            return offset;
+        }
+
+        const std::vector<char> &data() const { return data_; }
+
+    private:
+        std::vector<char> data_;
+        std::map<std::string, uint32_t> offsets_;
+    };
+
+    // Split an element line into tokens, keeping quoted values together
+    std::vector<std::string> tokenize(const std::string &line)
+    {
+        std::vector<std::string> tokens;
+        std::string current;
+        bool quoted = false;
+
+        for (size_t i = 0; i < line.size(); ++i)
+        {
+            char c = line[i];
+            if (quoted)
+            {
+                if (c == '\\' && i + 1 < line.size())
+                {
+                    char next = line[++i];
+                    current += next == 'n' ? '\n' : next;
+                }
+                else if (c == '"')
+                {
+                    quoted = false;
+                }
+                else
+                {
+                    current += c;
+                }
+            }
+            else if (c == '"')
+            {
+                quoted = true;
+            }
+            else if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                if (!current.empty())
+                {
+                    tokens.push_back(current);
+                    current.clear();
+                }
+            }
+            else
+            {
+                current += c;
+            }
+        }
+
+        if (quoted)
+        {
+            fail("unterminated string");
+        }
+        if (!current.empty())
+        {
+            tokens.push_back(current);
+        }
+        return tokens;
+    }
+
+    uint32_t parseColor(const std::string &value)
+    {
+        if (value.empty() || value[0] != '#' || (value.size() != 7 && value.size() != 9))
+        {
+            fail("invalid color '" + value + "', expected #rrggbb or #rrggbbaa");
+        }
+
+        char *end = nullptr;
+        unsigned long rgb = std::strtoul(value.c_str() + 1, &end, 16);
+        if (*end != '\0')
+        {
+            fail("invalid color '" + value + "'");
+        }
+        return value.size() == 7 ? static_cast<uint32_t>((rgb << 8) | 0xFF) : static_cast<uint32_t>(rgb);
+    }
+
+    float parseNumber(const std::string &value)
+    {
+        char *end = nullptr;
+        float result = std::strtof(value.c_str(), &end);
+        if (value.empty() || *end != '\0')
+        {
+            fail("invalid number '" + value + "'");
+        }
+        return result;
+    }
+
+    bool parseAttribute(const std::string &name, uint8_t &attribute)
+    {
+        static const std::map<std::string, Attribute> attributes = {
+            {"left", ATTR_LEFT}, {"right", ATTR_RIGHT}, {"top", ATTR_TOP}, {"bottom", ATTR_BOTTOM},
+            {"width", ATTR_WIDTH}, {"height", ATTR_HEIGHT}, {"centerx", ATTR_CENTER_X},
+            {"centery", ATTR_CENTER_Y}, {"leading", ATTR_LEADING}, {"trailing", ATTR_TRAILING}};
+
+        auto it = attributes.find(lower(name));
+        if (it == attributes.end())
+        {
+            return false;
+        }
+        attribute = it->second;
+        return true;
+    }
+
+    struct Compiler
+    {
+        std::vector<ElementRecord> elements;
+        std::vector<ConstraintRecord> constraints;
+        std::map<std::string, uint16_t> ids;
+        StringTable strings;
+        std::vector<std::pair<int, int>> stack; // (indent, element index)
+
+        void parseElement(int indent, const std::string &line)
+        {
+            auto tokens = tokenize(line);
+            static const std::map<std::string, ElementType> types = {
+                {"container", TYPE_CONTAINER}, {"text", TYPE_TEXT}, {"button", TYPE_BUTTON},
+                {"image", TYPE_IMAGE}, {"element", TYPE_ELEMENT}};
+
+            auto type = types.find(lower(tokens[0]));
+            if (type == types.end())
+            {
+                fail("unknown element type '" + tokens[0] + "'");
+            }
+
+            ElementRecord record;
+            std::memset(&record, 0, sizeof(record));
+            record.type = type->second;
+            record.id = record.text = record.font = record.classes = NO_STRING;
+            record.opacity = 1.0f;
+
+            while (!stack.empty() && stack.back().first >= indent)
+            {
+                stack.pop_back();
+            }
+            if (stack.empty() && !elements.empty())
+            {
+                fail("only one root element is allowed");
+            }
+            record.parent = stack.empty() ? NO_ELEMENT : static_cast<int16_t>(stack.back().second);
+
+            uint16_t index = static_cast<uint16_t>(elements.size());
+
+            for (size_t i = 1; i < tokens.size(); ++i)
+            {
+                const std::string &token = tokens[i];
+                size_t eq = token.find('=');
+                std::string key = lower(token.substr(0, eq));
+                std::string value = eq == std::string::npos ? "" : token.substr(eq + 1);
+
+                if (eq == std::string::npos)
+                {
+                    if (key == "focusable")
+                        record.flags |= FLAG_FOCUSABLE;
+                    else if (key == "focus-scope")
+                        record.flags |= FLAG_FOCUS_SCOPE;
+                    else if (key == "no-interaction")
+                        record.flags |= FLAG_NO_INTERACTION;
+                    else
+                        fail("unknown flag '" + token + "'");
+                }
+                else if (key == "id")
+                {
+                    if (ids.count(value))
+                    {
+                        fail("duplicate id '" + value + "'");
+                    }
+                    ids[value] = index;
+                    record.id = strings.add(value);
+                }
+                else if (key == "class")
+                {
+                    record.classes = strings.add(value);
+                }
+                else if (key == "background")
+                {
+                    record.backgroundColor = parseColor(value);
+                    record.flags |= FLAG_BACKGROUND;
+                }
+                else if (key == "border-color")
+                {
+                    record.borderColor = parseColor(value);
+                    record.flags |= FLAG_BORDER_COLOR;
+                }
+                else if (key == "border-width")
+                {
+                    record.borderWidth = parseNumber(value);
+                }
+                else if (key == "opacity")
+                {
+                    record.opacity = parseNumber(value);
+                }
+                else if (key == "text" && record.type == TYPE_TEXT)
+                {
+                    record.text = strings.add(value);
+                }
+                else if (key == "title" && record.type == TYPE_BUTTON)
+                {
+                    record.text = strings.add(value);
+                }
+                else if (key == "src" && record.type == TYPE_IMAGE)
+                {
+                    record.text = strings.add(value);
+                }
+                else if (key == "size" && record.type == TYPE_TEXT)
+                {
+                    record.fontSize = static_cast<uint16_t>(parseNumber(value));
+                    record.flags |= FLAG_FONT_SIZE;
+                }
+                else if (key == "color" && record.type == TYPE_TEXT)
+                {
+                    record.textColor = parseColor(value);
+                    record.flags |= FLAG_TEXT_COLOR;
+                }
+                else if (key == "font" && record.type == TYPE_TEXT)
+                {
+                    record.font = strings.add(value);
+                }
+                else
+                {
+                    fail("unknown property '" + key + "' for " + tokens[0]);
+                }
+            }
+
+            if (elements.size() >= 0x7FFF)
+            {
+                fail("too many elements");
+            }
+
+            elements.push_back(record);
+            stack.emplace_back(indent, index);
+        }
+
+        // Resolve "id.attribute"
+        void parseReference(const std::string &token, uint16_t &element, uint8_t &attribute)
+        {
+            size_t dot = token.find('.');
+            if (dot == std::string::npos)
+            {
+                fail("expected id.attribute, got '" + token + "'");
+            }
+
+            auto it = ids.find(token.substr(0, dot));
+            if (it == ids.end())
+            {
+                fail("unknown id '" + token.substr(0, dot) + "'");
+            }
+            if (!parseAttribute(token.substr(dot + 1), attribute))
+            {
+                fail("unknown attribute '" + token.substr(dot + 1) + "'");
+            }
+            element = it->second;
+        }
+
+        void parseConstraint(const std::string &line)
+        {
+            auto tokens = tokenize(line);
+            if (tokens.size() < 3)
+            {
+                fail("expected 'id.attribute = expression'");
+            }
+
+            ConstraintRecord record;
+            std::memset(&record, 0, sizeof(record));
+            record.multiplier = 1.0f;
+            record.priority = 1000;
+            record.secondItem = NO_ELEMENT;
+
+            parseReference(tokens[0], record.firstItem, record.firstAttribute);
+            record.secondAttribute = record.firstAttribute;
+
+            if (tokens[1] == "=" || tokens[1] == "==")
+                record.relation = REL_EQUAL;
+            else if (tokens[1] == "<=")
+                record.relation = REL_LESS_OR_EQUAL;
+            else if (tokens[1] == ">=")
+                record.relation = REL_GREATER_OR_EQUAL;
+            else
+                fail("unknown relation '" + tokens[1] + "'");
+
+            size_t i = 2;
+            if (!tokens.empty() && tokens.back()[0] == '@')
+            {
+                record.priority = static_cast<uint16_t>(parseNumber(tokens.back().substr(1)));
+                tokens.pop_back();
+            }
+
+            if (i >= tokens.size())
+            {
+                fail("missing right-hand side in constraint");
+            }
+
+            // Either a constant or "id.attr [* multiplier] [+|- constant]"
+            if (tokens[i].find('.') != std::string::npos && !std::isdigit(static_cast<unsigned char>(tokens[i][0])) &&
+                tokens[i][0] != '-')
+            {
+                uint16_t second = 0;
+                parseReference(tokens[i], second, record.secondAttribute);
+                record.secondItem = static_cast<int16_t>(second);
+                ++i;
+
+                if (i + 1 < tokens.size() && tokens[i] == "*")
+                {
+                    record.multiplier = parseNumber(tokens[i + 1]);
+                    i += 2;
+                }
+                if (i + 1 < tokens.size() && (tokens[i] == "+" || tokens[i] == "-"))
+                {
+                    float value = parseNumber(tokens[i + 1]);
+                    record.constant = tokens[i] == "-" ? -value : value;
+                    i += 2;
+                }
+            }
+            else
+            {
+                record.constant = parseNumber(tokens[i]);
+                ++i;
+            }
+
+            if (i != tokens.size())
+            {
+                fail("unexpected '" + tokens[i] + "' in constraint");
+            }
+
+            constraints.push_back(record);
+        }
+
+        void write(const std::string &path)
+        {
+            Header header;
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.elementCount = static_cast<uint16_t>(elements.size());
+            header.constraintCount = static_cast<uint16_t>(constraints.size());
+            header.reserved = 0;
+            header.stringTableSize = static_cast<uint32_t>(strings.data().size());
+
+            std::ofstream out(path, std::ios::binary);
+            if (!out)
+            {
+                std::cerr << "uic: cannot write " << path << std::endl;
+                std::exit(1);
+            }
+
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char *>(elements.data()), elements.size() * sizeof(ElementRecord));
+            out.write(reinterpret_cast<const char *>(constraints.data()), constraints.size() * sizeof(ConstraintRecord));
+            out.write(strings.data().data(), strings.data().size());
+        }
+    };
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: uic <input.ui> <output.uib>" << std::endl;
+        return 1;
+    }
+
+    inputPath = argv[1];
+    std::ifstream in(inputPath);
+    if (!in)
+    {
+        std::cerr << "uic: cannot read " << inputPath << std::endl;
+        return 1;
+    }
+
+    Compiler compiler;
+    bool inConstraints = false;
+    std::string line;
+
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+
+        int indent = 0;
+        size_t pos = 0;
+        for (; pos < line.size() && (line[pos] == ' ' || line[pos] == '\t'); ++pos)
+        {
+            indent += line[pos] == '\t' ? 4 : 1;
+        }
+
+        std::string content = line.substr(pos);
+        while (!content.empty() && std::isspace(static_cast<unsigned char>(content.back())))
+        {
+            content.pop_back();
+        }
+        if (content.empty() || content[0] == '#')
+        {
+            continue;
+        }
+
+        if (indent == 0 && lower(content) == "constraints")
+        {
+            inConstraints = true;
+            continue;
+        }
+
+        if (inConstraints)
+        {
+            compiler.parseConstraint(content);
+        }
+        else
+        {
+            compiler.parseElement(indent, content);
+        }
+    }
+
+    if (compiler.elements.empty())
+    {
+        fail("no elements defined");
+    }
+
+    compiler.write(argv[2]);
+    return 0;
+}